@@ -3,6 +3,12 @@ cp -u shaders bin/linux/debug -d -r
 cp -u textures bin/linux/debug -d -r
 cp -u fonts bin/linux/debug -d -r
 c_files=("src/main.c" "src/delo2d.c")
+c_flags=()
 
-gcc -o bin/linux/debug/main "${c_files[@]}" -Ilibs  -Iinclude/ -I/usr/include/freetype2 -lfreetype -lglfw -lGLEW -lGL -lm -ldl;
+# DELO_ALLOC_COUNT=1 ./build.sh counts heap allocations, DELO_BENCH=1 then fails on any in steady state frames.
+if [ -n "$DELO_ALLOC_COUNT" ]; then
+    c_flags=(-DDELO_ALLOC_COUNT -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc)
+fi
+
+gcc -o bin/linux/debug/main "${c_files[@]}" "${c_flags[@]}" -Ilibs  -Iinclude/ -I/usr/include/freetype2 -lfreetype -lglfw -lGLEW -lGL -lm -ldl -lpthread;
 ./bin/linux/debug/main
\ No newline at end of file
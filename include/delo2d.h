@@ -25,11 +25,15 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <freetype2/ft2build.h>
 #include FT_FREETYPE_H
 #include <float.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
 
 // ================================
 // delo2d
@@ -46,6 +50,85 @@
 #define DELO_LINE_LIST     1
 #define DELO_TRIANGLE_LIST 2
 
+#define DELO_PRIMITIVE_RUNS 64
+
+#define DELO_JOIN_MITER 0
+#define DELO_JOIN_ROUND 1
+#define DELO_JOIN_BEVEL 2
+
+#define DELO_CAP_BUTT   0
+#define DELO_CAP_SQUARE 1
+#define DELO_CAP_ROUND  2
+
+#define DELO_PATH_TOLERANCE      0.25f
+#define DELO_PATH_CURVE_SEGMENTS 1024
+#define DELO_PATH_CHUNK          256
+#define DELO_PI                  3.14159265358979f
+
+#define DELO_PLOT_LEVELS       24
+#define DELO_PLOT_PARALLEL_MIN 65536
+
+#define DELO_RENDERER_SPRITE      1
+#define DELO_RENDERER_SPRITE_FONT 2
+#define DELO_RENDERER_PRIMITIVE   3
+#define DELO_RENDERER_CIRCLE      4
+
+#define DELO_RENDERER_GROW         0
+#define DELO_RENDERER_FLUSH        1
+#define DELO_RENDERER_CAPACITY_MAX (1u << 20)
+
+#define DELO_SHADER_REGISTRY_CAPACITY 32
+#define DELO_SHADER_BINDING_CAPACITY  64
+#define DELO_SHADER_WATCH_CAPACITY    8
+
+#define DELO_CLIP_STACK_DEPTH 16
+#define DELO_CLIP_BATCHES     64
+
+#define DELO_TEXT_CACHE_SETS    64
+#define DELO_TEXT_CACHE_WAYS    4
+#define DELO_TEXT_LAYOUT_GLYPHS 64
+
+#define DELO_GLYPH_ATLAS_PAGES    4
+#define DELO_GLYPH_ATLAS_SIZE     1024
+#define DELO_GLYPH_ATLAS_SHELVES  128
+#define DELO_GLYPH_TABLE_BITS     12
+#define DELO_GLYPH_TABLE_CAPACITY (1 << DELO_GLYPH_TABLE_BITS)
+
+#define DELO_KERNING_TABLE_BITS     12
+#define DELO_KERNING_TABLE_CAPACITY (1 << DELO_KERNING_TABLE_BITS)
+
+#define DELO_KERNING_OFF       0
+#define DELO_KERNING_ON        1
+#define DELO_KERNING_REQUESTED 2
+
+#define DELO_FONT_CACHE_MAGIC   0x46443244
+#define DELO_FONT_CACHE_VERSION 1
+
+#define DELO_INPUT_QUEUE_SIZE 1024
+
+#define DELO_INPUT_CURSOR 0
+#define DELO_INPUT_BUTTON 1
+#define DELO_INPUT_KEY    2
+#define DELO_INPUT_SCROLL 3
+
+typedef struct InputEvent InputEvent;
+struct InputEvent
+{
+    double  time;
+    double  x;
+    double  y;
+    int32_t code;
+    int32_t action;
+    uint8_t type;
+};
+typedef struct InputQueue InputQueue;
+struct InputQueue
+{
+    InputEvent       events[DELO_INPUT_QUEUE_SIZE];
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    uint32_t         dropped;
+};
 typedef struct GlfwCallbackData GlfwCallbackData;
 struct GlfwCallbackData
 {
@@ -53,6 +136,8 @@ struct GlfwCallbackData
     void *camera;
     char key_buffer[16];
     uint16_t key_buffer_length;
+    double scroll_y;
+    InputQueue input_queue;
 };
 typedef struct HidState HidState;
 struct HidState
@@ -78,20 +163,10 @@ struct HidState
     int key_v;
     int key_a;
     int key_tab;
+    int key_arrow_up;
+    int key_arrow_down;
 };
 
-typedef struct D2DContext D2DContext;
-struct D2DContext
-{
-    GLint back_buffer_width, back_buffer_height, screen_width, screen_height;
-    GLFWwindow *window;
-    GlfwCallbackData glfw_callback_data;
-    HidState         hid_state;
-    HidState         hid_state_prev;
-    double t1,t0,dt;
-    float t;
-    GLfloat projection_matrix[16];
-};
 typedef struct Texture Texture;
 struct Texture
 {
@@ -120,6 +195,125 @@ struct Rectangle_f
 {
     float x,y,width,height;
 };
+typedef struct ClipStack ClipStack;
+// Targets are the pixel size of the bound render target, {0, 0} is the back buffer.
+struct ClipStack
+{
+    Rectangle_f rects[DELO_CLIP_STACK_DEPTH];
+    Vector2f    targets[DELO_CLIP_STACK_DEPTH];
+    Vector2f    target;
+    uint8_t     depth;
+};
+typedef struct ClipBatch ClipBatch;
+struct ClipBatch
+{
+    uint32_t    first;
+    Rectangle_f rect;
+    uint8_t     enabled;
+    Vector2f    target;
+};
+typedef struct RendererStats RendererStats;
+struct RendererStats
+{
+    uint32_t grows;
+    uint32_t flushes;
+    uint32_t dropped;
+};
+typedef struct RendererOverflow RendererOverflow;
+struct RendererOverflow
+{
+    uint8_t       mode;
+    uint32_t      capacity_max;
+    RendererStats stats;
+};
+typedef struct ReactiveFrame ReactiveFrame;
+struct ReactiveFrame
+{
+    uint8_t     enabled;
+    uint8_t     drawing;
+    uint8_t     damaged;
+    uint8_t     damage_full;
+    uint8_t     input_damage;
+    Rectangle_f damage;
+    uint64_t    input_hash;
+    double      idle_timeout;
+    GLuint      fbo;
+    GLuint      texture;
+    uint32_t    frames_drawn;
+    uint32_t    frames_skipped;
+};
+#define DELO_COMMAND_THREADS          16
+#define DELO_COMMAND_SPRITE_BUCKETS   32
+#define DELO_COMMAND_INITIAL_CAPACITY 256
+#define DELO_COMMAND_CHUNK_CAPACITY   4096
+
+#define DELO_JOB_WORKERS    16
+#define DELO_JOB_DEQUE_SIZE 4096
+#define DELO_JOB_SPIN       64
+
+#define DELO_ARENA_ALIGN        16
+#define DELO_ARENA_POISON_BYTE  0xCD
+#define DELO_FRAME_ARENA_SIZE   (8u << 20)
+#define DELO_SCRATCH_ARENA_SIZE (2u << 20)
+
+typedef struct Arena Arena;
+struct Arena
+{
+    uint8_t*         base;
+    size_t           capacity;
+    _Atomic size_t   used;
+    size_t           high_water;
+    _Atomic uint32_t overflows;
+};
+typedef size_t ArenaMark;
+
+#define DELO_FRAME_HISTORY 256
+#define DELO_FRAME_SPIN    0.002
+#define DELO_SWAP_ADAPTIVE -1
+
+typedef struct FramePacing FramePacing;
+struct FramePacing
+{
+    double   step;
+    double   accumulator;
+    double   time;
+    double   dt_max;
+    double   target;
+    float    alpha;
+    int      swap_interval;
+    uint8_t  waited;
+    float    history[DELO_FRAME_HISTORY];
+    uint32_t history_count;
+    uint32_t history_index;
+};
+typedef struct FrameStats FrameStats;
+struct FrameStats
+{
+    float p50;
+    float p99;
+    float max;
+};
+typedef struct D2DContext D2DContext;
+struct D2DContext
+{
+    GLint back_buffer_width, back_buffer_height, screen_width, screen_height;
+    GLFWwindow *window;
+    GlfwCallbackData glfw_callback_data;
+    HidState         hid_state;
+    HidState         hid_state_prev;
+    double t1,t0,dt;
+    float t;
+    GLfloat projection_matrix[16];
+    ClipStack clip_stack;
+    ReactiveFrame reactive;
+    FramePacing pacing;
+    Arena frame_arenas[2];
+    uint8_t frame_arena;
+    Arena scratch;
+    RendererStats renderer_stats;
+    RendererStats renderer_stats_frame;
+    uint32_t frame;
+};
 typedef struct Sprite Sprite;
 struct Sprite
 {
@@ -168,6 +362,57 @@ struct Camera2D
     float view_width_in_world_units;
     float view_height_in_world_units;
 };
+typedef struct ShaderCache ShaderCache;
+struct ShaderCache
+{
+    char     directory[256];
+    uint8_t  enabled;
+    uint32_t hits;
+    uint32_t misses;
+    double   load_time;
+};
+typedef struct FontCache FontCache;
+struct FontCache
+{
+    char     directory[256];
+    uint8_t  enabled;
+    uint32_t hits;
+    uint32_t misses;
+    double   load_time;
+};
+typedef struct ShaderEntry ShaderEntry;
+struct ShaderEntry
+{
+    char      path_vert[256];
+    char      path_frag[256];
+    uint32_t* program;
+    double    modified;
+    uint8_t   watch_vert;
+    uint8_t   watch_frag;
+    uint8_t   dirty;
+};
+typedef struct ShaderBinding ShaderBinding;
+struct ShaderBinding
+{
+    void*   renderer;
+    uint8_t type;
+    uint8_t entry;
+};
+typedef struct ShaderRegistry ShaderRegistry;
+struct ShaderRegistry
+{
+    ShaderEntry   entries[DELO_SHADER_REGISTRY_CAPACITY];
+    ShaderBinding bindings[DELO_SHADER_BINDING_CAPACITY];
+    char          watch_dirs[DELO_SHADER_WATCH_CAPACITY][256];
+    int32_t       watches[DELO_SHADER_WATCH_CAPACITY];
+    int32_t       fd;
+    uint8_t       entry_count;
+    uint8_t       binding_count;
+    uint8_t       watch_count;
+    double        debounce;
+    uint32_t      reloads;
+    uint32_t      failures;
+};
 typedef struct FontMeasurement FontMeasurement;
 struct FontMeasurement
 {
@@ -176,12 +421,40 @@ struct FontMeasurement
     uint16_t width_in_ch;
     uint8_t limit_ch_hit;
     uint8_t limit_px_hit;
+    int32_t caret_index;
 };
 
 typedef struct Glyph Glyph;
 struct Glyph
 {
     int32_t x, y, w, h, advance, bearing_x, bearing_y;
+    uint8_t page;
+};
+typedef struct GlyphEntry GlyphEntry;
+struct GlyphEntry
+{
+    uint32_t codepoint;
+    Glyph    glyph;
+};
+typedef struct GlyphShelf GlyphShelf;
+struct GlyphShelf
+{
+    uint16_t x, y, height;
+};
+typedef struct GlyphPage GlyphPage;
+struct GlyphPage
+{
+    Texture    texture;
+    GlyphShelf shelves[DELO_GLYPH_ATLAS_SHELVES];
+    uint16_t   shelf_count;
+    uint16_t   bottom;
+    uint32_t   last_used;
+};
+typedef struct KerningPair KerningPair;
+struct KerningPair
+{
+    uint64_t key;
+    int16_t  value;
 };
 typedef struct SpriteFont SpriteFont;
 struct SpriteFont
@@ -189,10 +462,29 @@ struct SpriteFont
     uint16_t font_size;
     uint32_t line_spacing;
 
-    Glyph glyphs[256];
     int32_t advance;
-    Texture texture;
     int8_t padding;
+    uint8_t sdf;
+
+    char        path[256];
+    uint64_t    cache_key;
+    uint8_t     cache_dirty;
+    FT_Library  ft;
+    FT_Face     face;
+    GlyphEntry* glyphs;
+    uint32_t    glyph_count;
+    KerningPair *kerning_pairs;
+    uint32_t    kerning_count;
+    uint8_t     kerning;
+    GlyphPage   pages[DELO_GLYPH_ATLAS_PAGES];
+    uint8_t     page_count;
+    uint16_t    page_size;
+    uint32_t    tick;
+    uint32_t    frame;
+    uint32_t    frame_tick;
+    uint32_t    generation;
+    uint32_t    rasterized;
+    uint32_t    evictions;
 };
 typedef struct RendererSprite RendererSprite;
 struct RendererSprite
@@ -205,7 +497,6 @@ struct RendererSprite
     float *         texture_indices;
     Matrix44*       transforms;
     Matrix44        projection;
-    Vector2f*        limit_ys;
     int32_t         texture_id_0;
     int32_t         texture_id_1;
     int32_t         texture_id_2;
@@ -221,7 +512,6 @@ struct RendererSprite
     GLuint          vbo_offsets;
     GLuint          vbo_src_rects;
     GLint          vbo_tex_indices;
-    GLuint          vbo_limit_y;
     GLuint          uniform_location_u_texture0;
     GLuint          uniform_location_u_texture1;
     GLuint          uniform_location_u_texture2;
@@ -231,30 +521,94 @@ struct RendererSprite
     GLuint          uniform_location_u_mvp; 
     uint8_t         flip; 
     uint8_t         change_mask;
-
+    ClipBatch       clip_batches[DELO_CLIP_BATCHES];
+    uint32_t        clip_batch_count;
+    uint32_t        clip_rejected;
+    RendererOverflow overflow;
 };
 typedef struct PrimitiveVertex PrimitiveVertex;
 struct PrimitiveVertex
 {
     Vector2f position;
-    Color    color;
+    uint32_t color;
+};
+typedef struct PrimitiveRun PrimitiveRun;
+struct PrimitiveRun
+{
+    uint32_t first;
+    uint8_t  type;
 };
 typedef struct RendererPrimitive RendererPrimitive;
 struct RendererPrimitive
 {
     PrimitiveVertex* vertices;
+    uint32_t*        indices;
     D2DContext*      context;
     Matrix44         projection;
     Matrix44         projection_default;
     GLuint           capacity;
     GLuint           count;
+    GLuint           index_capacity;
+    GLuint           index_count;
     GLuint           uniform_projection;
     GLuint           uniform_location_u_mvp;
     GLuint           vao;
     GLuint           vbo_vertices;
+    GLuint           ebo;
     GLuint           shader;
     GLuint           shader_default;
     uint8_t          type;
+    PrimitiveRun     runs[DELO_PRIMITIVE_RUNS];
+    uint32_t         run_count;
+    ClipBatch        clip_batches[DELO_CLIP_BATCHES];
+    uint32_t         clip_batch_count;
+    uint32_t         clip_rejected;
+    RendererOverflow overflow;
+};
+typedef struct PathStyle PathStyle;
+struct PathStyle
+{
+    float   width;
+    Color   color;
+    uint8_t join;
+    uint8_t cap;
+    float   miter_limit;
+    float   fringe;
+};
+typedef struct PathContour PathContour;
+struct PathContour
+{
+    uint32_t first;
+    uint32_t count;
+    uint32_t section_first;
+    uint32_t section_count;
+    uint8_t  closed;
+};
+typedef struct PathSection PathSection;
+struct PathSection
+{
+    Vector2f center;
+    Vector2f normal;
+    float    width;
+    float    alpha;
+};
+typedef struct Path Path;
+struct Path
+{
+    Vector2f*    points;
+    uint32_t     point_count;
+    uint32_t     point_capacity;
+    PathContour* contours;
+    uint32_t     contour_count;
+    uint32_t     contour_capacity;
+    PathSection* sections;
+    uint32_t     section_count;
+    uint32_t     section_capacity;
+    float        tolerance;
+    PathStyle    style;
+    Vector2f     bounds_min;
+    Vector2f     bounds_max;
+    uint8_t      cached;
 };
 typedef struct RendererCircle RendererCircle;
 struct RendererCircle
@@ -279,8 +633,62 @@ struct RendererCircle
     GLuint           shader;
     GLuint           shader_default;
     uint8_t          type;
+    ClipBatch        clip_batches[DELO_CLIP_BATCHES];
+    uint32_t         clip_batch_count;
+    uint32_t         clip_rejected;
+    RendererOverflow overflow;
 };
 
+typedef struct FontCacheHeader FontCacheHeader;
+struct FontCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t line_spacing;
+    int32_t  advance;
+    uint32_t glyph_count;
+    uint16_t page_size;
+    uint8_t  page_count;
+    uint8_t  reserved;
+};
+typedef struct FontCachePage FontCachePage;
+struct FontCachePage
+{
+    GlyphShelf shelves[DELO_GLYPH_ATLAS_SHELVES];
+    uint16_t   shelf_count;
+    uint16_t   bottom;
+};
+typedef struct TextLayout TextLayout;
+struct TextLayout
+{
+    uint64_t        key;
+    SpriteFont*     font;
+    uint32_t        length;
+    uint32_t        max_length;
+    float           scale;
+    uint32_t        last_used;
+    uint32_t        generation;
+    uint16_t        count;
+    uint8_t         valid;
+    uint8_t         page_mask;
+    Rectangle_f     bounds;
+    FontMeasurement measurement;
+    Matrix44        transforms[DELO_TEXT_LAYOUT_GLYPHS];
+    Rectangle_f     src_rects[DELO_TEXT_LAYOUT_GLYPHS];
+    Vector2f        offsets[DELO_TEXT_LAYOUT_GLYPHS];
+    uint8_t         pages[DELO_TEXT_LAYOUT_GLYPHS];
+};
+typedef struct TextCache TextCache;
+struct TextCache
+{
+    TextLayout* layouts;
+    uint32_t    tick;
+    uint32_t    hits;
+    uint32_t    misses;
+    uint32_t    evictions;
+    uint32_t    bypasses;
+};
 typedef struct RendererSpriteFont RendererSpriteFont;
 struct RendererSpriteFont
 {
@@ -291,7 +699,6 @@ struct RendererSpriteFont
     Vector2f*       offsets;
     Rectangle_f*    src_rects;
     float*          texture_indices;
-    Vector2f*       limit_ys;
     GLuint          capacity;
     GLuint          count;
     GLuint          uniform_projection;
@@ -301,7 +708,6 @@ struct RendererSpriteFont
     GLuint          uniform_location_u_texture3;
     GLuint          uniform_location_u_mvp;    
     GLuint          uniform_location_u_flip; 
-    GLuint          uniform_location_u_back_buffer_height;
     GLuint          vao;
     GLuint          vbo_vertices;
     GLuint          vbo_colors;
@@ -309,13 +715,146 @@ struct RendererSpriteFont
     GLuint          vbo_offsets;
     GLuint          vbo_src_rects;
     GLuint          vbo_tex_indices;
-    GLuint          vbo_limit_y;
     GLuint          shader;
     int32_t         texture_id_0;
     int32_t         texture_id_1;
     int32_t         texture_id_2;
     int32_t         texture_id_3;
     uint8_t         flip;
+    TextCache*      text_cache;
+    ClipBatch       clip_batches[DELO_CLIP_BATCHES];
+    uint32_t        clip_batch_count;
+    uint32_t        clip_rejected;
+    RendererOverflow overflow;
+};
+typedef struct SpriteChunk SpriteChunk;
+struct SpriteChunk
+{
+    SpriteChunk* next;
+    Color*       colors;
+    Matrix44*    transforms;
+    Vector2f*    offsets;
+    Rectangle_f* src_rects;
+    uint32_t     count;
+    uint32_t     capacity;
+};
+typedef struct SpriteBucket SpriteBucket;
+struct SpriteBucket
+{
+    uint64_t     key;
+    Texture*     texture;
+    SpriteChunk* first;
+    SpriteChunk* last;
+    uint32_t     count;
+};
+typedef struct TextRun TextRun;
+struct TextRun
+{
+    SpriteFont* font;
+    uint32_t    text;
+    uint32_t    max_length;
+    Vector2f    position;
+    Color       color;
+    float       size;
+    uint8_t     layer;
+};
+typedef struct CommandBucket CommandBucket;
+struct CommandBucket
+{
+    SpriteBucket     sprites[DELO_COMMAND_SPRITE_BUCKETS];
+    uint32_t         sprite_bucket_count;
+    Arena*           arena;
+    PrimitiveVertex* vertices;
+    uint32_t         vertex_count;
+    uint32_t         vertex_capacity;
+    Vector2f*        circle_positions;
+    Color*           circle_colors;
+    float*           circle_radii;
+    uint32_t         circle_count;
+    uint32_t         circle_capacity;
+    TextRun*         runs;
+    uint32_t         run_count;
+    uint32_t         run_capacity;
+    char*            chars;
+    uint32_t         char_count;
+    uint32_t         char_capacity;
+    uint32_t         overflows;
+};
+typedef void (*JobFn)(void* data, uint32_t begin, uint32_t end, uint32_t worker);
+typedef void (*JobProfileFn)(void* user, uint32_t worker, const char* name, double start, double end);
+
+typedef struct JobCounter JobCounter;
+struct JobCounter
+{
+    _Atomic int32_t value;
+};
+typedef struct Job Job;
+struct Job
+{
+    JobFn       fn;
+    void*       data;
+    uint32_t    begin;
+    uint32_t    end;
+    JobCounter* counter;
+    const char* name;
+};
+typedef struct JobDeque JobDeque;
+struct JobDeque
+{
+    _Alignas(64) _Atomic int64_t top;
+    _Alignas(64) _Atomic int64_t bottom;
+    Job jobs[DELO_JOB_DEQUE_SIZE];
+};
+typedef struct JobWorkerStats JobWorkerStats;
+struct JobWorkerStats
+{
+    uint32_t jobs;
+    uint32_t steals;
+    double   busy;
+};
+typedef struct JobSystem JobSystem;
+typedef struct JobWorker JobWorker;
+struct JobWorker
+{
+    JobDeque       deque;
+    JobSystem*     system;
+    pthread_t      thread;
+    uint32_t       index;
+    uint32_t       random;
+    JobWorkerStats stats;
+};
+struct JobSystem
+{
+    JobWorker*       workers;
+    uint32_t         worker_count;
+    uint8_t          pin;
+    _Atomic uint8_t  running;
+    _Atomic int32_t  pending;
+    _Atomic int32_t  sleepers;
+    pthread_mutex_t  mutex;
+    pthread_cond_t   wake;
+    JobProfileFn     profile_fn;
+    void*            profile_user;
+};
+typedef struct PlotSeries PlotSeries;
+struct PlotSeries
+{
+    float*     values;
+    float*     minimum[DELO_PLOT_LEVELS];
+    float*     maximum[DELO_PLOT_LEVELS];
+    uint32_t   count;
+    uint32_t   capacity;
+    float      x_start;
+    float      x_step;
+    JobSystem* jobs;
+};
+typedef struct CommandRecorder CommandRecorder;
+struct CommandRecorder
+{
+    CommandBucket* buckets;
+    uint32_t       thread_count;
+    uint32_t       merged;
+    Arena*         arena;
 };
 
 #if defined(DELO2D_FUNCTION_SIGNATURES) || defined(DELO2D_IMPLEMENTATION)
@@ -328,8 +867,19 @@ void gl_check_error();
 // Graphics context functions
 // ================================
 int8_t d2d_context_init(D2DContext *context, uint16_t width, uint16_t height, char *window_title);
-void   d2d_frame_begin(D2DContext *context);
+uint8_t d2d_frame_begin(D2DContext *context);
 void   d2d_frame_end(D2DContext *context);
+int8_t d2d_frame_reactive(D2DContext *context, uint8_t enabled, double idle_timeout);
+GLuint d2d_frame_target(D2DContext *context);
+void   d2d_frame_damage(D2DContext *context, Rectangle_f rect);
+void   d2d_frame_invalidate(D2DContext *context);
+void   d2d_frame_pacing(D2DContext *context, double step, double target_fps, int swap_interval);
+void   d2d_frame_pace(D2DContext *context);
+uint8_t d2d_frame_step(D2DContext *context);
+FrameStats d2d_frame_stats(D2DContext *context);
+Arena* d2d_frame_arena(D2DContext *context);
+Arena* d2d_frame_arena_prev(D2DContext *context);
+Arena* d2d_frame_scratch(D2DContext *context);
 // ================================
 // Matrix44 functions
 // ================================
@@ -359,6 +909,17 @@ void d2d_hid_control_init(HidState *hid_state, GLFWwindow *window);
 void d2d_hid_control_update(HidState *hid_state, GLFWwindow *window, int window_width, int window_height,int back_buffer_width, int back_buffer_height);
 void d2d_append_utf8(uint32_t codepoint, char *buffer, uint16_t *index);
 void d2d_callback_character(GLFWwindow *window, unsigned int codepoint);
+void d2d_callback_scroll(GLFWwindow *window, double offset_x, double offset_y);
+void d2d_hid_control_apply(HidState *hid_state, InputEvent *events, uint32_t count);
+// ================================
+// Input queue functions
+// ================================
+void     d2d_input_queue_init(InputQueue *queue);
+int8_t   d2d_input_queue_push(InputQueue *queue, InputEvent event);
+uint32_t d2d_input_queue_drain(InputQueue *queue, InputEvent *events, uint32_t capacity);
+void     d2d_callback_cursor_position(GLFWwindow *window, double x, double y);
+void     d2d_callback_mouse_button(GLFWwindow *window, int button, int action, int mods);
+void     d2d_callback_key(GLFWwindow *window, int key, int scancode, int action, int mods);
 // ================================
 // Sprite functions
 // ================================
@@ -371,6 +932,7 @@ void d2d_sprite_transform(uint32_t width, uint32_t height, Matrix44 *transform,
 // Render Target functions
 // ================================
 int8_t d2d_render_target_init(RenderTarget *rt,float screen_width,float screen_height, float x, float y, float width, float height);
+void   d2d_render_target_bind(D2DContext *context, RenderTarget *rt);
 // ================================
 // Shader functions
 // ================================
@@ -380,6 +942,26 @@ int8_t  d2d_shader_load(char *path_shader_vert, char *path_shader_frag, uint32_t
 uint8_t d2d_shader_compile(uint32_t type, char *shader_source_code, uint32_t *id);
 uint8_t d2d_shader_create(char *source_code_shader_vertex, char *source_code_shader_fragment, uint32_t *program);
 // ================================
+// Shader cache functions
+// ================================
+extern ShaderCache d2d_shader_cache;
+int8_t  d2d_shader_cache_init(char *directory);
+int8_t  d2d_shader_cache_load(uint64_t key, uint32_t *program);
+int8_t  d2d_shader_cache_store(uint64_t key, uint32_t program);
+uint64_t d2d_shader_cache_key(char *source_code_shader_vertex, char *source_code_shader_fragment);
+// ================================
+// Shader registry functions
+// ================================
+void   d2d_shader_registry_init(ShaderRegistry *registry);
+int8_t d2d_shader_registry_add(ShaderRegistry *registry, char *path_shader_vert, char *path_shader_frag, uint32_t *program);
+int8_t d2d_shader_registry_bind(ShaderRegistry *registry, uint32_t *program, void *renderer, uint8_t type);
+void   d2d_shader_registry_poll(ShaderRegistry *registry);
+int8_t d2d_shader_registry_reload(ShaderRegistry *registry, uint8_t entry);
+// ================================
+// Hash functions
+// ================================
+uint64_t d2d_hash_fnv1a(const void *data, size_t length, uint64_t hash);
+// ================================
 // Texture functions
 // ================================
 int8_t d2d_texture_load(Texture *texture, char file_path[]);
@@ -408,6 +990,20 @@ void d2d_color_set_i(Color *color, int r, int g, int b, int a);
 void d2d_color_set(Color *color1, Color *color2);
 void d2d_color_lerp(Color *result, Color *color_a, Color *color_b, float facor);
 // ================================
+// Clip functions
+// ================================
+int8_t  d2d_clip_push(D2DContext *context, Rectangle_f rect);
+void    d2d_clip_pop(D2DContext *context);
+uint8_t d2d_clip_reject(D2DContext *context, Matrix44 *projection, Rectangle_f bounds);
+void    d2d_clip_reset(ClipBatch *batches, uint32_t *batch_count);
+int8_t  d2d_clip_batch(D2DContext *context, ClipBatch *batches, uint32_t *batch_count, uint32_t first);
+void    d2d_clip_apply(D2DContext *context, ClipBatch *batch);
+void    d2d_clip_restore(D2DContext *context);
+// ================================
+// Renderer overflow functions
+// ================================
+void   d2d_renderer_overflow(RendererOverflow* overflow, uint8_t mode, uint32_t capacity_max);
+// ================================
 // Renderer Circle functions
 // ================================
 int8_t d2d_renderer_circle_init(RendererCircle* renderer, uint32_t capacity, D2DContext* context);
@@ -431,9 +1027,33 @@ int8_t d2d_renderer_primitive_add_rectangle_outline(RendererPrimitive* renderer,
 int8_t d2d_renderer_primitive_begin(RendererPrimitive* renderer, Matrix44* projection, GLuint* shader,uint8_t type);
 int8_t d2d_renderer_primitive_end(RendererPrimitive* renderer);
 // ================================
+// Path functions
+// ================================
+int8_t d2d_path_init(Path* path);
+void   d2d_path_free(Path* path);
+void   d2d_path_clear(Path* path);
+int8_t d2d_path_move_to(Path* path, Vector2f point);
+int8_t d2d_path_line_to(Path* path, Vector2f point);
+int8_t d2d_path_quad_to(Path* path, Vector2f control, Vector2f point);
+int8_t d2d_path_cubic_to(Path* path, Vector2f control_a, Vector2f control_b, Vector2f point);
+int8_t d2d_path_arc(Path* path, Vector2f center, float radius, float angle_start, float angle_end);
+void   d2d_path_close(Path* path);
+int8_t d2d_path_stroke(RendererPrimitive* renderer, Path* path, PathStyle* style);
+// ================================
+// Plot functions
+// ================================
+int8_t d2d_plot_series_init(PlotSeries* series, uint32_t capacity, float x_start, float x_step);
+void   d2d_plot_series_free(PlotSeries* series);
+void   d2d_plot_series_clear(PlotSeries* series);
+int8_t d2d_plot_series_reserve(PlotSeries* series, uint32_t capacity);
+int8_t d2d_plot_series_append(PlotSeries* series, float* values, uint32_t count);
+void   d2d_plot_series_decimate(PlotSeries* series, float x_min, float x_max, uint32_t columns, Vector2f* out);
+int8_t d2d_plot_series_draw(RendererPrimitive* renderer, PlotSeries* series, Rectangle_f rect, Vector2f range_x, Vector2f range_y, Color color);
+// ================================
 // Renderer Sprite functions
 // ================================
 int8_t d2d_renderer_sprite_init(RendererSprite* renderer, uint32_t capacity,D2DContext* context);
+void   d2d_renderer_sprite_free(RendererSprite* renderer);
 int8_t d2d_renderer_sprite_apply_shader(RendererSprite* renderer,uint32_t shader);
 int8_t d2d_renderer_sprite_update(RendererSprite* renderer);
 int8_t d2d_renderer_sprite_render(RendererSprite* renderer);
@@ -448,27 +1068,106 @@ int8_t d2d_renderer_sprite_end(RendererSprite* renderer);
 int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer,D2DContext* context,uint32_t capacity);
 int8_t d2d_renderer_sprite_font_apply_shader(RendererSpriteFont* renderer,uint32_t shader);
 int8_t d2d_renderer_sprite_font_update(RendererSpriteFont* renderer);
+int8_t d2d_renderer_sprite_font_add_texture(RendererSpriteFont* renderer,uint32_t texture_id);
 int8_t d2d_renderer_sprite_font_add_font(RendererSpriteFont* renderer,SpriteFont* sprite_font);
 int8_t d2d_renderer_sprite_font_render(RendererSpriteFont* renderer);
 int8_t d2d_renderer_sprite_font_begin(RendererSpriteFont* renderer,Matrix44 projection);
 int8_t d2d_renderer_sprite_font_end(RendererSpriteFont* renderer);
-int8_t d2d_renderer_sprite_font_add_text(RendererSpriteFont* renderer,SpriteFont* sprite_font,char* text,uint32_t max_length,Vector2f position,Color color,Vector2f limit_y);
+int8_t d2d_renderer_sprite_font_add_text(RendererSpriteFont* renderer,SpriteFont* sprite_font,char* text,uint32_t max_length,Vector2f position,Color color);
+int8_t d2d_renderer_sprite_font_add_text_sized(RendererSpriteFont* renderer,SpriteFont* sprite_font,char* text,uint32_t max_length,Vector2f position,Color color,float size);
+// ================================
+// Arena functions
+// ================================
+int8_t    d2d_arena_init(Arena* arena,size_t capacity);
+void      d2d_arena_free(Arena* arena);
+void*     d2d_arena_alloc(Arena* arena,size_t size);
+void*     d2d_arena_grow(Arena* arena,void* ptr,size_t size,size_t new_size);
+void      d2d_arena_reset(Arena* arena);
+ArenaMark d2d_arena_mark(Arena* arena);
+void      d2d_arena_release(Arena* arena,ArenaMark mark);
+uint64_t  d2d_alloc_count(void);
+// ================================
+// Job system functions
+// ================================
+extern _Thread_local uint32_t d2d_job_worker_index;
+int8_t d2d_job_system_init(JobSystem* system,uint32_t worker_count,uint8_t pin);
+void   d2d_job_system_free(JobSystem* system);
+void   d2d_job_system_profile(JobSystem* system,JobProfileFn profile_fn,void* user);
+void   d2d_job_system_stats_reset(JobSystem* system);
+void   d2d_job_submit(JobSystem* system,JobFn fn,void* data,uint32_t begin,uint32_t end,JobCounter* counter,const char* name);
+void   d2d_job_parallel_for(JobSystem* system,JobFn fn,void* data,uint32_t count,uint32_t grain,JobCounter* counter,const char* name);
+void   d2d_job_wait(JobSystem* system,JobCounter* counter);
+// ================================
+// Command recording functions
+// ================================
+int8_t         d2d_command_recorder_init(CommandRecorder* recorder,uint32_t thread_count);
+void           d2d_command_recorder_free(CommandRecorder* recorder);
+void           d2d_command_recorder_reset(CommandRecorder* recorder,Arena* arena);
+CommandBucket* d2d_command_recorder_bucket(CommandRecorder* recorder,uint32_t thread_index);
+int8_t         d2d_command_sprite(CommandBucket* bucket,uint8_t layer,float x,float y,float dest_width,float dest_height,Rectangle_f src_rect,Texture* texture,Color color);
+int8_t         d2d_command_primitive(CommandBucket* bucket,Vector2f position,Color color);
+int8_t         d2d_command_circle(CommandBucket* bucket,Vector2f position,Color color,float radius);
+int8_t         d2d_command_text(CommandBucket* bucket,uint8_t layer,SpriteFont* sprite_font,const char* text,uint32_t max_length,Vector2f position,Color color,float size);
+int8_t         d2d_command_merge_sprites(CommandRecorder* recorder,RendererSprite* renderer);
+int8_t         d2d_command_merge_primitives(CommandRecorder* recorder,RendererPrimitive* renderer);
+int8_t         d2d_command_merge_circles(CommandRecorder* recorder,RendererCircle* renderer);
+int8_t         d2d_command_merge_text(CommandRecorder* recorder,RendererSpriteFont* renderer);
+// ================================
+// Text cache functions
+// ================================
+int8_t      d2d_text_cache_init(TextCache *cache);
+void        d2d_text_cache_free(TextCache *cache);
+void        d2d_text_cache_clear(TextCache *cache);
+TextLayout* d2d_text_cache_get(TextCache *cache, SpriteFont *sprite_font, const char *text, uint32_t max_length, float scale);
+void        d2d_text_cache_measure(TextCache *cache, SpriteFont *sprite_font, const char *text, FontMeasurement *measurement);
 // ================================
 // SpriteFont functions
 // ================================
 int8_t    d2d_sprite_font_load(SpriteFont *sprite_font, char *path, uint16_t font_size);
+int8_t    d2d_sprite_font_load_sdf(SpriteFont *sprite_font, char *path, uint16_t reference_size);
+void      d2d_sprite_font_free(SpriteFont *sprite_font);
+Glyph*    d2d_sprite_font_glyph(SpriteFont *sprite_font, uint32_t codepoint);
+void      d2d_sprite_font_frame(SpriteFont *sprite_font, D2DContext *context);
+int8_t    d2d_sprite_font_enable_kerning(SpriteFont *sprite_font);
+int32_t   d2d_sprite_font_kerning(SpriteFont *sprite_font, uint32_t left, uint32_t right);
+void      d2d_sprite_font_place_glyph(SpriteFont *sprite_font, Glyph *glyph, Vector2f position, float scale, Matrix44 *transform, Vector2f *offset, Rectangle_f *src_rect);
 int32_t   d2d_sprite_font_set_caret_mouse(char *text, uint32_t offset, SpriteFont *sprite_font, Vector2f mp);
-uint32_t* d2d_sprite_font_convert_to_unicode(const char *string_utf8);
 uint32_t  d2d_sprite_font_calc_char_limit(char *text, SpriteFont *sprite_font, int32_t max_width);
+void      d2d_sprite_font_measure(SpriteFont *sprite_font, const char *text, int32_t limit_ch, int32_t limit_px, float caret_x, FontMeasurement *measurement);
 void      d2d_sprite_font_measure_string(char *text, SpriteFont *sprite_font, FontMeasurement *measurement,int16_t limit_ch,int16_t limit_px);
 Vector2f  d2d_sprite_font_measure_string2(char *text, SpriteFont *sprite_font);
+// ================================
+// Font cache functions
+// ================================
+extern FontCache d2d_font_cache;
+int8_t   d2d_font_cache_init(char *directory);
+uint64_t d2d_font_cache_key(SpriteFont *sprite_font);
+int8_t   d2d_font_cache_load(SpriteFont *sprite_font);
+int8_t   d2d_font_cache_store(SpriteFont *sprite_font);
 #endif
 
 #if defined(DELO2D_IMPLEMENTATION)
-#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 #include <stb_image.h>
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+#define DELO_FREETYPE_SDF
+#endif
 // ================================
 // OpenGL debugging functions
 // ================================
@@ -1016,120 +1715,622 @@ int8_t d2d_context_init(D2DContext*     context
 
     context->back_buffer_width = buffer_width;
     context->back_buffer_height = buffer_height;
+    context->clip_stack.depth   = 0;
+    context->clip_stack.target  = (Vector2f){0, 0};
+    context->glfw_callback_data.scroll_y = 0;
+    context->reactive           = (ReactiveFrame){0};
+    context->reactive.input_damage = 1;
+    d2d_input_queue_init(&context->glfw_callback_data.input_queue);
+
+    context->pacing        = (FramePacing){0};
+    context->pacing.step   = 1.0 / 60.0;
+    context->pacing.dt_max = 0.25;
+
+    context->frame                = 0;
+    context->frame_arena          = 0;
+    context->renderer_stats       = (RendererStats){0};
+    context->renderer_stats_frame = (RendererStats){0};
+
+    if (d2d_arena_init(&context->frame_arenas[0], DELO_FRAME_ARENA_SIZE) == DELO_ERROR
+     || d2d_arena_init(&context->frame_arenas[1], DELO_FRAME_ARENA_SIZE) == DELO_ERROR
+     || d2d_arena_init(&context->scratch, DELO_SCRATCH_ARENA_SIZE) == DELO_ERROR)
+    {
+        glfwDestroyWindow(context->window);
+        glfwTerminate();
+        return DELO_ERROR;
+    }
 
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
 
     context->t0 = glfwGetTime();
+    context->dt = 0;
     context->t = 0;
 
+    return DELO_SUCCESS;
+}
+static uint64_t d2d_frame_input_hash(D2DContext *context)
+{
+    HidState *hid_state = &context->hid_state;
+    uint64_t  hash      = 14695981039346656037ULL;
+
+    // Field by field, struct padding would make a whole-struct hash unstable.
+    hash = d2d_hash_fnv1a(&hid_state->mouse_button_left, sizeof(uint8_t) * 3, hash);
+    hash = d2d_hash_fnv1a(&hid_state->mouse_position_x, sizeof(double), hash);
+    hash = d2d_hash_fnv1a(&hid_state->mouse_position_y, sizeof(double), hash);
+    hash = d2d_hash_fnv1a(&hid_state->window_width, sizeof(int) * 2, hash);
+    hash = d2d_hash_fnv1a(&hid_state->key_escape, sizeof(int) * 13, hash);
+
+    return hash;
 }
-void d2d_frame_begin(D2DContext *context)
+uint8_t d2d_frame_begin(D2DContext *context)
 {
+    // The previous frame's arena stays intact for one more frame, so data handed to it can still be read.
+    context->frame_arena ^= 1;
+    d2d_arena_reset(&context->frame_arenas[context->frame_arena]);
+    d2d_arena_reset(&context->scratch);
+
     glViewport(0, 0, context->back_buffer_width, context->back_buffer_height);
-    context->t1 = glfwGetTime();
-    context->dt = context->t1 - context->t0;
+    context->clip_stack.target = (Vector2f){0, 0};
+
+    ReactiveFrame *reactive = &context->reactive;
+
+    if (!reactive->enabled)
+    {
+        return 1;
+    }
+
+    uint64_t input_hash = d2d_frame_input_hash(context);
+
+    if (input_hash != reactive->input_hash || context->glfw_callback_data.key_buffer_length > 0 || context->glfw_callback_data.scroll_y != 0)
+    {
+        reactive->input_hash = input_hash;
+
+        if (reactive->input_damage)
+        {
+            d2d_frame_invalidate(context);
+        }
+    }
+
+    if (!reactive->damaged)
+    {
+        return 0;
+    }
+
+    reactive->drawing = 1;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, reactive->fbo);
+    d2d_clip_restore(context);
+
+    return 1;
 }
 void d2d_frame_end(D2DContext *context)
 {
+    ReactiveFrame *reactive = &context->reactive;
+    FramePacing   *pacing   = &context->pacing;
+
     context->glfw_callback_data.key_buffer[0] = '\0';
     context->glfw_callback_data.key_buffer_length = 0;
+    context->glfw_callback_data.scroll_y = 0;
 
     context->hid_state_prev = context->hid_state;
-    context->t += 0.1f;
-    glfwSwapBuffers(context->window);
-    context->t0 = context->t1;
-
-    glfwPollEvents();
-}
-// ================================
-// Human Input Device functions
-// ================================
-void d2d_hid_control_init(HidState*   hid_state
-                         ,GLFWwindow* window
-                         )
-{
-    hid_state->mouse_button_left = GLFW_RELEASE;
-    hid_state->mouse_button_right = GLFW_RELEASE;
-    hid_state->mouse_button_middle = GLFW_RELEASE;
 
-    glfwGetCursorPos(window, &hid_state->mouse_position_x, &hid_state->mouse_position_y);
+    uint8_t drawn = !reactive->enabled || reactive->drawing;
 
-    int fbx,fby;
-    glfwGetFramebufferSize(window, &fbx, &fby);
-    int wx,wy;
-    glfwGetWindowSize(window,&wx,&wy);
+    if (drawn)
+    {
+        if (reactive->enabled)
+        {
+            glDisable(GL_SCISSOR_TEST);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, reactive->fbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, context->back_buffer_width, context->back_buffer_height
+                             ,0, 0, context->back_buffer_width, context->back_buffer_height
+                             ,GL_COLOR_BUFFER_BIT, GL_NEAREST
+                             );
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
 
-    float mpx = (float)hid_state->mouse_position_x/(float)wx;
-    float mpy = (float)hid_state->mouse_position_y/(float)wy;
+        d2d_frame_pace(context);
+        glfwSwapBuffers(context->window);
+        reactive->frames_drawn++;
+    }
+    else
+    {
+        reactive->frames_skipped++;
+    }
 
-    hid_state->mouse_position_x = mpx * fbx;
-    hid_state->mouse_position_y = mpy * fby;
+    reactive->drawing     = 0;
+    reactive->damaged     = 0;
+    reactive->damage_full = 0;
 
+    context->renderer_stats_frame = context->renderer_stats;
+    context->renderer_stats       = (RendererStats){0};
+    context->frame++;
 
-}
+    context->t1 = glfwGetTime();
+    context->dt = context->t1 - context->t0;
+    context->t0 = context->t1;
 
-void d2d_hid_control_update(HidState*   hid_state
-                           ,GLFWwindow* window
-                           ,int         window_width
-                           ,int         window_height
-                           ,int         back_buffer_width
-                           ,int         back_buffer_height
-                           )
-{
-    hid_state->mouse_button_left   = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
-    hid_state->mouse_button_right  = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT);
-    hid_state->mouse_button_middle = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE);
+    // A frame that followed an idle wait measures the wait, not the frame.
+    if (drawn && !pacing->waited)
+    {
+        pacing->history[pacing->history_index] = (float)(context->dt * 1000.0);
+        pacing->history_index = (pacing->history_index + 1) % DELO_FRAME_HISTORY;
 
-    glfwGetCursorPos(window, &hid_state->mouse_position_x, &hid_state->mouse_position_y);
+        if (pacing->history_count < DELO_FRAME_HISTORY)
+        {
+            pacing->history_count++;
+        }
+    }
 
-    hid_state->key_escape      = glfwGetKey(window, GLFW_KEY_ESCAPE);
-    hid_state->key_backspace   = glfwGetKey(window, GLFW_KEY_BACKSPACE);
-    hid_state->key_enter       = glfwGetKey(window, GLFW_KEY_ENTER);
-    hid_state->key_arrow_left  = glfwGetKey(window, GLFW_KEY_LEFT);
-    hid_state->key_arrow_right = glfwGetKey(window, GLFW_KEY_RIGHT);
-    hid_state->key_ctrl_left   = glfwGetKey(window, GLFW_KEY_LEFT_CONTROL);
-    hid_state->key_c           = glfwGetKey(window, GLFW_KEY_C);
-    hid_state->key_v           = glfwGetKey(window, GLFW_KEY_V);
-    hid_state->key_a           = glfwGetKey(window, GLFW_KEY_A);
-    hid_state->key_tab         = glfwGetKey(window, GLFW_KEY_TAB);
-    hid_state->key_shift_left  = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT);
-}
+    // Clamping keeps a stall from turning into a burst of catch-up steps.
+    pacing->accumulator += fmin(context->dt, pacing->dt_max);
 
-void d2d_append_utf8(uint32_t  codepoint
-                    ,char*     buffer
-                    ,uint16_t* index
-                    )
-{
-    if (codepoint <= 0x7F)
-    {
-        buffer[(*index)++] = (char)codepoint;
-    }
-    else if (codepoint <= 0x7FF)
+    if (pacing->accumulator > pacing->dt_max)
     {
-        buffer[(*index)++] = (char)((codepoint >> 6) | 0xC0);
-        buffer[(*index)++] = (char)((codepoint & 0x3F) | 0x80);
+        pacing->accumulator = pacing->dt_max;
     }
-    else if (codepoint <= 0xFFFF)
+
+    pacing->waited = !drawn;
+
+    // Keep polling while frames change so animations run at full rate, block once the screen is static.
+    if (drawn)
     {
-        buffer[(*index)++] = (char)((codepoint >> 12) | 0xE0);
-        buffer[(*index)++] = (char)(((codepoint >> 6) & 0x3F) | 0x80);
-        buffer[(*index)++] = (char)((codepoint & 0x3F) | 0x80);
+        glfwPollEvents();
     }
     else
     {
-        buffer[(*index)++] = (char)((codepoint >> 18) | 0xF0);
-        buffer[(*index)++] = (char)(((codepoint >> 12) & 0x3F) | 0x80);
-        buffer[(*index)++] = (char)(((codepoint >> 6) & 0x3F) | 0x80);
-        buffer[(*index)++] = (char)((codepoint & 0x3F) | 0x80);
+        glfwWaitEventsTimeout(reactive->idle_timeout);
     }
 }
-void d2d_callback_character(GLFWwindow*  window
-                           ,unsigned int codepoint
-                           )
+void d2d_frame_pacing(D2DContext *context
+                     ,double      step
+                     ,double      target_fps
+                     ,int         swap_interval
+                     )
 {
-    GlfwCallbackData *glfw_callback_data = (GlfwCallbackData *)(glfwGetWindowUserPointer(window));
-    d2d_append_utf8(codepoint, &glfw_callback_data->key_buffer[0], &glfw_callback_data->key_buffer_length);
+    FramePacing *pacing = &context->pacing;
+
+    pacing->step        = step;
+    pacing->target      = (target_fps > 0) ? 1.0 / target_fps : 0;
+    pacing->accumulator = 0;
+
+    // Adaptive vsync tears instead of halving the frame rate when a frame misses, drivers without it get plain vsync.
+    if (swap_interval == DELO_SWAP_ADAPTIVE
+    && !glfwExtensionSupported("WGL_EXT_swap_control_tear")
+    && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+    {
+        swap_interval = 1;
+    }
+
+    pacing->swap_interval = swap_interval;
+    glfwSwapInterval(swap_interval);
+}
+void d2d_frame_pace(D2DContext *context)
+{
+    FramePacing *pacing = &context->pacing;
+
+    if (pacing->target <= 0)
+    {
+        return;
+    }
+
+    double deadline  = context->t0 + pacing->target;
+    double remaining = deadline - glfwGetTime();
+
+    // The scheduler can oversleep by a millisecond or more, the last stretch is spun.
+    if (remaining > DELO_FRAME_SPIN)
+    {
+        double sleep = remaining - DELO_FRAME_SPIN;
+
+        struct timespec duration;
+        duration.tv_sec  = (time_t)sleep;
+        duration.tv_nsec = (long)((sleep - (double)duration.tv_sec) * 1e9);
+
+        nanosleep(&duration, NULL);
+    }
+
+    while (glfwGetTime() < deadline)
+    {
+    }
+}
+uint8_t d2d_frame_step(D2DContext *context)
+{
+    FramePacing *pacing = &context->pacing;
+
+    if (pacing->accumulator >= pacing->step)
+    {
+        pacing->accumulator -= pacing->step;
+        pacing->time        += pacing->step;
+        context->t           = (float)pacing->time;
+        return 1;
+    }
+
+    pacing->alpha = (float)(pacing->accumulator / pacing->step);
+    return 0;
+}
+static int d2d_frame_compare(const void *a
+                            ,const void *b
+                            )
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+
+    return (fa > fb) - (fa < fb);
+}
+FrameStats d2d_frame_stats(D2DContext *context)
+{
+    FramePacing *pacing = &context->pacing;
+    FrameStats   stats  = {0, 0, 0};
+    float        sorted[DELO_FRAME_HISTORY];
+
+    if (pacing->history_count == 0)
+    {
+        return stats;
+    }
+
+    memcpy(sorted, pacing->history, sizeof(float) * pacing->history_count);
+    qsort(sorted, pacing->history_count, sizeof(float), d2d_frame_compare);
+
+    stats.p50 = sorted[(pacing->history_count - 1) / 2];
+    stats.p99 = sorted[(pacing->history_count - 1) * 99 / 100];
+    stats.max = sorted[pacing->history_count - 1];
+
+    return stats;
+}
+Arena* d2d_frame_arena(D2DContext *context)
+{
+    return &context->frame_arenas[context->frame_arena];
+}
+Arena* d2d_frame_arena_prev(D2DContext *context)
+{
+    return &context->frame_arenas[context->frame_arena ^ 1];
+}
+Arena* d2d_frame_scratch(D2DContext *context)
+{
+    return &context->scratch;
+}
+int8_t d2d_frame_reactive(D2DContext *context
+                         ,uint8_t     enabled
+                         ,double      idle_timeout
+                         )
+{
+    ReactiveFrame *reactive = &context->reactive;
+
+    if (enabled && reactive->fbo == 0)
+    {
+        glGenFramebuffers(1, &reactive->fbo);
+        glGenTextures(1, &reactive->texture);
+
+        glBindTexture(GL_TEXTURE_2D, reactive->texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, context->back_buffer_width, context->back_buffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, reactive->fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, reactive->texture, 0);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            fprintf(stderr, "Error creating reactive frame buffer\n");
+            glDeleteFramebuffers(1, &reactive->fbo);
+            glDeleteTextures(1, &reactive->texture);
+            reactive->fbo     = 0;
+            reactive->texture = 0;
+            return DELO_ERROR;
+        }
+    }
+    else if (!enabled && reactive->fbo != 0)
+    {
+        glDeleteFramebuffers(1, &reactive->fbo);
+        glDeleteTextures(1, &reactive->texture);
+        reactive->fbo     = 0;
+        reactive->texture = 0;
+    }
+
+    reactive->enabled      = enabled;
+    reactive->idle_timeout = idle_timeout;
+
+    d2d_frame_invalidate(context);
+
+    return DELO_SUCCESS;
+}
+GLuint d2d_frame_target(D2DContext *context)
+{
+    return context->reactive.enabled ? context->reactive.fbo : 0;
+}
+void d2d_frame_damage(D2DContext  *context
+                     ,Rectangle_f  rect
+                     )
+{
+    ReactiveFrame *reactive = &context->reactive;
+
+    if (!reactive->damaged)
+    {
+        reactive->damage  = rect;
+        reactive->damaged = 1;
+        return;
+    }
+
+    float x0 = fminf(reactive->damage.x, rect.x);
+    float y0 = fminf(reactive->damage.y, rect.y);
+    float x1 = fmaxf(reactive->damage.x + reactive->damage.width, rect.x + rect.width);
+    float y1 = fmaxf(reactive->damage.y + reactive->damage.height, rect.y + rect.height);
+
+    reactive->damage = (Rectangle_f){x0, y0, x1 - x0, y1 - y0};
+}
+void d2d_frame_invalidate(D2DContext *context)
+{
+    context->reactive.damaged     = 1;
+    context->reactive.damage_full = 1;
+}
+// ================================
+// Input queue functions
+// ================================
+void d2d_input_queue_init(InputQueue* queue)
+{
+    atomic_store_explicit(&queue->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&queue->tail, 0, memory_order_relaxed);
+    queue->dropped = 0;
+}
+int8_t d2d_input_queue_push(InputQueue* queue
+                           ,InputEvent  event
+                           )
+{
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if (tail - head >= DELO_INPUT_QUEUE_SIZE)
+    {
+        queue->dropped++;
+        return DELO_ERROR;
+    }
+
+    queue->events[tail & (DELO_INPUT_QUEUE_SIZE - 1)] = event;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return DELO_SUCCESS;
+}
+uint32_t d2d_input_queue_drain(InputQueue* queue
+                              ,InputEvent* events
+                              ,uint32_t    capacity
+                              )
+{
+    uint32_t head  = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint32_t tail  = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    uint32_t count = 0;
+
+    while (head != tail && count < capacity)
+    {
+        events[count++] = queue->events[head & (DELO_INPUT_QUEUE_SIZE - 1)];
+        head++;
+    }
+
+    atomic_store_explicit(&queue->head, head, memory_order_release);
+
+    return count;
+}
+static void d2d_input_queue_push_window(GLFWwindow* window
+                                       ,uint8_t     type
+                                       ,int32_t     code
+                                       ,int32_t     action
+                                       ,double      x
+                                       ,double      y
+                                       )
+{
+    GlfwCallbackData *glfw_callback_data = (GlfwCallbackData *)(glfwGetWindowUserPointer(window));
+
+    InputEvent event;
+    event.time   = glfwGetTime();
+    event.x      = x;
+    event.y      = y;
+    event.code   = code;
+    event.action = action;
+    event.type   = type;
+
+    d2d_input_queue_push(&glfw_callback_data->input_queue, event);
+}
+void d2d_callback_cursor_position(GLFWwindow* window
+                                 ,double      x
+                                 ,double      y
+                                 )
+{
+    d2d_input_queue_push_window(window, DELO_INPUT_CURSOR, 0, 0, x, y);
+}
+void d2d_callback_mouse_button(GLFWwindow* window
+                              ,int         button
+                              ,int         action
+                              ,int         mods
+                              )
+{
+    (void)mods;
+
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    d2d_input_queue_push_window(window, DELO_INPUT_BUTTON, button, action, x, y);
+}
+void d2d_callback_key(GLFWwindow* window
+                     ,int         key
+                     ,int         scancode
+                     ,int         action
+                     ,int         mods
+                     )
+{
+    (void)scancode;
+    (void)mods;
+
+    d2d_input_queue_push_window(window, DELO_INPUT_KEY, key, action, 0, 0);
+}
+// ================================
+// Human Input Device functions
+// ================================
+void d2d_hid_control_init(HidState*   hid_state
+                         ,GLFWwindow* window
+                         )
+{
+    hid_state->mouse_button_left = GLFW_RELEASE;
+    hid_state->mouse_button_right = GLFW_RELEASE;
+    hid_state->mouse_button_middle = GLFW_RELEASE;
+
+    hid_state->key_escape      = GLFW_RELEASE;
+    hid_state->key_backspace   = GLFW_RELEASE;
+    hid_state->key_enter       = GLFW_RELEASE;
+    hid_state->key_arrow_left  = GLFW_RELEASE;
+    hid_state->key_arrow_right = GLFW_RELEASE;
+    hid_state->key_ctrl_left   = GLFW_RELEASE;
+    hid_state->key_shift_left  = GLFW_RELEASE;
+    hid_state->key_c           = GLFW_RELEASE;
+    hid_state->key_v           = GLFW_RELEASE;
+    hid_state->key_a           = GLFW_RELEASE;
+    hid_state->key_tab         = GLFW_RELEASE;
+    hid_state->key_arrow_up    = GLFW_RELEASE;
+    hid_state->key_arrow_down  = GLFW_RELEASE;
+
+    glfwGetCursorPos(window, &hid_state->mouse_position_x, &hid_state->mouse_position_y);
+
+    int fbx,fby;
+    glfwGetFramebufferSize(window, &fbx, &fby);
+    int wx,wy;
+    glfwGetWindowSize(window,&wx,&wy);
+
+    float mpx = (float)hid_state->mouse_position_x/(float)wx;
+    float mpy = (float)hid_state->mouse_position_y/(float)wy;
+
+    hid_state->mouse_position_x = mpx * fbx;
+    hid_state->mouse_position_y = mpy * fby;
+
+
+}
+
+void d2d_hid_control_update(HidState*   hid_state
+                           ,GLFWwindow* window
+                           ,int         window_width
+                           ,int         window_height
+                           ,int         back_buffer_width
+                           ,int         back_buffer_height
+                           )
+{
+    hid_state->mouse_button_left   = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
+    hid_state->mouse_button_right  = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT);
+    hid_state->mouse_button_middle = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE);
+
+    glfwGetCursorPos(window, &hid_state->mouse_position_x, &hid_state->mouse_position_y);
+
+    hid_state->key_escape      = glfwGetKey(window, GLFW_KEY_ESCAPE);
+    hid_state->key_backspace   = glfwGetKey(window, GLFW_KEY_BACKSPACE);
+    hid_state->key_enter       = glfwGetKey(window, GLFW_KEY_ENTER);
+    hid_state->key_arrow_left  = glfwGetKey(window, GLFW_KEY_LEFT);
+    hid_state->key_arrow_right = glfwGetKey(window, GLFW_KEY_RIGHT);
+    hid_state->key_ctrl_left   = glfwGetKey(window, GLFW_KEY_LEFT_CONTROL);
+    hid_state->key_c           = glfwGetKey(window, GLFW_KEY_C);
+    hid_state->key_v           = glfwGetKey(window, GLFW_KEY_V);
+    hid_state->key_a           = glfwGetKey(window, GLFW_KEY_A);
+    hid_state->key_tab         = glfwGetKey(window, GLFW_KEY_TAB);
+    hid_state->key_shift_left  = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT);
+    hid_state->key_arrow_up    = glfwGetKey(window, GLFW_KEY_UP);
+    hid_state->key_arrow_down  = glfwGetKey(window, GLFW_KEY_DOWN);
+}
+void d2d_hid_control_apply(HidState*   hid_state
+                          ,InputEvent* events
+                          ,uint32_t    count
+                          )
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        InputEvent *event = &events[i];
+
+        // Key repeats still read as held.
+        int state = (event->action == GLFW_RELEASE) ? GLFW_RELEASE : GLFW_PRESS;
+
+        switch (event->type)
+        {
+        case DELO_INPUT_CURSOR:
+            hid_state->mouse_position_x = event->x;
+            hid_state->mouse_position_y = event->y;
+            break;
+        case DELO_INPUT_BUTTON:
+            hid_state->mouse_position_x = event->x;
+            hid_state->mouse_position_y = event->y;
+
+            switch (event->code)
+            {
+            case GLFW_MOUSE_BUTTON_LEFT:   hid_state->mouse_button_left   = state; break;
+            case GLFW_MOUSE_BUTTON_RIGHT:  hid_state->mouse_button_right  = state; break;
+            case GLFW_MOUSE_BUTTON_MIDDLE: hid_state->mouse_button_middle = state; break;
+            }
+            break;
+        case DELO_INPUT_KEY:
+            switch (event->code)
+            {
+            case GLFW_KEY_ESCAPE:       hid_state->key_escape      = state; break;
+            case GLFW_KEY_BACKSPACE:    hid_state->key_backspace   = state; break;
+            case GLFW_KEY_ENTER:        hid_state->key_enter       = state; break;
+            case GLFW_KEY_LEFT:         hid_state->key_arrow_left  = state; break;
+            case GLFW_KEY_RIGHT:        hid_state->key_arrow_right = state; break;
+            case GLFW_KEY_UP:           hid_state->key_arrow_up    = state; break;
+            case GLFW_KEY_DOWN:         hid_state->key_arrow_down  = state; break;
+            case GLFW_KEY_LEFT_CONTROL: hid_state->key_ctrl_left   = state; break;
+            case GLFW_KEY_LEFT_SHIFT:   hid_state->key_shift_left  = state; break;
+            case GLFW_KEY_C:            hid_state->key_c           = state; break;
+            case GLFW_KEY_V:            hid_state->key_v           = state; break;
+            case GLFW_KEY_A:            hid_state->key_a           = state; break;
+            case GLFW_KEY_TAB:          hid_state->key_tab         = state; break;
+            }
+            break;
+        }
+    }
+}
+
+void d2d_append_utf8(uint32_t  codepoint
+                    ,char*     buffer
+                    ,uint16_t* index
+                    )
+{
+    if (codepoint <= 0x7F)
+    {
+        buffer[(*index)++] = (char)codepoint;
+    }
+    else if (codepoint <= 0x7FF)
+    {
+        buffer[(*index)++] = (char)((codepoint >> 6) | 0xC0);
+        buffer[(*index)++] = (char)((codepoint & 0x3F) | 0x80);
+    }
+    else if (codepoint <= 0xFFFF)
+    {
+        buffer[(*index)++] = (char)((codepoint >> 12) | 0xE0);
+        buffer[(*index)++] = (char)(((codepoint >> 6) & 0x3F) | 0x80);
+        buffer[(*index)++] = (char)((codepoint & 0x3F) | 0x80);
+    }
+    else
+    {
+        buffer[(*index)++] = (char)((codepoint >> 18) | 0xF0);
+        buffer[(*index)++] = (char)(((codepoint >> 12) & 0x3F) | 0x80);
+        buffer[(*index)++] = (char)(((codepoint >> 6) & 0x3F) | 0x80);
+        buffer[(*index)++] = (char)((codepoint & 0x3F) | 0x80);
+    }
+}
+void d2d_callback_character(GLFWwindow*  window
+                           ,unsigned int codepoint
+                           )
+{
+    GlfwCallbackData *glfw_callback_data = (GlfwCallbackData *)(glfwGetWindowUserPointer(window));
+    d2d_append_utf8(codepoint, &glfw_callback_data->key_buffer[0], &glfw_callback_data->key_buffer_length);
+}
+void d2d_callback_scroll(GLFWwindow* window
+                        ,double      offset_x
+                        ,double      offset_y
+                        )
+{
+    GlfwCallbackData *glfw_callback_data = (GlfwCallbackData *)(glfwGetWindowUserPointer(window));
+    glfw_callback_data->scroll_y += offset_y;
+
+    d2d_input_queue_push_window(window, DELO_INPUT_SCROLL, 0, 0, offset_x, offset_y);
 }
 // ================================
 // Sprite functions
@@ -1309,6 +2510,23 @@ int8_t d2d_render_target_init(RenderTarget *rt,float screen_width,float screen_h
     rt->texture.width = width;
     rt->texture.height = height;
 }
+// Binds the target and its viewport, clips pushed afterwards are in its pixels. NULL goes back to the default framebuffer.
+void d2d_render_target_bind(D2DContext   *context
+                           ,RenderTarget *rt
+                           )
+{
+    if (rt == NULL)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, context->back_buffer_width, context->back_buffer_height);
+        context->clip_stack.target = (Vector2f){0, 0};
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, rt->fbo);
+    glViewport(0, 0, rt->texture.width, rt->texture.height);
+    context->clip_stack.target = (Vector2f){rt->texture.width, rt->texture.height};
+}
 // ================================
 // Shader functions
 // ================================
@@ -1402,6 +2620,11 @@ uint8_t d2d_shader_create(char*     source_code_shader_vertex
         return DELO_ERROR;
     }
 
+    if (d2d_shader_cache.enabled)
+    {
+        glProgramParameteri(*program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     uint32_t vs;
     uint32_t fs;
 
@@ -1473,6 +2696,8 @@ int8_t d2d_shader_load(char*     path_shader_vert
                       ,uint32_t* shader_id
                       )
 {
+    double t0 = glfwGetTime();
+
     *shader_id = 0;
     char *source_code_vert;
     char *source_code_frag;
@@ -1485,33 +2710,518 @@ int8_t d2d_shader_load(char*     path_shader_vert
     if (d2d_load_file(path_shader_frag, &source_code_frag) == DELO_ERROR)
     {
         printf("[delo2d] Could not load shader file %s\n", path_shader_frag);
+        free(source_code_vert);
         return DELO_ERROR;
     }
 
-    uint8_t status = DELO_SUCCESS;
+    int8_t   status = DELO_SUCCESS;
+    uint64_t key    = 0;
 
-    if (d2d_shader_create(source_code_vert, source_code_frag, shader_id) == DELO_ERROR)
+    if (d2d_shader_cache.enabled)
     {
-        if (source_code_vert != NULL)
-            free(source_code_vert);
-        if (source_code_frag != NULL)
-            free(source_code_frag);
-        return DELO_ERROR;
+        key = d2d_shader_cache_key(source_code_vert, source_code_frag);
     }
-    else
+
+    if (d2d_shader_cache.enabled && d2d_shader_cache_load(key, shader_id) == DELO_SUCCESS)
     {
-        return DELO_SUCCESS;
+        d2d_shader_cache.hits++;
+    }
+    else if (d2d_shader_create(source_code_vert, source_code_frag, shader_id) == DELO_ERROR)
+    {
+        status = DELO_ERROR;
     }
+    else if (d2d_shader_cache.enabled)
+    {
+        d2d_shader_cache.misses++;
+        d2d_shader_cache_store(key, *shader_id);
+    }
+
+    free(source_code_vert);
+    free(source_code_frag);
+
+    d2d_shader_cache.load_time += glfwGetTime() - t0;
+
+    return status;
 }
 // ================================
-// Texture functions
+// Shader cache functions
 // ================================
-int8_t d2d_texture_load(Texture* texture
-                       ,char     file_path[]
-                       )
+ShaderCache d2d_shader_cache = {0};
+
+int8_t d2d_shader_cache_init(char* directory)
 {
-    stbi_set_flip_vertically_on_load(0);
-    texture->local_buffer = stbi_load(file_path
+    GLint format_count = 0;
+
+    d2d_shader_cache.enabled = 0;
+
+    if (!GLEW_ARB_get_program_binary)
+    {
+        return DELO_ERROR;
+    }
+
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+    if (format_count <= 0)
+    {
+        return DELO_ERROR;
+    }
+
+    mkdir(directory, 0755);
+
+    snprintf(d2d_shader_cache.directory, sizeof(d2d_shader_cache.directory), "%s", directory);
+    d2d_shader_cache.enabled = 1;
+
+    return DELO_SUCCESS;
+}
+uint64_t d2d_shader_cache_key(char* source_code_shader_vertex
+                             ,char* source_code_shader_fragment
+                             )
+{
+    const char *renderer = (const char*)glGetString(GL_RENDERER);
+    const char *version  = (const char*)glGetString(GL_VERSION);
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    hash = d2d_hash_fnv1a(source_code_shader_vertex,   strlen(source_code_shader_vertex),   hash);
+    hash = d2d_hash_fnv1a(source_code_shader_fragment, strlen(source_code_shader_fragment), hash);
+
+    if (renderer != NULL)
+    {
+        hash = d2d_hash_fnv1a(renderer, strlen(renderer), hash);
+    }
+    if (version != NULL)
+    {
+        hash = d2d_hash_fnv1a(version, strlen(version), hash);
+    }
+
+    return hash;
+}
+int8_t d2d_shader_cache_load(uint64_t  key
+                            ,uint32_t* program
+                            )
+{
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%016llx.bin", d2d_shader_cache.directory, (unsigned long long)key);
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return DELO_ERROR;
+    }
+
+    uint32_t header[3];
+
+    if (fread(header, sizeof(header), 1, f) != 1 || header[0] != 0x43533244)
+    {
+        fclose(f);
+        return DELO_ERROR;
+    }
+
+    GLenum  format = header[1];
+    GLsizei length = header[2];
+
+    void *binary = malloc(length);
+    if (binary == NULL || fread(binary, length, 1, f) != 1)
+    {
+        free(binary);
+        fclose(f);
+        return DELO_ERROR;
+    }
+    fclose(f);
+
+    *program = glCreateProgram();
+    glProgramBinary(*program, format, binary, length);
+    free(binary);
+
+    GLint link_status = GL_FALSE;
+    glGetProgramiv(*program, GL_LINK_STATUS, &link_status);
+
+    // The driver rejects binaries from another driver version, fall back to compiling.
+    if (link_status == GL_FALSE)
+    {
+        glDeleteProgram(*program);
+        *program = 0;
+        return DELO_ERROR;
+    }
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_shader_cache_store(uint64_t key
+                             ,uint32_t program
+                             )
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0)
+    {
+        return DELO_ERROR;
+    }
+
+    void *binary = malloc(length);
+    if (binary == NULL)
+    {
+        return DELO_ERROR;
+    }
+
+    GLenum format = 0;
+    glGetProgramBinary(program, length, NULL, &format, binary);
+
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%016llx.bin", d2d_shader_cache.directory, (unsigned long long)key);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        free(binary);
+        return DELO_ERROR;
+    }
+
+    uint32_t header[3] = {0x43533244, format, (uint32_t)length};
+
+    fwrite(header, sizeof(header), 1, f);
+    fwrite(binary, length, 1, f);
+    fclose(f);
+    free(binary);
+
+    return DELO_SUCCESS;
+}
+// ================================
+// Shader registry functions
+// ================================
+void d2d_shader_registry_init(ShaderRegistry* registry)
+{
+    memset(registry, 0, sizeof(ShaderRegistry));
+
+    registry->debounce = 0.1;
+    registry->fd       = -1;
+
+#if defined(__linux__)
+    registry->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (registry->fd < 0)
+    {
+        printf("[delo2d] Shader hot-reload unavailable, inotify_init1 failed\n");
+    }
+#endif
+}
+static uint8_t d2d_shader_registry_watch(ShaderRegistry* registry
+                                        ,const char*     path
+                                        )
+{
+    char        dir[256];
+    const char *slash  = strrchr(path, '/');
+    size_t      length = (slash == NULL) ? 0 : (size_t)(slash - path);
+
+    if (length >= sizeof(dir))
+    {
+        length = sizeof(dir) - 1;
+    }
+
+    if (length == 0)
+    {
+        snprintf(dir, sizeof(dir), "%s", (slash == NULL) ? "." : "/");
+    }
+    else
+    {
+        memcpy(dir, path, length);
+        dir[length] = '\0';
+    }
+
+    for (uint8_t i = 0; i < registry->watch_count; i++)
+    {
+        if (strcmp(registry->watch_dirs[i], dir) == 0)
+        {
+            return i;
+        }
+    }
+
+    if (registry->watch_count >= DELO_SHADER_WATCH_CAPACITY)
+    {
+        return UINT8_MAX;
+    }
+
+    uint8_t index = registry->watch_count++;
+    snprintf(registry->watch_dirs[index], sizeof(registry->watch_dirs[index]), "%s", dir);
+    registry->watches[index] = -1;
+
+#if defined(__linux__)
+    // Watch the directory rather than the file, editors that save by rename would drop a file watch.
+    if (registry->fd >= 0)
+    {
+        registry->watches[index] = inotify_add_watch(registry->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    }
+#endif
+
+    return index;
+}
+int8_t d2d_shader_registry_add(ShaderRegistry* registry
+                              ,char*           path_shader_vert
+                              ,char*           path_shader_frag
+                              ,uint32_t*       program
+                              )
+{
+    if (registry->entry_count >= DELO_SHADER_REGISTRY_CAPACITY)
+    {
+        printf("[delo2d] Shader registry is full\n");
+        return d2d_shader_load(path_shader_vert, path_shader_frag, program);
+    }
+
+    ShaderEntry *entry = &registry->entries[registry->entry_count++];
+
+    snprintf(entry->path_vert, sizeof(entry->path_vert), "%s", path_shader_vert);
+    snprintf(entry->path_frag, sizeof(entry->path_frag), "%s", path_shader_frag);
+
+    entry->program    = program;
+    entry->dirty      = 0;
+    entry->modified   = 0.0;
+    entry->watch_vert = d2d_shader_registry_watch(registry, path_shader_vert);
+    entry->watch_frag = d2d_shader_registry_watch(registry, path_shader_frag);
+
+    // Registered even on failure so that fixing the source picks it up.
+    return d2d_shader_load(path_shader_vert, path_shader_frag, program);
+}
+int8_t d2d_shader_registry_bind(ShaderRegistry* registry
+                               ,uint32_t*       program
+                               ,void*           renderer
+                               ,uint8_t         type
+                               )
+{
+    if (registry->binding_count >= DELO_SHADER_BINDING_CAPACITY)
+    {
+        return DELO_ERROR;
+    }
+
+    for (uint8_t i = 0; i < registry->entry_count; i++)
+    {
+        if (registry->entries[i].program == program)
+        {
+            ShaderBinding *binding = &registry->bindings[registry->binding_count++];
+            binding->renderer = renderer;
+            binding->type     = type;
+            binding->entry    = i;
+            return DELO_SUCCESS;
+        }
+    }
+
+    return DELO_ERROR;
+}
+static uint8_t d2d_shader_registry_matches(ShaderRegistry* registry
+                                          ,const char*     path
+                                          ,uint8_t         watch
+                                          ,int32_t         wd
+                                          ,const char*     name
+                                          )
+{
+    if (watch >= registry->watch_count || registry->watches[watch] != wd)
+    {
+        return 0;
+    }
+
+    const char *slash = strrchr(path, '/');
+    const char *base  = (slash == NULL) ? path : slash + 1;
+
+    return strcmp(base, name) == 0;
+}
+void d2d_shader_registry_poll(ShaderRegistry* registry)
+{
+    double now = glfwGetTime();
+
+#if defined(__linux__)
+    if (registry->fd >= 0)
+    {
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+
+        while ((length = read(registry->fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (char *p = buffer; p < buffer + length;)
+            {
+                struct inotify_event *event = (struct inotify_event*)p;
+
+                if (event->len > 0)
+                {
+                    for (uint8_t i = 0; i < registry->entry_count; i++)
+                    {
+                        ShaderEntry *entry = &registry->entries[i];
+
+                        if (d2d_shader_registry_matches(registry, entry->path_vert, entry->watch_vert, event->wd, event->name) ||
+                            d2d_shader_registry_matches(registry, entry->path_frag, entry->watch_frag, event->wd, event->name))
+                        {
+                            entry->dirty    = 1;
+                            entry->modified = now;
+                        }
+                    }
+                }
+
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+
+    // Editors write in bursts, wait until the file has been quiet before recompiling.
+    for (uint8_t i = 0; i < registry->entry_count; i++)
+    {
+        ShaderEntry *entry = &registry->entries[i];
+
+        if (entry->dirty && now - entry->modified >= registry->debounce)
+        {
+            entry->dirty = 0;
+            d2d_shader_registry_reload(registry, i);
+        }
+    }
+}
+int8_t d2d_shader_registry_reload(ShaderRegistry* registry
+                                 ,uint8_t         index
+                                 )
+{
+    ShaderEntry *entry = &registry->entries[index];
+    uint32_t     program;
+
+    if (d2d_shader_load(entry->path_vert, entry->path_frag, &program) == DELO_ERROR)
+    {
+        printf("[delo2d] Reload of %s / %s failed, keeping previous program\n", entry->path_vert, entry->path_frag);
+        registry->failures++;
+        return DELO_ERROR;
+    }
+
+    uint32_t program_old = *entry->program;
+    *entry->program = program;
+
+    for (uint8_t i = 0; i < registry->binding_count; i++)
+    {
+        ShaderBinding *binding = &registry->bindings[i];
+
+        if (binding->entry != index)
+        {
+            continue;
+        }
+
+        switch (binding->type)
+        {
+            case DELO_RENDERER_SPRITE:
+                d2d_renderer_sprite_apply_shader((RendererSprite*)binding->renderer, program);
+                break;
+            case DELO_RENDERER_SPRITE_FONT:
+                d2d_renderer_sprite_font_apply_shader((RendererSpriteFont*)binding->renderer, program);
+                break;
+            case DELO_RENDERER_PRIMITIVE:
+                d2d_renderer_primitive_apply_shader((RendererPrimitive*)binding->renderer, program);
+                break;
+            case DELO_RENDERER_CIRCLE:
+                d2d_renderer_circle_apply_shader((RendererCircle*)binding->renderer, program);
+                break;
+        }
+    }
+
+    if (program_old != 0)
+    {
+        glDeleteProgram(program_old);
+    }
+
+    printf("[delo2d] Reloaded %s / %s\n", entry->path_vert, entry->path_frag);
+    registry->reloads++;
+
+    return DELO_SUCCESS;
+}
+// ================================
+// Hash functions
+// ================================
+uint64_t d2d_hash_fnv1a(const void* data
+                       ,size_t      length
+                       ,uint64_t    hash
+                       )
+{
+    const uint8_t *bytes = (const uint8_t*)data;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+// ================================
+// UTF-8 functions
+// ================================
+static inline uint32_t d2d_utf8_decode(const uint8_t* s
+                                      ,const uint8_t* end
+                                      ,uint32_t*      length
+                                      )
+{
+    uint8_t  b0 = s[0];
+    uint32_t n;
+    uint32_t c;
+
+    if      (b0 < 0x80)           { *length = 1; return b0; }
+    else if ((b0 & 0xE0) == 0xC0) { n = 2; c = b0 & 0x1F; }
+    else if ((b0 & 0xF0) == 0xE0) { n = 3; c = b0 & 0x0F; }
+    else if ((b0 & 0xF8) == 0xF0) { n = 4; c = b0 & 0x07; }
+    else                          { *length = 1; return 0xFFFD; }
+
+    if ((uint32_t)(end - s) < n)
+    {
+        *length = 1;
+        return 0xFFFD;
+    }
+
+    for (uint32_t i = 1; i < n; i++)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            *length = 1;
+            return 0xFFFD;
+        }
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+
+    // Overlong forms, UTF-16 surrogates and values past U+10FFFF are not code points.
+    static const uint32_t minimum[5] = {0, 0, 0x80, 0x800, 0x10000};
+
+    if (c < minimum[n] || (c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)
+    {
+        *length = 1;
+        return 0xFFFD;
+    }
+
+    *length = n;
+    return c;
+}
+// Number of leading ASCII bytes, tested eight at a time.
+static inline uint32_t d2d_utf8_ascii_run(const uint8_t* s
+                                         ,const uint8_t* end
+                                         )
+{
+    const uint8_t *p = s;
+
+    while (end - p >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, 8);
+
+        if (word & 0x8080808080808080ULL)
+        {
+            break;
+        }
+        p += 8;
+    }
+    while (p < end && *p < 0x80)
+    {
+        p++;
+    }
+
+    return (uint32_t)(p - s);
+}
+// ================================
+// Texture functions
+// ================================
+int8_t d2d_texture_load(Texture* texture
+                       ,char     file_path[]
+                       )
+{
+    stbi_set_flip_vertically_on_load(0);
+    texture->local_buffer = stbi_load(file_path
                                      ,&texture->width
                                      ,&texture->height
                                      ,&texture->bytes_per_pixel
@@ -1705,27 +3415,281 @@ void d2d_color_lerp(Color* result
     result->a = (color_a->a + color_b->a) / 2;
 }
 // ================================
-// Renderer Circle functions
+// Clip functions
 // ================================
-int8_t d2d_renderer_circle_init(RendererCircle*    renderer
-                                  ,uint32_t           capacity
-                                  ,D2DContext*    context
-                                  )
+int8_t d2d_clip_push(D2DContext* context
+                    ,Rectangle_f rect
+                    )
 {
-    renderer->context = context;
+    ClipStack *stack = &context->clip_stack;
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    if (stack->depth >= DELO_CLIP_STACK_DEPTH)
     {
+        fprintf(stderr, "Clip stack overflow\n");
         return DELO_ERROR;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glGenVertexArrays(1, &renderer->vao);
-    glBindVertexArray(renderer->vao);
+    if (stack->depth > 0)
+    {
+        Rectangle_f top = stack->rects[stack->depth - 1];
 
-    glGenBuffers(1, &renderer->vbo_vertices);
-    glGenBuffers(1, &renderer->vbo_colors);
-    glGenBuffers(1, &renderer->vbo_positions);
+        float x0 = fmaxf(rect.x, top.x);
+        float y0 = fmaxf(rect.y, top.y);
+        float x1 = fminf(rect.x + rect.width, top.x + top.width);
+        float y1 = fminf(rect.y + rect.height, top.y + top.height);
+
+        rect = (Rectangle_f){x0, y0, fmaxf(x1 - x0, 0), fmaxf(y1 - y0, 0)};
+    }
+
+    stack->rects[stack->depth]   = rect;
+    stack->targets[stack->depth] = stack->target;
+    stack->depth++;
+
+    return DELO_SUCCESS;
+}
+void d2d_clip_pop(D2DContext* context)
+{
+    if (context->clip_stack.depth > 0)
+    {
+        context->clip_stack.depth--;
+    }
+}
+static Vector2f d2d_clip_target(D2DContext* context
+                               ,Vector2f    target
+                               )
+{
+    if (target.x == 0 && target.y == 0)
+    {
+        return (Vector2f){context->back_buffer_width, context->back_buffer_height};
+    }
+
+    return target;
+}
+uint8_t d2d_clip_reject(D2DContext* context
+                       ,Matrix44*   projection
+                       ,Rectangle_f bounds
+                       )
+{
+    ClipStack *stack = &context->clip_stack;
+
+    if (stack->depth == 0)
+    {
+        return 0;
+    }
+
+    Rectangle_f clip   = stack->rects[stack->depth - 1];
+    Vector2f    target = d2d_clip_target(context, stack->targets[stack->depth - 1]);
+
+    // Bounds are in the renderer's space, clip rects are pixels of the target they were pushed for with y pointing down.
+    float hw = bounds.width * 0.5f;
+    float hh = bounds.height * 0.5f;
+    float cx = bounds.x + hw;
+    float cy = bounds.y + hh;
+
+    float px = (cx * projection->x11 + cy * projection->x21 + projection->x41 + 1.0f) * 0.5f * target.x;
+    float py = (1.0f - (cx * projection->x12 + cy * projection->x22 + projection->x42)) * 0.5f * target.y;
+    float ex = (fabsf(projection->x11) * hw + fabsf(projection->x21) * hh) * 0.5f * target.x;
+    float ey = (fabsf(projection->x12) * hw + fabsf(projection->x22) * hh) * 0.5f * target.y;
+
+    return px + ex <= clip.x || px - ex >= clip.x + clip.width ||
+           py + ey <= clip.y || py - ey >= clip.y + clip.height;
+}
+void d2d_clip_reset(ClipBatch* batches
+                   ,uint32_t*  batch_count
+                   )
+{
+    batches[0]   = (ClipBatch){0, {0, 0, 0, 0}, 0, {0, 0}};
+    *batch_count = 1;
+}
+int8_t d2d_clip_batch(D2DContext* context
+                     ,ClipBatch*  batches
+                     ,uint32_t*   batch_count
+                     ,uint32_t    first
+                     )
+{
+    ClipStack *stack = &context->clip_stack;
+    ClipBatch  batch = {first, {0, 0, 0, 0}, stack->depth > 0, {0, 0}};
+
+    if (batch.enabled)
+    {
+        batch.rect   = stack->rects[stack->depth - 1];
+        batch.target = stack->targets[stack->depth - 1];
+    }
+
+    ClipBatch *last = &batches[*batch_count - 1];
+
+    if (last->enabled == batch.enabled && memcmp(&last->rect, &batch.rect, sizeof(Rectangle_f)) == 0 && memcmp(&last->target, &batch.target, sizeof(Vector2f)) == 0)
+    {
+        return DELO_SUCCESS;
+    }
+
+    // Nothing was drawn under the last clip, so it is replaced instead of split.
+    if (last->first == first)
+    {
+        *last = batch;
+
+        ClipBatch *previous = (*batch_count > 1) ? &batches[*batch_count - 2] : NULL;
+
+        if (previous != NULL && previous->enabled == batch.enabled && memcmp(&previous->rect, &batch.rect, sizeof(Rectangle_f)) == 0 && memcmp(&previous->target, &batch.target, sizeof(Vector2f)) == 0)
+        {
+            (*batch_count)--;
+        }
+
+        return DELO_SUCCESS;
+    }
+
+    if (*batch_count >= DELO_CLIP_BATCHES)
+    {
+        return DELO_ERROR;
+    }
+
+    batches[(*batch_count)++] = batch;
+
+    return DELO_SUCCESS;
+}
+static void d2d_clip_scissor(D2DContext* context
+                            ,Rectangle_f rect
+                            ,Vector2f    target
+                            )
+{
+    GLint x0 = (GLint)floorf(rect.x);
+    GLint y0 = (GLint)floorf(rect.y);
+    GLint x1 = (GLint)ceilf(rect.x + rect.width);
+    GLint y1 = (GLint)ceilf(rect.y + rect.height);
+
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0, (GLint)d2d_clip_target(context, target).y - y1, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+void d2d_clip_apply(D2DContext* context
+                   ,ClipBatch*  batch
+                   )
+{
+    ReactiveFrame *reactive = &context->reactive;
+
+    if (!batch->enabled)
+    {
+        d2d_clip_restore(context);
+        return;
+    }
+
+    Rectangle_f rect = batch->rect;
+
+    // Inside a partial redraw the clip rect may never reach outside the damaged region, which is in back buffer pixels.
+    if (reactive->drawing && !reactive->damage_full && batch->target.x == 0 && batch->target.y == 0)
+    {
+        float x0 = fmaxf(rect.x, reactive->damage.x);
+        float y0 = fmaxf(rect.y, reactive->damage.y);
+        float x1 = fminf(rect.x + rect.width, reactive->damage.x + reactive->damage.width);
+        float y1 = fminf(rect.y + rect.height, reactive->damage.y + reactive->damage.height);
+
+        rect = (Rectangle_f){x0, y0, x1 - x0, y1 - y0};
+    }
+
+    d2d_clip_scissor(context, rect, batch->target);
+}
+void d2d_clip_restore(D2DContext* context)
+{
+    ReactiveFrame *reactive = &context->reactive;
+
+    if (reactive->drawing && !reactive->damage_full)
+    {
+        d2d_clip_scissor(context, reactive->damage, (Vector2f){0, 0});
+    }
+    else
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+}
+// ================================
+// Renderer overflow functions
+// ================================
+// GROW reallocates the instance arrays geometrically up to capacity_max and flushes past it, FLUSH draws the batch as soon as it is full.
+void d2d_renderer_overflow(RendererOverflow* overflow
+                          ,uint8_t           mode
+                          ,uint32_t          capacity_max
+                          )
+{
+    overflow->mode         = mode;
+    overflow->capacity_max = capacity_max;
+}
+static void d2d_renderer_overflow_init(RendererOverflow* overflow
+                                      ,uint32_t          capacity
+                                      )
+{
+    overflow->mode         = DELO_RENDERER_GROW;
+    overflow->capacity_max = (capacity > DELO_RENDERER_CAPACITY_MAX) ? capacity : DELO_RENDERER_CAPACITY_MAX;
+    overflow->stats        = (RendererStats){0};
+}
+static void d2d_renderer_overflow_record(D2DContext*       context
+                                        ,RendererOverflow* overflow
+                                        ,RendererStats     delta
+                                        )
+{
+    overflow->stats.grows            += delta.grows;
+    overflow->stats.flushes          += delta.flushes;
+    overflow->stats.dropped          += delta.dropped;
+    context->renderer_stats.grows    += delta.grows;
+    context->renderer_stats.flushes  += delta.flushes;
+    context->renderer_stats.dropped  += delta.dropped;
+}
+// Returns the capacity to grow to, or 0 when the renderer has to flush instead.
+static uint32_t d2d_renderer_overflow_capacity(RendererOverflow* overflow
+                                              ,uint32_t          capacity
+                                              ,uint32_t          needed
+                                              )
+{
+    if (overflow->mode != DELO_RENDERER_GROW || capacity >= overflow->capacity_max)
+    {
+        return 0;
+    }
+
+    uint64_t grown = (capacity < 64) ? 64 : (uint64_t)capacity * 2;
+
+    while (grown < needed)
+    {
+        grown *= 2;
+    }
+
+    return (grown > overflow->capacity_max) ? overflow->capacity_max : (uint32_t)grown;
+}
+static int8_t d2d_renderer_grow_array(void**   array
+                                     ,size_t   size
+                                     ,uint32_t capacity
+                                     )
+{
+    void *grown = realloc(*array, size * capacity);
+
+    if (grown == NULL)
+    {
+        fprintf(stderr, "Error growing renderer to %u instances\n", capacity);
+        return DELO_ERROR;
+    }
+
+    *array = grown;
+    return DELO_SUCCESS;
+}
+// ================================
+// Renderer Circle functions
+// ================================
+int8_t d2d_renderer_circle_init(RendererCircle*    renderer
+                                  ,uint32_t           capacity
+                                  ,D2DContext*    context
+                                  )
+{
+    renderer->context = context;
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        return DELO_ERROR;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &renderer->vao);
+    glBindVertexArray(renderer->vao);
+
+    glGenBuffers(1, &renderer->vbo_vertices);
+    glGenBuffers(1, &renderer->vbo_colors);
+    glGenBuffers(1, &renderer->vbo_positions);
     glGenBuffers(1, &renderer->vbo_radii);
 
 
@@ -1770,6 +3734,10 @@ int8_t d2d_renderer_circle_init(RendererCircle*    renderer
 
     renderer->capacity = capacity;
     renderer->count = 0;
+    renderer->clip_rejected = 0;
+
+    d2d_renderer_overflow_init(&renderer->overflow, capacity);
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
 
     renderer->projection = d2d_matrix44_orthographic_projection((float)0.0f, (float)context->back_buffer_width, (float)0.0f, (float)context->back_buffer_height, (float)1, (float)-1);
     renderer->projection_default = renderer->projection;
@@ -1812,12 +3780,93 @@ int8_t d2d_renderer_circle_render(RendererCircle* renderer
 
     glUniform1f(renderer->uniform_location_u_bbh,(float)renderer->context->back_buffer_height);
 
-    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, renderer->count);
+    for (uint32_t b = 0; b < renderer->clip_batch_count; b++)
+    {
+        ClipBatch *batch = &renderer->clip_batches[b];
+        uint32_t   last  = (b + 1 < renderer->clip_batch_count) ? renderer->clip_batches[b + 1].first : renderer->count;
+
+        if (last <= batch->first)
+        {
+            continue;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Color), (void *)(sizeof(Color) * batch->first));
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_positions);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vector2f), (void *)(sizeof(Vector2f) * batch->first));
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_radii);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *)(sizeof(float) * batch->first));
+
+        d2d_clip_apply(renderer->context, batch);
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, last - batch->first);
+    }
+
+    d2d_clip_restore(renderer->context);
 
     glBindVertexArray(0);
     glUseProgram(0);
     /*------------------Draw instances-----------------*/
 }
+static void d2d_renderer_circle_flush(RendererCircle* renderer)
+{
+    d2d_renderer_circle_update(renderer);
+    d2d_renderer_circle_render(renderer, &renderer->projection, 0);
+
+    renderer->count = 0;
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+    d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, 0);
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 1, 0});
+}
+// A full clip batch array draws the batch so the new clip starts a fresh one.
+static int8_t d2d_renderer_circle_clip(RendererCircle* renderer)
+{
+    if (d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->count) == DELO_SUCCESS)
+    {
+        return DELO_SUCCESS;
+    }
+
+    d2d_renderer_circle_flush(renderer);
+
+    return d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->count);
+}
+static int8_t d2d_renderer_circle_reserve(RendererCircle* renderer
+                                         ,uint32_t        count
+                                         )
+{
+    if (renderer->count + count <= renderer->capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    uint32_t capacity = d2d_renderer_overflow_capacity(&renderer->overflow, renderer->capacity, renderer->count + count);
+
+    if (capacity > 0
+     && d2d_renderer_grow_array((void **)&renderer->colors, sizeof(Color), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->positions, sizeof(Vector2f), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->radii, sizeof(float), capacity) == DELO_SUCCESS)
+    {
+        renderer->capacity = capacity;
+        d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){1, 0, 0});
+
+        if (renderer->count + count <= renderer->capacity)
+        {
+            return DELO_SUCCESS;
+        }
+    }
+
+    if (renderer->count > 0)
+    {
+        d2d_renderer_circle_flush(renderer);
+    }
+
+    if (count <= renderer->capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 0, count});
+    return DELO_ERROR;
+}
 int8_t d2d_renderer_circle_add(RendererCircle* renderer
                                     ,Vector2f        position
                                     ,Color           color
@@ -1827,14 +3876,31 @@ int8_t d2d_renderer_circle_add(RendererCircle* renderer
 
     int32_t index = renderer->count;
 
-    if (index < renderer->capacity)
+    if (d2d_clip_reject(renderer->context, &renderer->projection, (Rectangle_f){position.x - radius, position.y - radius, radius * 2, radius * 2}))
+    {
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
+
+    if (d2d_renderer_circle_reserve(renderer, 1) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    if (d2d_renderer_circle_clip(renderer) == DELO_ERROR)
     {
-        renderer->positions[index].x    = position.x;
-        renderer->positions[index].y    = position.y;
-        renderer->colors[index] = color;
-        renderer->radii[index] = radius;
-        renderer->count++;
+        return DELO_ERROR;
     }
+
+    index = renderer->count;
+
+    renderer->positions[index].x    = position.x;
+    renderer->positions[index].y    = position.y;
+    renderer->colors[index] = color;
+    renderer->radii[index] = radius;
+    renderer->count++;
+
+    return DELO_SUCCESS;
 }
 
 int8_t d2d_renderer_circle_begin(RendererCircle* renderer
@@ -1843,6 +3909,9 @@ int8_t d2d_renderer_circle_begin(RendererCircle* renderer
                                       )
 {
     renderer->count = 0;
+    renderer->clip_rejected = 0;
+    renderer->overflow.stats = (RendererStats){0};
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
     renderer->projection = (projection == NULL) ? renderer->projection : *projection;
     renderer->shader = (shader == NULL) ? renderer->shader : *shader;
 }
@@ -1875,23 +3944,35 @@ int8_t d2d_renderer_primitive_init(RendererPrimitive* renderer
     glBindVertexArray(renderer->vao);
 
     glGenBuffers(1, &renderer->vbo_vertices);
+    glGenBuffers(1, &renderer->ebo);
 
     glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
 
-    renderer->vertices = malloc(sizeof(PrimitiveVertex) * capacity);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(PrimitiveVertex) * capacity, renderer->vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(PrimitiveVertex), (void *)0);
     glEnableVertexAttribArray(0);
 
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(2 * sizeof(float)));
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PrimitiveVertex), (void *)offsetof(PrimitiveVertex, color));
     glEnableVertexAttribArray(1);
 
+    // The element buffer binding is part of the vao state, so it is bound while the vao is.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->ebo);
+
     glBindVertexArray(0);
     glUseProgram(0);
 
-    renderer->capacity = capacity;
-    renderer->count = 0;
+    renderer->vertices       = malloc(sizeof(PrimitiveVertex) * capacity);
+    renderer->indices        = malloc(sizeof(uint32_t) * capacity * 2);
+    renderer->capacity       = capacity;
+    renderer->index_capacity = capacity * 2;
+    renderer->count          = 0;
+    renderer->index_count    = 0;
+    renderer->clip_rejected  = 0;
+    renderer->type           = DELO_TRIANGLE_LIST;
+    renderer->runs[0]        = (PrimitiveRun){0, DELO_TRIANGLE_LIST};
+    renderer->run_count      = 1;
+
+    d2d_renderer_overflow_init(&renderer->overflow, capacity);
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
 
     renderer->projection = d2d_matrix44_orthographic_projection((float)0.0f
                                                                ,(float)context->back_buffer_width
@@ -1901,6 +3982,8 @@ int8_t d2d_renderer_primitive_init(RendererPrimitive* renderer
                                                                ,(float)-1
                                                                );
     renderer->projection_default = renderer->projection;
+
+    return DELO_SUCCESS;
 }
 int8_t d2d_renderer_primitive_apply_shader(RendererPrimitive* renderer
                                           ,uint32_t           shader
@@ -1915,8 +3998,17 @@ int8_t d2d_renderer_primitive_apply_shader(RendererPrimitive* renderer
 }
 int8_t d2d_renderer_primitive_update(RendererPrimitive* renderer)
 {
+    glBindVertexArray(renderer->vao);
+
     glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(RendererPrimitive) * renderer->count, (float *)renderer->vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(PrimitiveVertex) * renderer->count, renderer->vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * renderer->index_count, renderer->indices, GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+
+    return DELO_SUCCESS;
 }
 int8_t d2d_renderer_primitive_render(RendererPrimitive* renderer
                                     ,Matrix44*          projection
@@ -1930,113 +4022,334 @@ int8_t d2d_renderer_primitive_render(RendererPrimitive* renderer
     glUseProgram(renderer->shader);
     glUniformMatrix4fv(renderer->uniform_location_u_mvp, 1, GL_FALSE, &projection->x11);
 
-    switch (renderer->type)
+    uint32_t b     = 0;
+    uint32_t r     = 0;
+    uint32_t first = 0;
+
+    // Clip batches and type runs both split the index stream, one draw per piece between their boundaries.
+    while (first < renderer->index_count)
     {
-    case DELO_TRIANGLE_LIST:
-        glDrawArrays(GL_TRIANGLES, 0, renderer->count);
-        break;
-    case DELO_LINE_LIST:
-        glDrawArrays(GL_LINES, 0, renderer->count);
-        break;
+        while (b + 1 < renderer->clip_batch_count && renderer->clip_batches[b + 1].first <= first)
+        {
+            b++;
+        }
+
+        while (r + 1 < renderer->run_count && renderer->runs[r + 1].first <= first)
+        {
+            r++;
+        }
+
+        uint32_t last = renderer->index_count;
+
+        if (b + 1 < renderer->clip_batch_count && renderer->clip_batches[b + 1].first < last)
+        {
+            last = renderer->clip_batches[b + 1].first;
+        }
+
+        if (r + 1 < renderer->run_count && renderer->runs[r + 1].first < last)
+        {
+            last = renderer->runs[r + 1].first;
+        }
+
+        d2d_clip_apply(renderer->context, &renderer->clip_batches[b]);
+
+        switch (renderer->runs[r].type)
+        {
+        case DELO_TRIANGLE_LIST:
+            glDrawElements(GL_TRIANGLES, last - first, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * first));
+            break;
+        case DELO_LINE_LIST:
+            glDrawElements(GL_LINES, last - first, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * first));
+            break;
+        }
+
+        first = last;
     }
 
+    d2d_clip_restore(renderer->context);
+
     glBindVertexArray(0);
     glUseProgram(0);
     /*------------------Draw instances-----------------*/
 }
-int8_t d2d_renderer_primitive_add(RendererPrimitive* renderer
-                                 ,Vector2f           position
-                                 ,Color              color
-                                 )
+static uint32_t d2d_color_pack(Color color)
 {
+    uint32_t r = (uint32_t)(fminf(fmaxf(color.r, 0.0f), 1.0f) * 255.0f + 0.5f);
+    uint32_t g = (uint32_t)(fminf(fmaxf(color.g, 0.0f), 1.0f) * 255.0f + 0.5f);
+    uint32_t b = (uint32_t)(fminf(fmaxf(color.b, 0.0f), 1.0f) * 255.0f + 0.5f);
+    uint32_t a = (uint32_t)(fminf(fmaxf(color.a, 0.0f), 1.0f) * 255.0f + 0.5f);
 
-    int32_t index = renderer->count;
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+static void d2d_renderer_primitive_flush(RendererPrimitive* renderer)
+{
+    PrimitiveRun *run    = &renderer->runs[renderer->run_count - 1];
+    uint8_t       type   = run->type;
+    uint32_t      stride = (type == DELO_LINE_LIST) ? 2 : 3;
+    uint32_t      keep   = (renderer->index_count - run->first) % stride;
+    uint32_t      count  = renderer->index_count - keep;
 
-    if (index < renderer->capacity)
+    if (count == 0)
     {
-        renderer->vertices[index].position = position;
-        renderer->vertices[index].color = color;
-        renderer->count++;
+        return;
     }
-}
-int8_t d2d_renderer_primitive_add_line(RendererPrimitive* renderer
-                                      ,Vector2f           position_a
-                                      ,Vector2f           position_b
-                                      ,Color              color
-                                      )
-{
 
-    int32_t index = renderer->count;
+    renderer->index_count = count;
+    d2d_renderer_primitive_update(renderer);
+    d2d_renderer_primitive_render(renderer, &renderer->projection, 0);
 
-    if (index +2 < renderer->capacity)
-    {
-        renderer->vertices[index].position = position_a;
-        renderer->vertices[index].color    = color;
+    // Only d2d_renderer_primitive_add leaves a primitive partly added, its vertices are the newest and are carried over.
+    memmove(renderer->vertices, &renderer->vertices[renderer->count - keep], sizeof(PrimitiveVertex) * keep);
 
-        renderer->vertices[index+1].position = position_b;
-        renderer->vertices[index+1].color    = color;
-        renderer->count+=2;
+    for (uint32_t i = 0; i < keep; i++)
+    {
+        renderer->indices[i] = i;
     }
+
+    renderer->count       = keep;
+    renderer->index_count = keep;
+    renderer->runs[0]     = (PrimitiveRun){0, type};
+    renderer->run_count   = 1;
+
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+    d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, 0);
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 1, 0});
 }
-int8_t d2d_renderer_primitive_add_rectangle(RendererPrimitive* renderer
-                                           ,Rectangle_f        rectangle
-                                           ,Color              color
-                                           )
+static int8_t d2d_renderer_primitive_clip(RendererPrimitive* renderer)
 {
+    if (d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->index_count) == DELO_SUCCESS)
+    {
+        return DELO_SUCCESS;
+    }
 
-    int32_t index = renderer->count;
+    d2d_renderer_primitive_flush(renderer);
 
-    if (index + 6 <= renderer->capacity)
+    return d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->index_count);
+}
+// Every add uses at most two indices per vertex, so the index arrays are kept at twice the vertex capacity.
+static int8_t d2d_renderer_primitive_reserve(RendererPrimitive* renderer
+                                            ,uint32_t           count
+                                            ,uint32_t           index_count
+                                            )
+{
+    if (renderer->count + count <= renderer->capacity && renderer->index_count + index_count <= renderer->index_capacity)
     {
-        renderer->vertices[index + 0].position = (Vector2f){rectangle.x, rectangle.y};
-        renderer->vertices[index + 1].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y};
-        renderer->vertices[index + 2].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y + rectangle.height};
-        renderer->vertices[index + 3].position = (Vector2f){rectangle.x, rectangle.y};
-        renderer->vertices[index + 4].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y + rectangle.height};
-        renderer->vertices[index + 5].position = (Vector2f){rectangle.x, rectangle.y + rectangle.height};
+        return DELO_SUCCESS;
+    }
 
-        renderer->vertices[index + 0].color = color;
-        renderer->vertices[index + 1].color = color;
-        renderer->vertices[index + 2].color = color;
-        renderer->vertices[index + 3].color = color;
-        renderer->vertices[index + 4].color = color;
-        renderer->vertices[index + 5].color = color;
+    // Indices get twice the vertex capacity, so index heavy geometry like path strips sizes the growth by them.
+    uint32_t needed   = renderer->count + count;
+    uint32_t needed_i = (renderer->index_count + index_count + 1) / 2;
+    uint32_t capacity = d2d_renderer_overflow_capacity(&renderer->overflow, renderer->capacity, (needed > needed_i) ? needed : needed_i);
 
-        renderer->count += 6;
-    }
+    if (capacity > 0
+     && d2d_renderer_grow_array((void **)&renderer->vertices, sizeof(PrimitiveVertex), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->indices, sizeof(uint32_t), capacity * 2) == DELO_SUCCESS)
+    {
+        renderer->capacity       = capacity;
+        renderer->index_capacity = capacity * 2;
+        d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){1, 0, 0});
+
+        if (renderer->count + count <= renderer->capacity && renderer->index_count + index_count <= renderer->index_capacity)
+        {
+            return DELO_SUCCESS;
+        }
+    }
+
+    d2d_renderer_primitive_flush(renderer);
+
+    if (renderer->count + count <= renderer->capacity && renderer->index_count + index_count <= renderer->index_capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 0, count});
+    return DELO_ERROR;
+}
+// Lines and triangles share one batch, a change of type starts a new run at the current index.
+static int8_t d2d_renderer_primitive_run(RendererPrimitive* renderer
+                                        ,uint8_t            type
+                                        )
+{
+    PrimitiveRun *run = &renderer->runs[renderer->run_count - 1];
+
+    if (run->type == type)
+    {
+        return DELO_SUCCESS;
+    }
+
+    if (run->first == renderer->index_count)
+    {
+        run->type = type;
+
+        if (renderer->run_count > 1 && renderer->runs[renderer->run_count - 2].type == type)
+        {
+            renderer->run_count--;
+        }
+
+        return DELO_SUCCESS;
+    }
+
+    if (renderer->run_count >= DELO_PRIMITIVE_RUNS)
+    {
+        d2d_renderer_primitive_flush(renderer);
+        return d2d_renderer_primitive_run(renderer, type);
+    }
+
+    renderer->runs[renderer->run_count++] = (PrimitiveRun){renderer->index_count, type};
+
+    return DELO_SUCCESS;
+}
+static int8_t d2d_renderer_primitive_open(RendererPrimitive* renderer
+                                         ,uint8_t            type
+                                         ,uint32_t           count
+                                         ,uint32_t           index_count
+                                         )
+{
+    if (d2d_renderer_primitive_reserve(renderer, count, index_count) == DELO_ERROR
+     || d2d_renderer_primitive_run(renderer, type) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    return d2d_renderer_primitive_clip(renderer);
+}
+int8_t d2d_renderer_primitive_add(RendererPrimitive* renderer
+                                 ,Vector2f           position
+                                 ,Color              color
+                                 )
+{
+    if (d2d_renderer_primitive_open(renderer, renderer->type, 1, 1) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    uint32_t index = renderer->count;
+
+    renderer->vertices[index].position = position;
+    renderer->vertices[index].color    = d2d_color_pack(color);
+
+    renderer->indices[renderer->index_count++] = index;
+    renderer->count++;
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_renderer_primitive_add_line(RendererPrimitive* renderer
+                                      ,Vector2f           position_a
+                                      ,Vector2f           position_b
+                                      ,Color              color
+                                      )
+{
+    Rectangle_f bounds =
+    {
+        fminf(position_a.x, position_b.x),
+        fminf(position_a.y, position_b.y),
+        fabsf(position_a.x - position_b.x),
+        fabsf(position_a.y - position_b.y)
+    };
+
+    if (d2d_clip_reject(renderer->context, &renderer->projection, bounds))
+    {
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
+
+    if (d2d_renderer_primitive_open(renderer, DELO_LINE_LIST, 2, 2) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    uint32_t  index   = renderer->count;
+    uint32_t  packed  = d2d_color_pack(color);
+    uint32_t *indices = &renderer->indices[renderer->index_count];
+
+    renderer->vertices[index + 0] = (PrimitiveVertex){position_a, packed};
+    renderer->vertices[index + 1] = (PrimitiveVertex){position_b, packed};
+
+    indices[0] = index;
+    indices[1] = index + 1;
+
+    renderer->count       += 2;
+    renderer->index_count += 2;
+
+    return DELO_SUCCESS;
+}
+static void d2d_renderer_primitive_quad(RendererPrimitive* renderer
+                                       ,Rectangle_f        rectangle
+                                       ,uint32_t           packed
+                                       )
+{
+    uint32_t index = renderer->count;
+
+    renderer->vertices[index + 0] = (PrimitiveVertex){{rectangle.x, rectangle.y}, packed};
+    renderer->vertices[index + 1] = (PrimitiveVertex){{rectangle.x + rectangle.width, rectangle.y}, packed};
+    renderer->vertices[index + 2] = (PrimitiveVertex){{rectangle.x + rectangle.width, rectangle.y + rectangle.height}, packed};
+    renderer->vertices[index + 3] = (PrimitiveVertex){{rectangle.x, rectangle.y + rectangle.height}, packed};
+
+    renderer->count += 4;
+}
+int8_t d2d_renderer_primitive_add_rectangle(RendererPrimitive* renderer
+                                           ,Rectangle_f        rectangle
+                                           ,Color              color
+                                           )
+{
+    if (d2d_clip_reject(renderer->context, &renderer->projection, rectangle))
+    {
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
+
+    if (d2d_renderer_primitive_open(renderer, DELO_TRIANGLE_LIST, 4, 6) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    uint32_t  index   = renderer->count;
+    uint32_t *indices = &renderer->indices[renderer->index_count];
+
+    d2d_renderer_primitive_quad(renderer, rectangle, d2d_color_pack(color));
+
+    indices[0] = index;
+    indices[1] = index + 1;
+    indices[2] = index + 2;
+    indices[3] = index;
+    indices[4] = index + 2;
+    indices[5] = index + 3;
+
+    renderer->index_count += 6;
+
+    return DELO_SUCCESS;
 }
 int8_t d2d_renderer_primitive_add_rectangle_outline(RendererPrimitive* renderer
                                                    ,Rectangle_f        rectangle
                                                    ,Color              color
                                                    )
 {
-    int32_t index = renderer->count;
+    if (d2d_clip_reject(renderer->context, &renderer->projection, rectangle))
+    {
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
 
-    if (index + 8 <= renderer->capacity)
+    if (d2d_renderer_primitive_open(renderer, DELO_LINE_LIST, 4, 8) == DELO_ERROR)
     {
-        renderer->vertices[index + 0].position = (Vector2f){rectangle.x, rectangle.y};
-        renderer->vertices[index + 1].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y};
+        return DELO_ERROR;
+    }
 
-        renderer->vertices[index + 2].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y};
-        renderer->vertices[index + 3].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y + rectangle.height};
+    uint32_t  index   = renderer->count;
+    uint32_t *indices = &renderer->indices[renderer->index_count];
 
-        renderer->vertices[index + 4].position = (Vector2f){rectangle.x + rectangle.width, rectangle.y + rectangle.height};
-        renderer->vertices[index + 5].position = (Vector2f){rectangle.x, rectangle.y + rectangle.height};
+    d2d_renderer_primitive_quad(renderer, rectangle, d2d_color_pack(color));
 
-        renderer->vertices[index + 6].position = (Vector2f){rectangle.x, rectangle.y + rectangle.height};
-        renderer->vertices[index + 7].position = (Vector2f){rectangle.x, rectangle.y};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        indices[i * 2 + 0] = index + i;
+        indices[i * 2 + 1] = index + (i + 1) % 4;
+    }
 
-        renderer->vertices[index + 0].color = color;
-        renderer->vertices[index + 1].color = color;
-        renderer->vertices[index + 2].color = color;
-        renderer->vertices[index + 3].color = color;
-        renderer->vertices[index + 4].color = color;
-        renderer->vertices[index + 5].color = color;
-        renderer->vertices[index + 6].color = color;
-        renderer->vertices[index + 7].color = color;
+    renderer->index_count += 8;
 
-        renderer->count += 8;
-    }
+    return DELO_SUCCESS;
 }
 int8_t d2d_renderer_primitive_begin(RendererPrimitive* renderer
                                    ,Matrix44*          projection
@@ -2045,9 +4358,15 @@ int8_t d2d_renderer_primitive_begin(RendererPrimitive* renderer
                                    )
 {
     renderer->count = 0;
+    renderer->index_count = 0;
+    renderer->clip_rejected = 0;
+    renderer->overflow.stats = (RendererStats){0};
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
     renderer->projection = (projection == NULL) ? renderer->projection : *projection;
     renderer->shader = (shader == NULL) ? renderer->shader : *shader;
     renderer->type = type;
+    renderer->runs[0] = (PrimitiveRun){0, type};
+    renderer->run_count = 1;
 }
 int8_t d2d_renderer_primitive_end(RendererPrimitive* renderer)
 {
@@ -2057,409 +4376,1004 @@ int8_t d2d_renderer_primitive_end(RendererPrimitive* renderer)
     renderer->projection = renderer->projection_default;
 }
 // ================================
-// Renderer Sprite functions
+// Path functions
 // ================================
-int8_t d2d_renderer_sprite_init(RendererSprite* renderer
-                               ,uint32_t        capacity
-                               ,D2DContext*     context
-                               )
+int8_t d2d_path_init(Path* path)
 {
+    *path           = (Path){0};
+    path->tolerance = DELO_PATH_TOLERANCE;
 
-    renderer->context = context;
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    return DELO_SUCCESS;
+}
+void d2d_path_free(Path* path)
+{
+    free(path->points);
+    free(path->contours);
+    free(path->sections);
+    *path = (Path){0};
+}
+void d2d_path_clear(Path* path)
+{
+    path->point_count   = 0;
+    path->contour_count = 0;
+    path->section_count = 0;
+    path->cached        = 0;
+}
+static int8_t d2d_path_grow(void**    array
+                           ,uint32_t* capacity
+                           ,uint32_t  needed
+                           ,size_t    size
+                           )
+{
+    if (needed <= *capacity)
     {
-        return DELO_ERROR;
+        return DELO_SUCCESS;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glGenVertexArrays(1, &renderer->vao);
-    glBindVertexArray(renderer->vao);
+    uint32_t grown = (*capacity < 64) ? 64 : *capacity;
 
-    GLfloat vertices[] =
+    while (grown < needed)
     {
-        //positions         //texCoords
-        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, // bottom-left
-         1.0f, -1.0f, 0.0f, 1.0f, 0.0f, // bottom-right
-         1.0f,  1.0f, 0.0f, 1.0f, 1.0f, // top-right
-        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f  // top-left
-    };
+        grown *= 2;
+    }
 
-    glGenBuffers(1, &renderer->vbo_vertices);
-    glGenBuffers(1, &renderer->vbo_colors);
-    glGenBuffers(1, &renderer->vbo_transforms);
-    glGenBuffers(1, &renderer->vbo_offsets);
-    glGenBuffers(1, &renderer->vbo_src_rects);
-    glGenBuffers(1, &renderer->vbo_tex_indices);
-    glGenBuffers(1, &renderer->vbo_limit_y);
+    void *array_grown = realloc(*array, size * grown);
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    if (array_grown == NULL)
+    {
+        fprintf(stderr, "Error growing path to %u elements\n", grown);
+        return DELO_ERROR;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(2);
-    glVertexAttribDivisor(2, 1);
+    *array    = array_grown;
+    *capacity = grown;
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_offsets);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(3);
-    glVertexAttribDivisor(3, 1);
+    return DELO_SUCCESS;
+}
+int8_t d2d_path_move_to(Path*    path
+                       ,Vector2f point
+                       )
+{
+    if (d2d_path_grow((void **)&path->contours, &path->contour_capacity, path->contour_count + 1, sizeof(PathContour)) == DELO_ERROR
+     || d2d_path_grow((void **)&path->points, &path->point_capacity, path->point_count + 1, sizeof(Vector2f)) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_src_rects);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(4);
-    glVertexAttribDivisor(4, 1);
+    // A contour that never got a second point is replaced instead of kept.
+    if (path->contour_count > 0 && path->contours[path->contour_count - 1].count < 2)
+    {
+        path->point_count = path->contours[--path->contour_count].first;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_transforms);
-    for (int32_t i = 0; i < 4; i++)
+    path->contours[path->contour_count++] = (PathContour){path->point_count, 1, 0, 0, 0};
+    path->points[path->point_count++]     = point;
+    path->cached                          = 0;
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_path_line_to(Path*    path
+                       ,Vector2f point
+                       )
+{
+    if (path->contour_count == 0 || path->contours[path->contour_count - 1].closed)
     {
-        glEnableVertexAttribArray(5 + i);
-        glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 4 * 4, (void *)(sizeof(float) * 4 * i));
-        glVertexAttribDivisor(5 + i, 1);
+        Vector2f start = (path->contour_count == 0) ? point : path->points[path->contours[path->contour_count - 1].first];
+
+        if (d2d_path_move_to(path, start) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_tex_indices);
-    glVertexAttribPointer(9, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *)0);
-    glEnableVertexAttribArray(9);
-    glVertexAttribDivisor(9, 1);
+    Vector2f last = path->points[path->point_count - 1];
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_limit_y);
-    glVertexAttribPointer(10, 2, GL_FLOAT, GL_FALSE,  2 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(10);
-    glVertexAttribDivisor(10, 1);
+    if (fabsf(point.x - last.x) < 1e-6f && fabsf(point.y - last.y) < 1e-6f)
+    {
+        return DELO_SUCCESS;
+    }
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+    if (d2d_path_grow((void **)&path->points, &path->point_capacity, path->point_count + 1, sizeof(Vector2f)) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
 
-    renderer->capacity = capacity;
-    renderer->count    = 0;
+    path->points[path->point_count++] = point;
+    path->contours[path->contour_count - 1].count++;
+    path->cached = 0;
 
-    renderer->colors          = malloc(sizeof(Color)       * capacity);
-    renderer->transforms      = malloc(sizeof(Matrix44)    * capacity);
-    renderer->offsets         = malloc(sizeof(Vector2f)    * capacity);
-    renderer->src_rects       = malloc(sizeof(Rectangle_f) * capacity);
-    renderer->texture_indices = malloc(sizeof(float)       * capacity);
-    renderer->limit_ys        = malloc(sizeof(Vector2f)    * capacity);
+    return DELO_SUCCESS;
+}
+static Vector2f d2d_path_current(Path* path)
+{
+    return (path->point_count > 0) ? path->points[path->point_count - 1] : (Vector2f){0, 0};
+}
+// Segment counts come from the curve's second difference, which bounds how far a chord strays from it.
+int8_t d2d_path_quad_to(Path*    path
+                       ,Vector2f control
+                       ,Vector2f point
+                       )
+{
+    Vector2f p0       = d2d_path_current(path);
+    float    dx       = p0.x - 2 * control.x + point.x;
+    float    dy       = p0.y - 2 * control.y + point.y;
+    uint32_t segments = (uint32_t)ceilf(sqrtf(sqrtf(dx * dx + dy * dy) / (4 * path->tolerance)));
 
-    renderer->change_mask = 0b11111111;
+    segments = (segments < 1) ? 1 : (segments > DELO_PATH_CURVE_SEGMENTS) ? DELO_PATH_CURVE_SEGMENTS : segments;
 
-    renderer->texture = NULL;
+    for (uint32_t i = 1; i <= segments; i++)
+    {
+        float t = (float)i / segments;
+        float u = 1 - t;
 
-    renderer->projection = d2d_matrix44_orthographic_projection((float)0.0f
-                                                               ,(float)context->back_buffer_width
-                                                               ,(float)0.0f
-                                                               ,(float)context->back_buffer_height
-                                                               ,(float)1
-                                                               ,(float)-1
-                                                               );
+        Vector2f p =
+        {
+            u * u * p0.x + 2 * u * t * control.x + t * t * point.x,
+            u * u * p0.y + 2 * u * t * control.y + t * t * point.y
+        };
 
-    renderer->texture_id_0 = -1;
-    renderer->texture_id_1 = -1;
-    renderer->texture_id_2 = -1;
-    renderer->texture_id_3 = -1;
+        if (d2d_path_line_to(path, p) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
+    }
 
-    renderer->flip = 0;
+    return DELO_SUCCESS;
 }
-int8_t d2d_renderer_sprite_apply_shader(RendererSprite* renderer
-                                       ,uint32_t        shader
-                                       )
+int8_t d2d_path_cubic_to(Path*    path
+                        ,Vector2f control_a
+                        ,Vector2f control_b
+                        ,Vector2f point
+                        )
 {
-    renderer->shader = shader;
+    Vector2f p0       = d2d_path_current(path);
+    float    ax       = p0.x - 2 * control_a.x + control_b.x;
+    float    ay       = p0.y - 2 * control_a.y + control_b.y;
+    float    bx       = control_a.x - 2 * control_b.x + point.x;
+    float    by       = control_a.y - 2 * control_b.y + point.y;
+    float    dd       = fmaxf(sqrtf(ax * ax + ay * ay), sqrtf(bx * bx + by * by));
+    uint32_t segments = (uint32_t)ceilf(sqrtf(3 * dd / (4 * path->tolerance)));
 
-    glUseProgram(shader);
-    renderer->uniform_location_u_texture0 = glGetUniformLocation(shader, "u_texture0");
-    renderer->uniform_location_u_texture1 = glGetUniformLocation(shader, "u_texture1");
-    renderer->uniform_location_u_texture2 = glGetUniformLocation(shader, "u_texture2");
-    renderer->uniform_location_u_texture3 = glGetUniformLocation(shader, "u_texture3");
-    renderer->uniform_location_u_mvp      = glGetUniformLocation(shader, "u_mvp");
-    renderer->uniform_location_u_flip     = glGetUniformLocation(shader, "u_flip");
+    segments = (segments < 1) ? 1 : (segments > DELO_PATH_CURVE_SEGMENTS) ? DELO_PATH_CURVE_SEGMENTS : segments;
 
-    glUniform1i(renderer->uniform_location_u_flip, 0);
-    glUseProgram(0);
-}
-int8_t d2d_renderer_sprite_update(RendererSprite* renderer)
-{
-    if ((renderer->change_mask >> 0) & 1)
+    for (uint32_t i = 1; i <= segments; i++)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Color) * renderer->count, (float *)renderer->colors, GL_STATIC_DRAW);
-        renderer->change_mask &= ~(0 << 0);
-    }
+        float t = (float)i / segments;
+        float u = 1 - t;
 
-    if ((renderer->change_mask >> 1) & 1)
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_transforms);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix44) * renderer->count, (float *)renderer->transforms, GL_STATIC_DRAW);
-        renderer->change_mask &= ~(1 << 0);
+        Vector2f p =
+        {
+            u * u * u * p0.x + 3 * u * u * t * control_a.x + 3 * u * t * t * control_b.x + t * t * t * point.x,
+            u * u * u * p0.y + 3 * u * u * t * control_a.y + 3 * u * t * t * control_b.y + t * t * t * point.y
+        };
+
+        if (d2d_path_line_to(path, p) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
     }
 
-    if ((renderer->change_mask >> 2) & 1)
+    return DELO_SUCCESS;
+}
+static uint32_t d2d_path_arc_segments(float radius
+                                     ,float angle
+                                     ,float tolerance
+                                     )
+{
+    float    step     = (radius > tolerance) ? 2 * acosf(1 - tolerance / radius) : DELO_PI * 0.5f;
+    uint32_t segments = (uint32_t)ceilf(fabsf(angle) / step);
+
+    return (segments < 1) ? 1 : (segments > DELO_PATH_CURVE_SEGMENTS) ? DELO_PATH_CURVE_SEGMENTS : segments;
+}
+// Angles in radians; joins the current point to the arc start with a line, or starts a contour there.
+int8_t d2d_path_arc(Path*    path
+                   ,Vector2f center
+                   ,float    radius
+                   ,float    angle_start
+                   ,float    angle_end
+                   )
+{
+    uint32_t segments = d2d_path_arc_segments(radius, angle_end - angle_start, path->tolerance);
+
+    for (uint32_t i = 0; i <= segments; i++)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_offsets);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vector2f) * renderer->count, (float *)renderer->offsets, GL_STATIC_DRAW);
-        renderer->change_mask &= ~(2 << 0);
+        float    angle = angle_start + (angle_end - angle_start) * i / segments;
+        Vector2f p     = {center.x + cosf(angle) * radius, center.y + sinf(angle) * radius};
+        int8_t   error = (i == 0 && path->contour_count == 0) ? d2d_path_move_to(path, p) : d2d_path_line_to(path, p);
+
+        if (error == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
     }
 
-    if ((renderer->change_mask >> 3) & 1)
+    return DELO_SUCCESS;
+}
+void d2d_path_close(Path* path)
+{
+    if (path->contour_count == 0)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_src_rects);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Rectangle_f) * renderer->count, (float *)renderer->src_rects, GL_STATIC_DRAW);
-        renderer->change_mask &= ~(3 << 0);
+        return;
     }
-    if ((renderer->change_mask >> 4) & 1)
+
+    PathContour *contour = &path->contours[path->contour_count - 1];
+    Vector2f     first   = path->points[contour->first];
+    Vector2f     last    = path->points[path->point_count - 1];
+
+    // The closing segment is implied, a repeated first point would make a zero length segment.
+    if (contour->count > 2 && fabsf(first.x - last.x) < 1e-6f && fabsf(first.y - last.y) < 1e-6f)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_tex_indices);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * renderer->count, (float *)renderer->texture_indices, GL_STATIC_DRAW);
-        renderer->change_mask &= ~(4 << 0);
+        contour->count--;
+        path->point_count--;
     }
 
-    if ((renderer->change_mask >> 5) & 1)
+    contour->closed = 1;
+    path->cached    = 0;
+}
+static int8_t d2d_path_section(Path*    path
+                              ,Vector2f center
+                              ,Vector2f normal
+                              ,float    width
+                              ,float    alpha
+                              )
+{
+    if (d2d_path_grow((void **)&path->sections, &path->section_capacity, path->section_count + 1, sizeof(PathSection)) == DELO_ERROR)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_limit_y);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vector2f) * renderer->count, (Vector2f *)renderer->limit_ys, GL_STATIC_DRAW);
-        renderer->change_mask &= ~(5 << 0);
+        return DELO_ERROR;
     }
+
+    path->sections[path->section_count++] = (PathSection){center, normal, width, alpha};
+
+    float reach = sqrtf(normal.x * normal.x + normal.y * normal.y) * (width + path->style.fringe);
+
+    path->bounds_min.x = fminf(path->bounds_min.x, center.x - reach);
+    path->bounds_min.y = fminf(path->bounds_min.y, center.y - reach);
+    path->bounds_max.x = fmaxf(path->bounds_max.x, center.x + reach);
+    path->bounds_max.y = fmaxf(path->bounds_max.y, center.y + reach);
+
+    return DELO_SUCCESS;
 }
-int8_t d2d_renderer_sprite_render(RendererSprite* renderer)
+// Caps are built from sections too: the outermost one has zero alpha so the end fades over the fringe.
+static int8_t d2d_path_cap(Path*    path
+                          ,Vector2f point
+                          ,Vector2f direction
+                          ,float    width
+                          ,float    alpha
+                          ,uint8_t  start
+                          )
 {
-    /*------------------Draw instances-----------------*/
-    glBindVertexArray(renderer->vao);
+    PathStyle *style  = &path->style;
+    float      sign   = start ? -1.0f : 1.0f;
+    Vector2f   normal = {-direction.y, direction.x};
+    Vector2f   d      = {direction.x * sign, direction.y * sign};
+    int8_t     error  = DELO_SUCCESS;
 
-    glUseProgram(renderer->shader);
-    if (renderer->texture_id_0 != -1)
+    if (style->cap == DELO_CAP_ROUND)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_0);
-        glUniform1i(renderer->uniform_location_u_texture0, 0);
-    }
+        uint32_t steps = d2d_path_arc_segments(width, DELO_PI * 0.5f, path->tolerance);
+        Vector2f tip   = {point.x + d.x * (width + style->fringe), point.y + d.y * (width + style->fringe)};
 
-    if (renderer->texture_id_1 != -1)
-    {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_1);
-        glUniform1i(renderer->uniform_location_u_texture1, 1);
-    }
+        if (start)
+        {
+            error |= d2d_path_section(path, tip, normal, 0, 0);
+        }
 
-    if (renderer->texture_id_2 != -1)
-    {
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_2);
-        glUniform1i(renderer->uniform_location_u_texture2, 2);
-    }
+        for (uint32_t i = 0; i < steps; i++)
+        {
+            uint32_t k     = start ? i : steps - 1 - i;
+            float    angle = DELO_PI * 0.5f * (steps - k) / steps;
+            Vector2f c     = {point.x + d.x * width * sinf(angle), point.y + d.y * width * sinf(angle)};
 
-    if (renderer->texture_id_3 != -1)
-    {
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_3);
-        glUniform1i(renderer->uniform_location_u_texture3, 3);
-    }
+            error |= d2d_path_section(path, c, normal, width * cosf(angle), alpha);
+        }
 
-    Matrix44 *projection = &renderer->projection;
-    glUniformMatrix4fv(renderer->uniform_location_u_mvp, 1, GL_FALSE, &projection->x11);
+        error |= d2d_path_section(path, point, normal, width, alpha);
 
-    glUniform1i(renderer->uniform_location_u_flip, renderer->flip);
+        if (!start)
+        {
+            error |= d2d_path_section(path, tip, normal, 0, 0);
+        }
 
-    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, renderer->count);
+        return error ? DELO_ERROR : DELO_SUCCESS;
+    }
 
-    if (renderer->texture_id_3 != -1)
+    Vector2f end  = point;
+
+    if (style->cap == DELO_CAP_SQUARE)
     {
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        end.x += d.x * width;
+        end.y += d.y * width;
     }
 
-    if (renderer->texture_id_2 != -1)
+    Vector2f fade = {end.x + d.x * style->fringe, end.y + d.y * style->fringe};
+
+    if (start)
     {
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        error |= d2d_path_section(path, fade, normal, width, 0);
+        error |= d2d_path_section(path, end, normal, width, alpha);
     }
 
-    if (renderer->texture_id_1 != -1)
+    if (style->cap == DELO_CAP_SQUARE || !start)
     {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        error |= d2d_path_section(path, point, normal, width, alpha);
     }
 
-    if (renderer->texture_id_0 != -1)
+    if (!start)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        if (style->cap == DELO_CAP_SQUARE)
+        {
+            error |= d2d_path_section(path, end, normal, width, alpha);
+        }
+
+        error |= d2d_path_section(path, fade, normal, width, 0);
     }
 
-    glBindVertexArray(0);
-    glUseProgram(0);
-    /*------------------Draw instances-----------------*/
+    return error ? DELO_ERROR : DELO_SUCCESS;
 }
-int8_t d2d_renderer_sprite_add_texture(RendererSprite* renderer
-                                      ,int32_t         texture_id
-                                      )
+static int8_t d2d_path_join(Path*    path
+                           ,Vector2f point
+                           ,Vector2f direction_a
+                           ,Vector2f direction_b
+                           ,float    width
+                           ,float    alpha
+                           )
 {
-    if (renderer->texture_id_0 == -1 || renderer->texture_id_0 == texture_id)
-    {
-        renderer->texture_id_0 = texture_id;
-        return 0;
-    }
-    else if (renderer->texture_id_1 == -1 || renderer->texture_id_1 == texture_id)
-    {
-        renderer->texture_id_1 = texture_id;
-        return 1;
-    }
-    else if (renderer->texture_id_2 == -1 || renderer->texture_id_2 == texture_id)
-    {
-        renderer->texture_id_2 = texture_id;
-        return 2;
-    }
-    else if (renderer->texture_id_3 == -1 || renderer->texture_id_3 == texture_id)
+    PathStyle *style    = &path->style;
+    Vector2f   normal_a = {-direction_a.y, direction_a.x};
+    Vector2f   normal_b = {-direction_b.y, direction_b.x};
+    float      dot      = direction_a.x * direction_b.x + direction_a.y * direction_b.y;
+
+    if (dot > 0.9999f)
     {
-        renderer->texture_id_3 = texture_id;
-        return 3;
+        return d2d_path_section(path, point, normal_b, width, alpha);
     }
-    else
+
+    Vector2f miter    = {(normal_a.x + normal_b.x) * 0.5f, (normal_a.y + normal_b.y) * 0.5f};
+    float    miter_d2 = miter.x * miter.x + miter.y * miter.y;
+
+    // The miter normal has length 1/cos(theta/2), so it reaches the corner of both offset edges at once.
+    if (style->join == DELO_JOIN_MITER && miter_d2 > 1e-6f && 1.0f / sqrtf(miter_d2) <= style->miter_limit)
     {
-        return -1;
+        return d2d_path_section(path, point, (Vector2f){miter.x / miter_d2, miter.y / miter_d2}, width, alpha);
     }
-}
-int8_t d2d_renderer_sprite_add2(RendererSprite* renderer
-                               ,Sprite*         sprite
-                               ,Texture*        texture
-                               )
-{
-    int32_t texture_index = d2d_renderer_sprite_add_texture(renderer, texture->renderer_id);
-
-    if (texture_index == -1)
-        return DELO_ERROR;
 
-    int32_t index = renderer->count;
+    int8_t error = d2d_path_section(path, point, normal_a, width, alpha);
 
-    if (index < renderer->capacity)
+    if (style->join == DELO_JOIN_ROUND)
     {
-        uint16_t texture_width  = (texture == NULL) ? 0.0 : texture->width;
-        uint16_t texture_height = (texture == NULL) ? 0.0 : texture->height;
+        float    cross = direction_a.x * direction_b.y - direction_a.y * direction_b.x;
+        float    angle = atan2f(cross, dot);
+        uint32_t steps = d2d_path_arc_segments(width, angle, path->tolerance);
+
+        for (uint32_t i = 1; i < steps; i++)
+        {
+            float    t = angle * i / steps;
+            Vector2f n = {normal_a.x * cosf(t) - normal_a.y * sinf(t), normal_a.x * sinf(t) + normal_a.y * cosf(t)};
 
-        renderer->colors[index]           = sprite->color;
-        renderer->transforms[index]       = d2d_matrix44_scale(sprite->width * 0.5, sprite->height * 0.5, 1);
-        renderer->offsets[index].x        = sprite->position.x;
-        renderer->offsets[index].y        = sprite->position.y;
-        renderer->src_rects[index].x      = sprite->src_rect.x / texture_width;
-        renderer->src_rects[index].y      = sprite->src_rect.y / texture_height;
-        renderer->src_rects[index].width  = sprite->src_rect.width / texture_width;
-        renderer->src_rects[index].height = sprite->src_rect.height / texture_height;
-        renderer->texture_indices[index]  = (float)texture_index;
-        renderer->limit_ys[index].x       = 0;
-        renderer->limit_ys[index].y       = 0;
-        renderer->change_mask             = 0b11111111;
-        renderer->count++;
+            error |= d2d_path_section(path, point, n, width, alpha);
+        }
     }
+
+    error |= d2d_path_section(path, point, normal_b, width, alpha);
+
+    return error ? DELO_ERROR : DELO_SUCCESS;
 }
-int8_t d2d_renderer_sprite_add(RendererSprite* renderer
-                              ,float           x
-                              ,float           y
-                              ,float           dest_width
-                              ,float           dest_height
-                              ,float           src_x
-                              ,float           src_y
-                              ,float           src_width
-                              ,float           src_height
-                              ,Texture*        texture
-                              ,Color*          color
-                              )
+static Vector2f d2d_path_direction(Vector2f a
+                                  ,Vector2f b
+                                  )
 {
+    float dx     = b.x - a.x;
+    float dy     = b.y - a.y;
+    float length = sqrtf(dx * dx + dy * dy);
 
-    int32_t texture_index = d2d_renderer_sprite_add_texture(renderer, texture->renderer_id);
-    if (texture_index == -1)
+    return (length > 0) ? (Vector2f){dx / length, dy / length} : (Vector2f){1, 0};
+}
+// Flattened points become cross sections (center, offset normal, half width, alpha). They don't depend on color, so a cached path is re-emitted without any joins or trig.
+static int8_t d2d_path_tessellate(Path*      path
+                                 ,PathStyle* style
+                                 )
+{
+    float width = style->width * 0.5f;
+    float alpha = 1.0f;
+
+    // Lines thinner than a pixel keep a pixel wide core and fade instead.
+    if (style->width < 1.0f)
     {
-        return DELO_ERROR;
+        alpha = style->width;
+        width = 0.5f;
     }
-    int32_t index = renderer->count;
 
-    if (index < renderer->capacity)
+    path->style         = *style;
+    path->section_count = 0;
+    path->bounds_min    = (Vector2f){ FLT_MAX,  FLT_MAX};
+    path->bounds_max    = (Vector2f){-FLT_MAX, -FLT_MAX};
+
+    int8_t error = DELO_SUCCESS;
+
+    for (uint32_t c = 0; c < path->contour_count; c++)
     {
-        uint16_t texture_width  = (texture == NULL) ? 0.0 : texture->width;
-        uint16_t texture_height = (texture == NULL) ? 0.0 : texture->height;
+        PathContour *contour = &path->contours[c];
+        Vector2f    *points  = &path->points[contour->first];
+        uint32_t     count   = contour->count;
+
+        contour->section_first = path->section_count;
+
+        if (count < 2)
+        {
+            contour->section_count = 0;
+            continue;
+        }
+
+        if (contour->closed && count > 2)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                Vector2f previous = points[(i + count - 1) % count];
+                Vector2f next     = points[(i + 1) % count];
+
+                error |= d2d_path_join(path, points[i], d2d_path_direction(previous, points[i]), d2d_path_direction(points[i], next), width, alpha);
+            }
+        }
+        else
+        {
+            error |= d2d_path_cap(path, points[0], d2d_path_direction(points[0], points[1]), width, alpha, 1);
+
+            for (uint32_t i = 1; i + 1 < count; i++)
+            {
+                error |= d2d_path_join(path, points[i], d2d_path_direction(points[i - 1], points[i]), d2d_path_direction(points[i], points[i + 1]), width, alpha);
+            }
+
+            error |= d2d_path_cap(path, points[count - 1], d2d_path_direction(points[count - 2], points[count - 1]), width, alpha, 0);
+        }
 
-        renderer->colors[index]           = *color;
-        renderer->transforms[index]       = d2d_matrix44_scale(dest_width * 0.5, dest_height * 0.5, 1);
-        renderer->offsets[index].x        = x;
-        renderer->offsets[index].y        = y;
-        renderer->src_rects[index].x      = src_x / texture_width;
-        renderer->src_rects[index].y      = src_y / texture_height;
-        renderer->src_rects[index].width  = src_width / texture_width;
-        renderer->src_rects[index].height = src_height / texture_height;
-        renderer->texture_indices[index]  = (float)texture_index;
-        renderer->limit_ys[index].x       = 0;
-        renderer->limit_ys[index].y       = 0;
-        renderer->change_mask             = 0b11111111;
-        renderer->count++;
+        contour->section_count = path->section_count - contour->section_first;
     }
+
+    path->cached = (error == DELO_SUCCESS);
+
+    return error ? DELO_ERROR : DELO_SUCCESS;
 }
-int8_t d2d_renderer_sprite_begin(RendererSprite* renderer
-                                ,Matrix44        projection
-                                )
+static void d2d_path_emit_section(RendererPrimitive* renderer
+                                 ,PathSection*       section
+                                 ,uint32_t           color
+                                 ,uint32_t           color_fringe
+                                 ,float              fringe
+                                 )
 {
-    renderer->count        = 0;
-    renderer->projection   = projection;
-    renderer->texture_id_0 = -1;
-    renderer->texture_id_1 = -1;
-    renderer->texture_id_2 = -1;
-    renderer->texture_id_3 = -1;
+    PrimitiveVertex *v     = &renderer->vertices[renderer->count];
+    float            inner = section->width;
+    float            outer = section->width + fringe;
+
+    v[0] = (PrimitiveVertex){{section->center.x + section->normal.x * outer, section->center.y + section->normal.y * outer}, color_fringe};
+    v[1] = (PrimitiveVertex){{section->center.x + section->normal.x * inner, section->center.y + section->normal.y * inner}, color};
+    v[2] = (PrimitiveVertex){{section->center.x - section->normal.x * inner, section->center.y - section->normal.y * inner}, color};
+    v[3] = (PrimitiveVertex){{section->center.x - section->normal.x * outer, section->center.y - section->normal.y * outer}, color_fringe};
+
+    renderer->count += 4;
 }
-int8_t d2d_renderer_sprite_end(RendererSprite* renderer)
+// Three quads join consecutive sections: fringe, core, fringe.
+static void d2d_path_emit_strip(RendererPrimitive* renderer
+                               ,uint32_t           a
+                               ,uint32_t           b
+                               )
 {
-    d2d_renderer_sprite_update(renderer);
-    d2d_renderer_sprite_render(renderer);
+    uint32_t *indices = &renderer->indices[renderer->index_count];
+
+    for (uint32_t q = 0; q < 3; q++)
+    {
+        indices[q * 6 + 0] = a + q;
+        indices[q * 6 + 1] = a + q + 1;
+        indices[q * 6 + 2] = b + q + 1;
+        indices[q * 6 + 3] = a + q;
+        indices[q * 6 + 4] = b + q + 1;
+        indices[q * 6 + 5] = b + q;
+    }
+
+    renderer->index_count += 18;
 }
-// ================================
-// Renderer SpriteFont functions
-// ================================
-int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer
-                                    ,D2DContext*         context
-                                    ,uint32_t            capacity
-                                    )
+static uint8_t d2d_path_style_equal(PathStyle* a
+                                   ,PathStyle* b
+                                   )
 {
-    renderer->context = context;
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    return a->width == b->width && a->join == b->join && a->cap == b->cap && a->miter_limit == b->miter_limit && a->fringe == b->fringe;
+}
+int8_t d2d_path_stroke(RendererPrimitive* renderer
+                      ,Path*              path
+                      ,PathStyle*         style
+                      )
+{
+    if ((!path->cached || !d2d_path_style_equal(&path->style, style)) && d2d_path_tessellate(path, style) == DELO_ERROR)
     {
         return DELO_ERROR;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glGenVertexArrays(1, &renderer->vao);
-    glBindVertexArray(renderer->vao);
+    if (path->section_count == 0)
+    {
+        return DELO_SUCCESS;
+    }
 
-    GLfloat vertices[] =
+    Rectangle_f bounds = {path->bounds_min.x, path->bounds_min.y, path->bounds_max.x - path->bounds_min.x, path->bounds_max.y - path->bounds_min.y};
+
+    if (d2d_clip_reject(renderer->context, &renderer->projection, bounds))
     {
-        // positions        //texCoords
-        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, // bottom-left
-         1.0f, -1.0f, 0.0f, 1.0f, 0.0f, // bottom-right
-         1.0f,  1.0f, 0.0f, 1.0f, 1.0f, // top-right
-        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f  // top-left
-    };
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
 
-    glGenBuffers(1, &renderer->vbo_vertices);
-    glGenBuffers(1, &renderer->vbo_colors);
-    glGenBuffers(1, &renderer->vbo_transforms);
-    glGenBuffers(1, &renderer->vbo_offsets);
-    glGenBuffers(1, &renderer->vbo_src_rects);
-    glGenBuffers(1, &renderer->vbo_tex_indices);
-    glGenBuffers(1, &renderer->vbo_limit_y);
+    Color    core         = style->color;
+    Color    fringe       = {style->color.r, style->color.g, style->color.b, 0};
+    uint32_t color_core   = d2d_color_pack(core);
+    uint32_t color_fringe = d2d_color_pack(fringe);
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // A chunk has to fit an empty renderer at the largest capacity it may grow to.
+    uint32_t limit     = (renderer->overflow.mode == DELO_RENDERER_GROW && renderer->overflow.capacity_max > renderer->capacity) ? renderer->overflow.capacity_max : renderer->capacity;
+    uint32_t chunk_max = (limit / 4 > 2) ? limit / 4 - 2 : 0;
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    chunk_max = (chunk_max < limit * 2 / 18) ? chunk_max : limit * 2 / 18;
+    chunk_max = (chunk_max < DELO_PATH_CHUNK) ? chunk_max : DELO_PATH_CHUNK;
+
+    if (chunk_max == 0)
+    {
+        fprintf(stderr, "Error stroking path, renderer capacity %u is too small\n", limit);
+        return DELO_ERROR;
+    }
+
+    for (uint32_t c = 0; c < path->contour_count; c++)
+    {
+        PathContour *contour  = &path->contours[c];
+        PathSection *sections = &path->sections[contour->section_first];
+        uint8_t      closed   = contour->closed && contour->section_count > 2;
+        uint32_t     total    = contour->section_count + closed;
+        uint32_t     previous = UINT32_MAX;
+        uint32_t     first    = UINT32_MAX;
+        uint32_t     end      = UINT32_MAX;
+
+        // Space is opened per chunk of sections, a chunk that flushed starts by repeating the section before it.
+        for (uint32_t chunk = 0; chunk < total; chunk += chunk_max)
+        {
+            uint32_t chunk_end = (chunk + chunk_max < total) ? chunk + chunk_max : total;
+            uint32_t n         = chunk_end - chunk;
+
+            if (d2d_renderer_primitive_open(renderer, DELO_TRIANGLE_LIST, (n + 2) * 4, n * 18) == DELO_ERROR)
+            {
+                return DELO_ERROR;
+            }
+
+            if (renderer->count != end && previous != UINT32_MAX)
+            {
+                PathSection *section = &sections[chunk - 1];
+
+                core.a   = style->color.a * section->alpha;
+                first    = UINT32_MAX;
+                previous = renderer->count;
+                d2d_path_emit_section(renderer, section, (section->alpha == 1.0f) ? color_core : d2d_color_pack(core), color_fringe, style->fringe);
+            }
+
+            for (uint32_t i = chunk; i < chunk_end; i++)
+            {
+                uint32_t current = renderer->count;
+
+                if (i == contour->section_count && first != UINT32_MAX)
+                {
+                    current = first;
+                }
+                else
+                {
+                    PathSection *section = &sections[(i == contour->section_count) ? 0 : i];
+
+                    core.a = style->color.a * section->alpha;
+                    d2d_path_emit_section(renderer, section, (section->alpha == 1.0f) ? color_core : d2d_color_pack(core), color_fringe, style->fringe);
+                }
+
+                if (previous != UINT32_MAX)
+                {
+                    d2d_path_emit_strip(renderer, previous, current);
+                }
+
+                first    = (i == 0) ? current : first;
+                previous = current;
+            }
+
+            end = renderer->count;
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+// ================================
+// Plot functions
+// ================================
+int8_t d2d_plot_series_init(PlotSeries* series
+                           ,uint32_t    capacity
+                           ,float       x_start
+                           ,float       x_step
+                           )
+{
+    *series         = (PlotSeries){0};
+    series->x_start = x_start;
+    series->x_step  = x_step;
+
+    return d2d_plot_series_reserve(series, capacity);
+}
+void d2d_plot_series_free(PlotSeries* series)
+{
+    free(series->values);
+
+    for (uint32_t k = 1; k < DELO_PLOT_LEVELS; k++)
+    {
+        free(series->minimum[k]);
+        free(series->maximum[k]);
+    }
+
+    *series = (PlotSeries){0};
+}
+void d2d_plot_series_clear(PlotSeries* series)
+{
+    series->count = 0;
+}
+// Level k holds the min/max of each aligned block of 2^k samples, level 0 is the samples themselves.
+int8_t d2d_plot_series_reserve(PlotSeries* series
+                              ,uint32_t    capacity
+                              )
+{
+    if (capacity <= series->capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    uint32_t grown = (series->capacity < 1024) ? 1024 : series->capacity;
+
+    while (grown < capacity)
+    {
+        grown *= 2;
+    }
+
+    float *values = realloc(series->values, sizeof(float) * grown);
+
+    if (values == NULL)
+    {
+        fprintf(stderr, "Error growing plot series to %u samples\n", grown);
+        return DELO_ERROR;
+    }
+
+    series->values     = values;
+    series->minimum[0] = values;
+    series->maximum[0] = values;
+
+    for (uint32_t k = 1; k < DELO_PLOT_LEVELS && (grown >> k) > 0; k++)
+    {
+        float *minimum = realloc(series->minimum[k], sizeof(float) * (grown >> k));
+
+        if (minimum == NULL)
+        {
+            fprintf(stderr, "Error growing plot series level %u\n", k);
+            return DELO_ERROR;
+        }
+
+        series->minimum[k] = minimum;
+
+        float *maximum = realloc(series->maximum[k], sizeof(float) * (grown >> k));
+
+        if (maximum == NULL)
+        {
+            fprintf(stderr, "Error growing plot series level %u\n", k);
+            return DELO_ERROR;
+        }
+
+        series->maximum[k] = maximum;
+    }
+
+    series->capacity = grown;
+
+    return DELO_SUCCESS;
+}
+// Builds entries [begin, end) of a level from the pairs below it, four at a time with SSE.
+static void d2d_plot_series_reduce(PlotSeries* series
+                                  ,uint32_t    level
+                                  ,uint32_t    begin
+                                  ,uint32_t    end
+                                  )
+{
+    const float *min_src = series->minimum[level - 1];
+    const float *max_src = series->maximum[level - 1];
+    float       *min_dst = series->minimum[level];
+    float       *max_dst = series->maximum[level];
+    uint32_t     i       = begin;
+
+#if defined(__SSE__)
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 min_a = _mm_loadu_ps(&min_src[i * 2]);
+        __m128 min_b = _mm_loadu_ps(&min_src[i * 2 + 4]);
+        __m128 max_a = _mm_loadu_ps(&max_src[i * 2]);
+        __m128 max_b = _mm_loadu_ps(&max_src[i * 2 + 4]);
+
+        _mm_storeu_ps(&min_dst[i], _mm_min_ps(_mm_shuffle_ps(min_a, min_b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(min_a, min_b, _MM_SHUFFLE(3, 1, 3, 1))));
+        _mm_storeu_ps(&max_dst[i], _mm_max_ps(_mm_shuffle_ps(max_a, max_b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(max_a, max_b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        min_dst[i] = fminf(min_src[i * 2], min_src[i * 2 + 1]);
+        max_dst[i] = fmaxf(max_src[i * 2], max_src[i * 2 + 1]);
+    }
+}
+typedef struct PlotReduceJob PlotReduceJob;
+struct PlotReduceJob
+{
+    PlotSeries* series;
+    uint32_t    level;
+    uint32_t    offset;
+};
+static void d2d_plot_series_reduce_job(void*    data
+                                      ,uint32_t begin
+                                      ,uint32_t end
+                                      ,uint32_t worker
+                                      )
+{
+    (void)worker;
+
+    PlotReduceJob *job = (PlotReduceJob *)data;
+    d2d_plot_series_reduce(job->series, job->level, job->offset + begin, job->offset + end);
+}
+// Only the blocks completed by the new samples are built, so streaming appends cost O(count) in total.
+int8_t d2d_plot_series_append(PlotSeries* series
+                             ,float*      values
+                             ,uint32_t    count
+                             )
+{
+    if (d2d_plot_series_reserve(series, series->count + count) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    uint32_t count_prev = series->count;
+
+    memcpy(&series->values[count_prev], values, sizeof(float) * count);
+    series->count += count;
+
+    for (uint32_t k = 1; k < DELO_PLOT_LEVELS; k++)
+    {
+        uint32_t begin = count_prev >> k;
+        uint32_t end   = series->count >> k;
+
+        if (begin == end)
+        {
+            break;
+        }
+
+        if (series->jobs != NULL && end - begin >= DELO_PLOT_PARALLEL_MIN)
+        {
+            PlotReduceJob job     = {series, k, begin};
+            JobCounter    counter = {0};
+
+            d2d_job_parallel_for(series->jobs, d2d_plot_series_reduce_job, &job, end - begin, DELO_PLOT_PARALLEL_MIN / 4, &counter, "plot");
+            d2d_job_wait(series->jobs, &counter);
+        }
+        else
+        {
+            d2d_plot_series_reduce(series, k, begin, end);
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+// Exact min/max of samples [first, end): whole blocks are taken from the coarsest level they fit in,
+// the ragged head and tail from the finer levels below, so a column never picks up its neighbours' samples.
+static Vector2f d2d_plot_series_range(PlotSeries* series
+                                     ,uint32_t    first
+                                     ,uint32_t    end
+                                     )
+{
+    float minimum = FLT_MAX;
+    float maximum = -FLT_MAX;
+
+    for (uint32_t k = 0; first < end; k++)
+    {
+        if (k + 1 == DELO_PLOT_LEVELS)
+        {
+            for (; first < end; first++)
+            {
+                minimum = fminf(minimum, series->minimum[k][first]);
+                maximum = fmaxf(maximum, series->maximum[k][first]);
+            }
+            break;
+        }
+
+        if (first & 1)
+        {
+            minimum = fminf(minimum, series->minimum[k][first]);
+            maximum = fmaxf(maximum, series->maximum[k][first]);
+            first++;
+        }
+
+        if (end & 1)
+        {
+            end--;
+            minimum = fminf(minimum, series->minimum[k][end]);
+            maximum = fmaxf(maximum, series->maximum[k][end]);
+        }
+
+        first >>= 1;
+        end   >>= 1;
+    }
+
+    return (Vector2f){minimum, maximum};
+}
+// Writes {min, max} per column for x in [x_min, x_max); columns without samples get min > max.
+// Each column costs two reads per pyramid level at most, whatever the zoom.
+void d2d_plot_series_decimate(PlotSeries* series
+                             ,float       x_min
+                             ,float       x_max
+                             ,uint32_t    columns
+                             ,Vector2f*   out
+                             )
+{
+    double span   = ((double)x_max - x_min) / series->x_step;
+    double per    = span / columns;
+    double origin = ((double)x_min - series->x_start) / series->x_step;
+
+    for (uint32_t c = 0; c < columns; c++)
+    {
+        double  start = origin + per * c;
+        int64_t first = (int64_t)floor(start);
+        int64_t last  = (int64_t)floor(start + per);
+
+        out[c] = (Vector2f){FLT_MAX, -FLT_MAX};
+
+        // Zoomed past the samples, a column takes the interpolated value at its center.
+        if (per < 1.0)
+        {
+            double  center = start + per * 0.5;
+            int64_t index  = (int64_t)floor(center);
+
+            if (index >= 0 && index + 1 < (int64_t)series->count)
+            {
+                float t = (float)(center - index);
+                float v = series->values[index] + (series->values[index + 1] - series->values[index]) * t;
+                out[c]  = (Vector2f){v, v};
+            }
+
+            continue;
+        }
+
+        // The range reaches one sample into the next column so neighbouring columns always connect.
+        last  = (last + 1 < (int64_t)series->count) ? last + 1 : (int64_t)series->count - 1;
+        first = (first < 0) ? 0 : first;
+
+        if (first > last)
+        {
+            continue;
+        }
+
+        out[c] = d2d_plot_series_range(series, (uint32_t)first, (uint32_t)last + 1);
+    }
+}
+// Draws the decimated series as a band two vertices wide per column, at least a pixel tall.
+int8_t d2d_plot_series_draw(RendererPrimitive* renderer
+                           ,PlotSeries*        series
+                           ,Rectangle_f        rect
+                           ,Vector2f           range_x
+                           ,Vector2f           range_y
+                           ,Color              color
+                           )
+{
+    uint32_t  columns = (rect.width > 1) ? (uint32_t)rect.width : 1;
+    Arena    *scratch = d2d_frame_scratch(renderer->context);
+    ArenaMark mark    = d2d_arena_mark(scratch);
+    Vector2f *values  = d2d_arena_alloc(scratch, sizeof(Vector2f) * columns);
+
+    if (values == NULL)
+    {
+        return DELO_ERROR;
+    }
+
+    d2d_plot_series_decimate(series, range_x.x, range_x.y, columns, values);
+
+    uint32_t packed   = d2d_color_pack(color);
+    float    scale    = rect.height / (range_y.y - range_y.x);
+    float    step     = rect.width / columns;
+    uint32_t previous = UINT32_MAX;
+    int8_t   error    = DELO_SUCCESS;
+
+    for (uint32_t c = 0; c < columns; c++)
+    {
+        if (values[c].x > values[c].y)
+        {
+            previous = UINT32_MAX;
+            continue;
+        }
+
+        uint32_t count = renderer->count;
+
+        if (d2d_renderer_primitive_open(renderer, DELO_TRIANGLE_LIST, 2, 6) == DELO_ERROR)
+        {
+            error = DELO_ERROR;
+            break;
+        }
+
+        // A flush dropped the previous column, the band restarts here.
+        if (renderer->count != count)
+        {
+            previous = UINT32_MAX;
+        }
+
+        float top    = rect.y + rect.height - (values[c].y - range_y.x) * scale;
+        float bottom = rect.y + rect.height - (values[c].x - range_y.x) * scale;
+        float pad    = fmaxf(0, 1 - (bottom - top)) * 0.5f;
+        float x      = rect.x + step * (c + 0.5f);
+
+        PrimitiveVertex *v = &renderer->vertices[renderer->count];
+
+        v[0] = (PrimitiveVertex){{x, top - pad}, packed};
+        v[1] = (PrimitiveVertex){{x, bottom + pad}, packed};
+
+        if (previous != UINT32_MAX)
+        {
+            uint32_t *indices = &renderer->indices[renderer->index_count];
+            uint32_t  current = renderer->count;
+
+            indices[0] = previous;
+            indices[1] = current;
+            indices[2] = current + 1;
+            indices[3] = previous;
+            indices[4] = current + 1;
+            indices[5] = previous + 1;
+
+            renderer->index_count += 6;
+        }
+
+        previous         = renderer->count;
+        renderer->count += 2;
+    }
+
+    d2d_arena_release(scratch, mark);
+
+    return error;
+}
+// ================================
+// Renderer Sprite functions
+// ================================
+int8_t d2d_renderer_sprite_init(RendererSprite* renderer
+                               ,uint32_t        capacity
+                               ,D2DContext*     context
+                               )
+{
+
+    renderer->context = context;
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        return DELO_ERROR;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &renderer->vao);
+    glBindVertexArray(renderer->vao);
+
+    GLfloat vertices[] =
+    {
+        //positions         //texCoords
+        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, // bottom-left
+         1.0f, -1.0f, 0.0f, 1.0f, 0.0f, // bottom-right
+         1.0f,  1.0f, 0.0f, 1.0f, 1.0f, // top-right
+        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f  // top-left
+    };
+
+    glGenBuffers(1, &renderer->vbo_vertices);
+    glGenBuffers(1, &renderer->vbo_colors);
+    glGenBuffers(1, &renderer->vbo_transforms);
+    glGenBuffers(1, &renderer->vbo_offsets);
+    glGenBuffers(1, &renderer->vbo_src_rects);
+    glGenBuffers(1, &renderer->vbo_tex_indices);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
     glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
@@ -2480,7 +5394,7 @@ int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer
     for (int32_t i = 0; i < 4; i++)
     {
         glEnableVertexAttribArray(5 + i);
-        glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4 * 4, (void *)(sizeof(float) * 4 * i));
+        glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 4 * 4, (void *)(sizeof(float) * 4 * i));
         glVertexAttribDivisor(5 + i, 1);
     }
 
@@ -2489,11 +5403,6 @@ int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer
     glEnableVertexAttribArray(9);
     glVertexAttribDivisor(9, 1);
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_limit_y);
-    glVertexAttribPointer(10, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(10);
-    glVertexAttribDivisor(10, 1);
-
     glBindVertexArray(0);
     glUseProgram(0);
 
@@ -2505,12 +5414,14 @@ int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer
     renderer->offsets         = malloc(sizeof(Vector2f)    * capacity);
     renderer->src_rects       = malloc(sizeof(Rectangle_f) * capacity);
     renderer->texture_indices = malloc(sizeof(float)       * capacity);
-    renderer->limit_ys        = malloc(sizeof(Vector2f)    * capacity);
 
-    for (uint32_t i = 0; i < capacity; i++)
-    {
-        renderer->texture_indices[i] = 0;
-    }
+    renderer->change_mask   = 0b11111111;
+    renderer->clip_rejected = 0;
+
+    d2d_renderer_overflow_init(&renderer->overflow, capacity);
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+
+    renderer->texture = NULL;
 
     renderer->projection = d2d_matrix44_orthographic_projection((float)0.0f
                                                                ,(float)context->back_buffer_width
@@ -2519,60 +5430,273 @@ int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer
                                                                ,(float)1
                                                                ,(float)-1
                                                                );
+
     renderer->texture_id_0 = -1;
     renderer->texture_id_1 = -1;
     renderer->texture_id_2 = -1;
     renderer->texture_id_3 = -1;
 
     renderer->flip = 0;
+
+    return DELO_SUCCESS;
+}
+void d2d_renderer_sprite_free(RendererSprite* renderer)
+{
+    glDeleteVertexArrays(1, &renderer->vao);
+    glDeleteBuffers(1, &renderer->vbo_vertices);
+    glDeleteBuffers(1, &renderer->vbo_colors);
+    glDeleteBuffers(1, &renderer->vbo_transforms);
+    glDeleteBuffers(1, &renderer->vbo_offsets);
+    glDeleteBuffers(1, &renderer->vbo_src_rects);
+    glDeleteBuffers(1, (GLuint *)&renderer->vbo_tex_indices);
+
+    free(renderer->colors);
+    free(renderer->transforms);
+    free(renderer->offsets);
+    free(renderer->src_rects);
+    free(renderer->texture_indices);
+
+    renderer->capacity = 0;
+    renderer->count    = 0;
 }
-
-int8_t d2d_renderer_sprite_font_apply_shader(RendererSpriteFont* renderer
-                                            ,uint32_t            shader
-                                            )
-{
-    renderer->shader = shader;
+int8_t d2d_renderer_sprite_apply_shader(RendererSprite* renderer
+                                       ,uint32_t        shader
+                                       )
+{
+    renderer->shader = shader;
 
     glUseProgram(shader);
-    renderer->uniform_location_u_texture0           = glGetUniformLocation(shader, "u_texture0");
-    renderer->uniform_location_u_texture1           = glGetUniformLocation(shader, "u_texture1");
-    renderer->uniform_location_u_texture2           = glGetUniformLocation(shader, "u_texture2");
-    renderer->uniform_location_u_texture3           = glGetUniformLocation(shader, "u_texture3");
-    renderer->uniform_location_u_mvp                = glGetUniformLocation(shader, "u_mvp");
-    renderer->uniform_location_u_flip               = glGetUniformLocation(shader, "u_flip");
-    renderer->uniform_location_u_back_buffer_height = glGetUniformLocation(shader, "u_back_buffer_height");
-    
+    renderer->uniform_location_u_texture0 = glGetUniformLocation(shader, "u_texture0");
+    renderer->uniform_location_u_texture1 = glGetUniformLocation(shader, "u_texture1");
+    renderer->uniform_location_u_texture2 = glGetUniformLocation(shader, "u_texture2");
+    renderer->uniform_location_u_texture3 = glGetUniformLocation(shader, "u_texture3");
+    renderer->uniform_location_u_mvp      = glGetUniformLocation(shader, "u_mvp");
+    renderer->uniform_location_u_flip     = glGetUniformLocation(shader, "u_flip");
+
     glUniform1i(renderer->uniform_location_u_flip, 0);
-    glUniform1f(renderer->uniform_location_u_back_buffer_height,renderer->context->back_buffer_height);
     glUseProgram(0);
 }
-int8_t d2d_renderer_sprite_font_update(RendererSpriteFont* renderer)
+int8_t d2d_renderer_sprite_update(RendererSprite* renderer)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Color) * renderer->count, (float *)renderer->colors, GL_STATIC_DRAW);
+    if ((renderer->change_mask >> 0) & 1)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Color) * renderer->count, (float *)renderer->colors, GL_STATIC_DRAW);
+        renderer->change_mask &= ~(0 << 0);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_transforms);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix44) * renderer->count, (float *)renderer->transforms, GL_STATIC_DRAW);
+    if ((renderer->change_mask >> 1) & 1)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_transforms);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix44) * renderer->count, (float *)renderer->transforms, GL_STATIC_DRAW);
+        renderer->change_mask &= ~(1 << 0);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_offsets);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vector2f) * renderer->count, (float *)renderer->offsets, GL_STATIC_DRAW);
+    if ((renderer->change_mask >> 2) & 1)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_offsets);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vector2f) * renderer->count, (float *)renderer->offsets, GL_STATIC_DRAW);
+        renderer->change_mask &= ~(2 << 0);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_src_rects);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Rectangle_f) * renderer->count, (float *)renderer->src_rects, GL_STATIC_DRAW);
+    if ((renderer->change_mask >> 3) & 1)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_src_rects);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Rectangle_f) * renderer->count, (float *)renderer->src_rects, GL_STATIC_DRAW);
+        renderer->change_mask &= ~(3 << 0);
+    }
+    if ((renderer->change_mask >> 4) & 1)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_tex_indices);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * renderer->count, (float *)renderer->texture_indices, GL_STATIC_DRAW);
+        renderer->change_mask &= ~(4 << 0);
+    }
+}
+// Re-points the per instance attributes so a draw can start at an arbitrary instance without base instance support.
+static void d2d_renderer_instances_bind(GLuint   vbo_colors
+                                       ,GLuint   vbo_offsets
+                                       ,GLuint   vbo_src_rects
+                                       ,GLuint   vbo_transforms
+                                       ,GLuint   vbo_tex_indices
+                                       ,uint32_t first
+                                       )
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_colors);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Color), (void *)(sizeof(Color) * first));
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_tex_indices);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * renderer->count, (float*)renderer->texture_indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_offsets);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vector2f), (void *)(sizeof(Vector2f) * first));
 
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_limit_y);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vector2f) * renderer->count, (Vector2f *)renderer->limit_ys, GL_STATIC_DRAW);
-    
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_src_rects);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Rectangle_f), (void *)(sizeof(Rectangle_f) * first));
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_transforms);
+    for (int32_t i = 0; i < 4; i++)
+    {
+        glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix44), (void *)(sizeof(Matrix44) * first + sizeof(float) * 4 * i));
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_tex_indices);
+    glVertexAttribPointer(9, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *)(sizeof(float) * first));
 }
-int8_t d2d_renderer_sprite_font_add_font(RendererSpriteFont* renderer
-                                        ,SpriteFont*         sprite_font
-                                        )
+int8_t d2d_renderer_sprite_render(RendererSprite* renderer)
+{
+    /*------------------Draw instances-----------------*/
+    glBindVertexArray(renderer->vao);
+
+    glUseProgram(renderer->shader);
+    if (renderer->texture_id_0 != -1)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_0);
+        glUniform1i(renderer->uniform_location_u_texture0, 0);
+    }
+
+    if (renderer->texture_id_1 != -1)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_1);
+        glUniform1i(renderer->uniform_location_u_texture1, 1);
+    }
+
+    if (renderer->texture_id_2 != -1)
+    {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_2);
+        glUniform1i(renderer->uniform_location_u_texture2, 2);
+    }
+
+    if (renderer->texture_id_3 != -1)
+    {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_3);
+        glUniform1i(renderer->uniform_location_u_texture3, 3);
+    }
+
+    Matrix44 *projection = &renderer->projection;
+    glUniformMatrix4fv(renderer->uniform_location_u_mvp, 1, GL_FALSE, &projection->x11);
+
+    glUniform1i(renderer->uniform_location_u_flip, renderer->flip);
+
+    for (uint32_t b = 0; b < renderer->clip_batch_count; b++)
+    {
+        ClipBatch *batch = &renderer->clip_batches[b];
+        uint32_t   last  = (b + 1 < renderer->clip_batch_count) ? renderer->clip_batches[b + 1].first : renderer->count;
+
+        if (last <= batch->first)
+        {
+            continue;
+        }
+
+        d2d_renderer_instances_bind(renderer->vbo_colors
+                                   ,renderer->vbo_offsets
+                                   ,renderer->vbo_src_rects
+                                   ,renderer->vbo_transforms
+                                   ,renderer->vbo_tex_indices
+                                   ,batch->first
+                                   );
+
+        d2d_clip_apply(renderer->context, batch);
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, last - batch->first);
+    }
+
+    d2d_clip_restore(renderer->context);
+
+    if (renderer->texture_id_3 != -1)
+    {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (renderer->texture_id_2 != -1)
+    {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (renderer->texture_id_1 != -1)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (renderer->texture_id_0 != -1)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    /*------------------Draw instances-----------------*/
+}
+// Texture slots stay bound across a flush, so indices handed out before it remain valid.
+static void d2d_renderer_sprite_flush(RendererSprite* renderer)
+{
+    renderer->change_mask = 0b11111111;
+    d2d_renderer_sprite_update(renderer);
+    d2d_renderer_sprite_render(renderer);
+
+    renderer->count = 0;
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+    d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, 0);
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 1, 0});
+}
+static int8_t d2d_renderer_sprite_clip(RendererSprite* renderer)
+{
+    if (d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->count) == DELO_SUCCESS)
+    {
+        return DELO_SUCCESS;
+    }
+
+    d2d_renderer_sprite_flush(renderer);
+
+    return d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->count);
+}
+static int8_t d2d_renderer_sprite_reserve(RendererSprite* renderer
+                                         ,uint32_t        count
+                                         )
 {
-    uint32_t texture_id = sprite_font->texture.renderer_id;
+    if (renderer->count + count <= renderer->capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    uint32_t capacity = d2d_renderer_overflow_capacity(&renderer->overflow, renderer->capacity, renderer->count + count);
+
+    if (capacity > 0
+     && d2d_renderer_grow_array((void **)&renderer->colors, sizeof(Color), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->transforms, sizeof(Matrix44), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->offsets, sizeof(Vector2f), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->src_rects, sizeof(Rectangle_f), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->texture_indices, sizeof(float), capacity) == DELO_SUCCESS)
+    {
+        renderer->capacity = capacity;
+        d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){1, 0, 0});
+
+        if (renderer->count + count <= renderer->capacity)
+        {
+            return DELO_SUCCESS;
+        }
+    }
+
+    if (renderer->count > 0)
+    {
+        d2d_renderer_sprite_flush(renderer);
+    }
+
+    if (count <= renderer->capacity)
+    {
+        return DELO_SUCCESS;
+    }
 
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 0, count});
+    return DELO_ERROR;
+}
+int8_t d2d_renderer_sprite_add_texture(RendererSprite* renderer
+                                      ,int32_t         texture_id
+                                      )
+{
     if (renderer->texture_id_0 == -1 || renderer->texture_id_0 == texture_id)
     {
         renderer->texture_id_0 = texture_id;
@@ -2590,499 +5714,2872 @@ int8_t d2d_renderer_sprite_font_add_font(RendererSpriteFont* renderer
     }
     else if (renderer->texture_id_3 == -1 || renderer->texture_id_3 == texture_id)
     {
-        renderer->texture_id_3 = texture_id;
-        return 3;
+        renderer->texture_id_3 = texture_id;
+        return 3;
+    }
+    else
+    {
+        return -1;
+    }
+}
+int8_t d2d_renderer_sprite_add2(RendererSprite* renderer
+                               ,Sprite*         sprite
+                               ,Texture*        texture
+                               )
+{
+    int32_t texture_index = d2d_renderer_sprite_add_texture(renderer, texture->renderer_id);
+
+    if (texture_index == -1)
+        return DELO_ERROR;
+
+    int32_t index = renderer->count;
+
+    Rectangle_f bounds =
+    {
+        sprite->position.x - sprite->width * 0.5f,
+        sprite->position.y - sprite->height * 0.5f,
+        sprite->width,
+        sprite->height
+    };
+
+    if (d2d_clip_reject(renderer->context, &renderer->projection, bounds))
+    {
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
+
+    if (d2d_renderer_sprite_reserve(renderer, 1) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    if (d2d_renderer_sprite_clip(renderer) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    index = renderer->count;
+
+    uint16_t texture_width  = (texture == NULL) ? 0.0 : texture->width;
+    uint16_t texture_height = (texture == NULL) ? 0.0 : texture->height;
+
+    renderer->colors[index]           = sprite->color;
+    renderer->transforms[index]       = d2d_matrix44_scale(sprite->width * 0.5, sprite->height * 0.5, 1);
+    renderer->offsets[index].x        = sprite->position.x;
+    renderer->offsets[index].y        = sprite->position.y;
+    renderer->src_rects[index].x      = sprite->src_rect.x / texture_width;
+    renderer->src_rects[index].y      = sprite->src_rect.y / texture_height;
+    renderer->src_rects[index].width  = sprite->src_rect.width / texture_width;
+    renderer->src_rects[index].height = sprite->src_rect.height / texture_height;
+    renderer->texture_indices[index]  = (float)texture_index;
+    renderer->change_mask             = 0b11111111;
+    renderer->count++;
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_renderer_sprite_add(RendererSprite* renderer
+                              ,float           x
+                              ,float           y
+                              ,float           dest_width
+                              ,float           dest_height
+                              ,float           src_x
+                              ,float           src_y
+                              ,float           src_width
+                              ,float           src_height
+                              ,Texture*        texture
+                              ,Color*          color
+                              )
+{
+
+    int32_t texture_index = d2d_renderer_sprite_add_texture(renderer, texture->renderer_id);
+    if (texture_index == -1)
+    {
+        return DELO_ERROR;
+    }
+    int32_t index = renderer->count;
+
+    if (d2d_clip_reject(renderer->context, &renderer->projection, (Rectangle_f){x - dest_width * 0.5f, y - dest_height * 0.5f, dest_width, dest_height}))
+    {
+        renderer->clip_rejected++;
+        return DELO_SUCCESS;
+    }
+
+    if (d2d_renderer_sprite_reserve(renderer, 1) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    if (d2d_renderer_sprite_clip(renderer) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    index = renderer->count;
+
+    uint16_t texture_width  = (texture == NULL) ? 0.0 : texture->width;
+    uint16_t texture_height = (texture == NULL) ? 0.0 : texture->height;
+
+    renderer->colors[index]           = *color;
+    renderer->transforms[index]       = d2d_matrix44_scale(dest_width * 0.5, dest_height * 0.5, 1);
+    renderer->offsets[index].x        = x;
+    renderer->offsets[index].y        = y;
+    renderer->src_rects[index].x      = src_x / texture_width;
+    renderer->src_rects[index].y      = src_y / texture_height;
+    renderer->src_rects[index].width  = src_width / texture_width;
+    renderer->src_rects[index].height = src_height / texture_height;
+    renderer->texture_indices[index]  = (float)texture_index;
+    renderer->change_mask             = 0b11111111;
+    renderer->count++;
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_renderer_sprite_begin(RendererSprite* renderer
+                                ,Matrix44        projection
+                                )
+{
+    renderer->count        = 0;
+    renderer->projection   = projection;
+    renderer->texture_id_0 = -1;
+    renderer->texture_id_1 = -1;
+    renderer->texture_id_2 = -1;
+    renderer->texture_id_3 = -1;
+
+    renderer->clip_rejected  = 0;
+    renderer->overflow.stats = (RendererStats){0};
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+}
+int8_t d2d_renderer_sprite_end(RendererSprite* renderer)
+{
+    d2d_renderer_sprite_update(renderer);
+    d2d_renderer_sprite_render(renderer);
+}
+// ================================
+// Renderer SpriteFont functions
+// ================================
+int8_t d2d_renderer_sprite_font_init(RendererSpriteFont* renderer
+                                    ,D2DContext*         context
+                                    ,uint32_t            capacity
+                                    )
+{
+    renderer->context    = context;
+    renderer->text_cache = NULL;
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        return DELO_ERROR;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &renderer->vao);
+    glBindVertexArray(renderer->vao);
+
+    GLfloat vertices[] =
+    {
+        // positions        //texCoords
+        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, // bottom-left
+         1.0f, -1.0f, 0.0f, 1.0f, 0.0f, // bottom-right
+         1.0f,  1.0f, 0.0f, 1.0f, 1.0f, // top-right
+        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f  // top-left
+    };
+
+    glGenBuffers(1, &renderer->vbo_vertices);
+    glGenBuffers(1, &renderer->vbo_colors);
+    glGenBuffers(1, &renderer->vbo_transforms);
+    glGenBuffers(1, &renderer->vbo_offsets);
+    glGenBuffers(1, &renderer->vbo_src_rects);
+    glGenBuffers(1, &renderer->vbo_tex_indices);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_vertices);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_offsets);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_src_rects);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_transforms);
+    for (int32_t i = 0; i < 4; i++)
+    {
+        glEnableVertexAttribArray(5 + i);
+        glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4 * 4, (void *)(sizeof(float) * 4 * i));
+        glVertexAttribDivisor(5 + i, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_tex_indices);
+    glVertexAttribPointer(9, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *)0);
+    glEnableVertexAttribArray(9);
+    glVertexAttribDivisor(9, 1);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    renderer->capacity = capacity;
+    renderer->count    = 0;
+
+    renderer->colors          = malloc(sizeof(Color)       * capacity);
+    renderer->transforms      = malloc(sizeof(Matrix44)    * capacity);
+    renderer->offsets         = malloc(sizeof(Vector2f)    * capacity);
+    renderer->src_rects       = malloc(sizeof(Rectangle_f) * capacity);
+    renderer->texture_indices = malloc(sizeof(float)       * capacity);
+
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        renderer->texture_indices[i] = 0;
+    }
+
+    renderer->projection = d2d_matrix44_orthographic_projection((float)0.0f
+                                                               ,(float)context->back_buffer_width
+                                                               ,(float)0.0f
+                                                               ,(float)context->back_buffer_height
+                                                               ,(float)1
+                                                               ,(float)-1
+                                                               );
+    renderer->texture_id_0 = -1;
+    renderer->texture_id_1 = -1;
+    renderer->texture_id_2 = -1;
+    renderer->texture_id_3 = -1;
+
+    renderer->flip          = 0;
+    renderer->clip_rejected = 0;
+
+    d2d_renderer_overflow_init(&renderer->overflow, capacity);
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+}
+
+int8_t d2d_renderer_sprite_font_apply_shader(RendererSpriteFont* renderer
+                                            ,uint32_t            shader
+                                            )
+{
+    renderer->shader = shader;
+
+    glUseProgram(shader);
+    renderer->uniform_location_u_texture0           = glGetUniformLocation(shader, "u_texture0");
+    renderer->uniform_location_u_texture1           = glGetUniformLocation(shader, "u_texture1");
+    renderer->uniform_location_u_texture2           = glGetUniformLocation(shader, "u_texture2");
+    renderer->uniform_location_u_texture3           = glGetUniformLocation(shader, "u_texture3");
+    renderer->uniform_location_u_mvp                = glGetUniformLocation(shader, "u_mvp");
+    renderer->uniform_location_u_flip               = glGetUniformLocation(shader, "u_flip");
+    
+    glUniform1i(renderer->uniform_location_u_flip, 0);
+    glUseProgram(0);
+}
+int8_t d2d_renderer_sprite_font_update(RendererSpriteFont* renderer)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_colors);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Color) * renderer->count, (float *)renderer->colors, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_transforms);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix44) * renderer->count, (float *)renderer->transforms, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_offsets);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vector2f) * renderer->count, (float *)renderer->offsets, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_src_rects);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Rectangle_f) * renderer->count, (float *)renderer->src_rects, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_tex_indices);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * renderer->count, (float*)renderer->texture_indices, GL_STATIC_DRAW);
+}
+int8_t d2d_renderer_sprite_font_add_texture(RendererSpriteFont* renderer
+                                           ,uint32_t            texture_id
+                                           )
+{
+    if (renderer->texture_id_0 == -1 || renderer->texture_id_0 == texture_id)
+    {
+        renderer->texture_id_0 = texture_id;
+        return 0;
+    }
+    else if (renderer->texture_id_1 == -1 || renderer->texture_id_1 == texture_id)
+    {
+        renderer->texture_id_1 = texture_id;
+        return 1;
+    }
+    else if (renderer->texture_id_2 == -1 || renderer->texture_id_2 == texture_id)
+    {
+        renderer->texture_id_2 = texture_id;
+        return 2;
+    }
+    else if (renderer->texture_id_3 == -1 || renderer->texture_id_3 == texture_id)
+    {
+        renderer->texture_id_3 = texture_id;
+        return 3;
+    }
+    else
+    {
+        return -1;
+    }
+}
+int8_t d2d_renderer_sprite_font_add_font(RendererSpriteFont* renderer
+                                        ,SpriteFont*         sprite_font
+                                        )
+{
+    return d2d_renderer_sprite_font_add_texture(renderer, sprite_font->pages[0].texture.renderer_id);
+}
+int8_t d2d_renderer_sprite_font_render(RendererSpriteFont* renderer)
+{
+    /*------------------Draw instances-----------------*/
+    glBindVertexArray(renderer->vao);
+
+    // Use the shader program
+    glUseProgram(renderer->shader);
+
+    if (renderer->texture_id_0 != -1)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_0);
+        glUniform1i(renderer->uniform_location_u_texture0, 0);
+    }
+
+    if (renderer->texture_id_1 != -1)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_1);
+        glUniform1i(renderer->uniform_location_u_texture1, 1);
+    }
+
+    if (renderer->texture_id_2 != -1)
+    {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_2);
+        glUniform1i(renderer->uniform_location_u_texture2, 2);
+    }
+
+    if (renderer->texture_id_3 != -1)
+    {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_3);
+        glUniform1i(renderer->uniform_location_u_texture3, 3);
+    }
+
+    // Set the MVP matrix
+    Matrix44 *projection = &renderer->projection;
+    glUniformMatrix4fv(renderer->uniform_location_u_mvp, 1, GL_FALSE, &projection->x11);
+
+    // Draw the geometry, one call per clip rect
+    for (uint32_t b = 0; b < renderer->clip_batch_count; b++)
+    {
+        ClipBatch *batch = &renderer->clip_batches[b];
+        uint32_t   last  = (b + 1 < renderer->clip_batch_count) ? renderer->clip_batches[b + 1].first : renderer->count;
+
+        if (last <= batch->first)
+        {
+            continue;
+        }
+
+        d2d_renderer_instances_bind(renderer->vbo_colors
+                                   ,renderer->vbo_offsets
+                                   ,renderer->vbo_src_rects
+                                   ,renderer->vbo_transforms
+                                   ,renderer->vbo_tex_indices
+                                   ,batch->first
+                                   );
+
+        d2d_clip_apply(renderer->context, batch);
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, last - batch->first);
+    }
+
+    d2d_clip_restore(renderer->context);
+
+    if (renderer->texture_id_3 != -1)
+    {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (renderer->texture_id_2 != -1)
+    {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (renderer->texture_id_1 != -1)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (renderer->texture_id_0 != -1)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Cleanup
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    /*------------------Draw instances-----------------*/
+}
+int8_t d2d_renderer_sprite_font_begin(RendererSpriteFont* renderer
+                                     ,Matrix44            projection
+                                     )
+{
+    renderer->count        = 0;
+    renderer->projection   = projection;
+
+    renderer->texture_id_0 = -1;
+    renderer->texture_id_1 = -1;
+    renderer->texture_id_2 = -1;
+    renderer->texture_id_3 = -1;
+
+    renderer->clip_rejected  = 0;
+    renderer->overflow.stats = (RendererStats){0};
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+}
+int8_t d2d_renderer_sprite_font_end(RendererSpriteFont* renderer)
+{
+    d2d_renderer_sprite_font_update(renderer);
+    d2d_renderer_sprite_font_render(renderer);
+}
+static void d2d_renderer_sprite_font_flush(RendererSpriteFont* renderer)
+{
+    d2d_renderer_sprite_font_update(renderer);
+    d2d_renderer_sprite_font_render(renderer);
+
+    renderer->count = 0;
+    d2d_clip_reset(renderer->clip_batches, &renderer->clip_batch_count);
+    d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, 0);
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 1, 0});
+}
+static int8_t d2d_renderer_sprite_font_clip(RendererSpriteFont* renderer)
+{
+    if (d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->count) == DELO_SUCCESS)
+    {
+        return DELO_SUCCESS;
+    }
+
+    d2d_renderer_sprite_font_flush(renderer);
+
+    return d2d_clip_batch(renderer->context, renderer->clip_batches, &renderer->clip_batch_count, renderer->count);
+}
+// Draws what is batched and frees all four texture slots for the next pages.
+static void d2d_renderer_sprite_font_flush_textures(RendererSpriteFont* renderer)
+{
+    if (renderer->count > 0)
+    {
+        d2d_renderer_sprite_font_flush(renderer);
+    }
+
+    renderer->texture_id_0 = -1;
+    renderer->texture_id_1 = -1;
+    renderer->texture_id_2 = -1;
+    renderer->texture_id_3 = -1;
+}
+static int8_t d2d_renderer_sprite_font_add_pages(RendererSpriteFont* renderer
+                                                ,SpriteFont*         sprite_font
+                                                ,uint32_t            page_mask
+                                                ,int32_t*            slots
+                                                )
+{
+    for (uint8_t p = 0; p < sprite_font->page_count; p++)
+    {
+        if (page_mask & (1 << p))
+        {
+            slots[p] = d2d_renderer_sprite_font_add_texture(renderer, sprite_font->pages[p].texture.renderer_id);
+
+            if (slots[p] == -1)
+            {
+                return DELO_ERROR;
+            }
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+static int8_t d2d_renderer_sprite_font_reserve(RendererSpriteFont* renderer
+                                              ,uint32_t            count
+                                              )
+{
+    if (renderer->count + count <= renderer->capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    uint32_t capacity = d2d_renderer_overflow_capacity(&renderer->overflow, renderer->capacity, renderer->count + count);
+
+    if (capacity > 0
+     && d2d_renderer_grow_array((void **)&renderer->colors, sizeof(Color), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->transforms, sizeof(Matrix44), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->offsets, sizeof(Vector2f), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->src_rects, sizeof(Rectangle_f), capacity) == DELO_SUCCESS
+     && d2d_renderer_grow_array((void **)&renderer->texture_indices, sizeof(float), capacity) == DELO_SUCCESS)
+    {
+        renderer->capacity = capacity;
+        d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){1, 0, 0});
+
+        if (renderer->count + count <= renderer->capacity)
+        {
+            return DELO_SUCCESS;
+        }
+    }
+
+    if (renderer->count > 0)
+    {
+        d2d_renderer_sprite_font_flush(renderer);
+    }
+
+    if (count <= renderer->capacity)
+    {
+        return DELO_SUCCESS;
+    }
+
+    d2d_renderer_overflow_record(renderer->context, &renderer->overflow, (RendererStats){0, 0, count});
+    return DELO_ERROR;
+}
+int8_t d2d_renderer_sprite_font_add_text(RendererSpriteFont* renderer
+                                        ,SpriteFont*         sprite_font
+                                        ,char*               text
+                                        ,uint32_t            max_length
+                                        ,Vector2f            position
+                                        ,Color               color
+                                        )
+{
+    return d2d_renderer_sprite_font_add_text_sized(renderer, sprite_font, text, max_length, position, color, sprite_font->font_size);
+}
+int8_t d2d_renderer_sprite_font_add_text_sized(RendererSpriteFont* renderer
+                                              ,SpriteFont*         sprite_font
+                                              ,char*               text
+                                              ,uint32_t            max_length
+                                              ,Vector2f            position
+                                              ,Color               color
+                                              ,float               size
+                                              )
+{
+    float scale = size / sprite_font->font_size;
+
+    int32_t slots[DELO_GLYPH_ATLAS_PAGES];
+
+    for (uint8_t p = 0; p < DELO_GLYPH_ATLAS_PAGES; p++)
+    {
+        slots[p] = -2;
+    }
+
+    d2d_sprite_font_frame(sprite_font, renderer->context);
+
+    TextLayout *layout = NULL;
+
+    if (renderer->text_cache != NULL)
+    {
+        layout = d2d_text_cache_get(renderer->text_cache, sprite_font, text, max_length, scale);
+    }
+
+    if (layout != NULL)
+    {
+        Rectangle_f bounds = layout->bounds;
+        bounds.x += position.x;
+        bounds.y += position.y;
+
+        if (d2d_clip_reject(renderer->context, &renderer->projection, bounds))
+        {
+            renderer->clip_rejected += layout->count;
+            return DELO_SUCCESS;
+        }
+
+        if (d2d_renderer_sprite_font_reserve(renderer, layout->count) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
+
+        if (d2d_renderer_sprite_font_clip(renderer) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
+
+        // A layout uses at most DELO_GLYPH_ATLAS_PAGES pages, so they all fit once the slots are empty.
+        if (d2d_renderer_sprite_font_add_pages(renderer, sprite_font, layout->page_mask, slots) == DELO_ERROR)
+        {
+            d2d_renderer_sprite_font_flush_textures(renderer);
+            d2d_renderer_sprite_font_add_pages(renderer, sprite_font, layout->page_mask, slots);
+        }
+
+        uint32_t index = renderer->count;
+        uint32_t count = layout->count;
+
+        memcpy(&renderer->transforms[index], layout->transforms, sizeof(Matrix44) * count);
+        memcpy(&renderer->src_rects[index], layout->src_rects, sizeof(Rectangle_f) * count);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            renderer->colors[index + i]          = color;
+            renderer->offsets[index + i].x       = position.x + layout->offsets[i].x;
+            renderer->offsets[index + i].y       = position.y + layout->offsets[i].y;
+            renderer->texture_indices[index + i] = (float)slots[layout->pages[i]];
+        }
+
+        renderer->count += count;
+
+        return DELO_SUCCESS;
+    }
+
+    const uint8_t *s   = (const uint8_t*)text;
+    const uint8_t *end = s + strlen(text);
+
+    uint32_t previous = 0;
+
+    if (d2d_renderer_sprite_font_clip(renderer) == DELO_ERROR)
+    {
+        return DELO_ERROR;
+    }
+
+    sprite_font->tick++;
+
+    for (uint32_t i = 0; s < end; i++)
+    {
+        if (max_length > 0 && i > max_length)
+        {
+            break;
+        }
+
+        uint32_t length;
+        uint32_t c = d2d_utf8_decode(s, end, &length);
+        s += length;
+
+        if (c == 32)
+        {
+            position.x += sprite_font->advance * scale;
+            previous = 0;
+            continue;
+        }
+
+        Glyph *glyph = (c > 32) ? d2d_sprite_font_glyph(sprite_font, c) : NULL;
+
+        if (glyph == NULL)
+        {
+            continue;
+        }
+
+        position.x += d2d_sprite_font_kerning(sprite_font, previous, c) * scale;
+        previous    = c;
+
+        if (slots[glyph->page] == -2)
+        {
+            slots[glyph->page] = d2d_renderer_sprite_font_add_texture(renderer, sprite_font->pages[glyph->page].texture.renderer_id);
+        }
+
+        if (slots[glyph->page] == -1)
+        {
+            d2d_renderer_sprite_font_flush_textures(renderer);
+
+            for (uint8_t p = 0; p < DELO_GLYPH_ATLAS_PAGES; p++)
+            {
+                slots[p] = -2;
+            }
+
+            slots[glyph->page] = d2d_renderer_sprite_font_add_texture(renderer, sprite_font->pages[glyph->page].texture.renderer_id);
+        }
+
+        if (d2d_renderer_sprite_font_reserve(renderer, 1) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
+
+        int32_t index = renderer->count;
+
+        d2d_sprite_font_place_glyph(sprite_font
+                                   ,glyph
+                                   ,position
+                                   ,scale
+                                   ,&renderer->transforms[index]
+                                   ,&renderer->offsets[index]
+                                   ,&renderer->src_rects[index]
+                                   );
+
+        Matrix44   *transform = &renderer->transforms[index];
+        Rectangle_f bounds    =
+        {
+            renderer->offsets[index].x - transform->x11,
+            renderer->offsets[index].y - transform->x22,
+            transform->x11 * 2,
+            transform->x22 * 2
+        };
+
+        if (d2d_clip_reject(renderer->context, &renderer->projection, bounds))
+        {
+            renderer->clip_rejected++;
+        }
+        else
+        {
+            renderer->colors[index]          = color;
+            renderer->texture_indices[index] = (float)slots[glyph->page];
+            renderer->count++;
+        }
+
+        position.x += glyph->advance * scale;
+    }
+
+    return DELO_SUCCESS;
+}
+// ================================
+// Arena functions
+// ================================
+int8_t d2d_arena_init(Arena* arena
+                     ,size_t capacity
+                     )
+{
+    arena->base = malloc(capacity);
+
+    if (arena->base == NULL)
+    {
+        fprintf(stderr, "Error allocating %zu byte arena\n", capacity);
+        return DELO_ERROR;
+    }
+
+    arena->capacity   = capacity;
+    arena->high_water = 0;
+    atomic_init(&arena->used, 0);
+    atomic_init(&arena->overflows, 0);
+
+#if defined(DELO_ARENA_POISON)
+    memset(arena->base, DELO_ARENA_POISON_BYTE, capacity);
+#endif
+
+    return DELO_SUCCESS;
+}
+void d2d_arena_free(Arena* arena)
+{
+    free(arena->base);
+    arena->base     = NULL;
+    arena->capacity = 0;
+    atomic_store(&arena->used, 0);
+}
+static size_t d2d_arena_align(size_t size)
+{
+    return (size + DELO_ARENA_ALIGN - 1) & ~(size_t)(DELO_ARENA_ALIGN - 1);
+}
+// Safe to call from several threads at once; an exhausted arena returns NULL rather than falling back to the heap.
+void* d2d_arena_alloc(Arena* arena
+                     ,size_t size
+                     )
+{
+    size_t offset = atomic_load_explicit(&arena->used, memory_order_relaxed);
+
+    size = d2d_arena_align(size);
+
+    do
+    {
+        if (offset + size > arena->capacity)
+        {
+            atomic_fetch_add_explicit(&arena->overflows, 1, memory_order_relaxed);
+            return NULL;
+        }
+    }
+    while (!atomic_compare_exchange_weak_explicit(&arena->used, &offset, offset + size, memory_order_relaxed, memory_order_relaxed));
+
+    return arena->base + offset;
+}
+// Extends in place when ptr is still the newest allocation, otherwise copies into a new block and abandons the old one.
+void* d2d_arena_grow(Arena* arena
+                    ,void*  ptr
+                    ,size_t size
+                    ,size_t new_size
+                    )
+{
+    if (ptr == NULL)
+    {
+        return d2d_arena_alloc(arena, new_size);
+    }
+
+    size_t offset   = (size_t)((uint8_t *)ptr - arena->base);
+    size_t expected = offset + d2d_arena_align(size);
+    size_t end      = offset + d2d_arena_align(new_size);
+
+    if (end <= arena->capacity && atomic_compare_exchange_strong_explicit(&arena->used, &expected, end, memory_order_relaxed, memory_order_relaxed))
+    {
+        return ptr;
+    }
+
+    void *grown = d2d_arena_alloc(arena, new_size);
+
+    if (grown != NULL)
+    {
+        memcpy(grown, ptr, size);
+    }
+
+    return grown;
+}
+ArenaMark d2d_arena_mark(Arena* arena)
+{
+    return atomic_load_explicit(&arena->used, memory_order_relaxed);
+}
+void d2d_arena_release(Arena* arena
+                      ,ArenaMark mark
+                      )
+{
+    size_t used = atomic_load_explicit(&arena->used, memory_order_relaxed);
+
+    if (used > arena->high_water)
+    {
+        arena->high_water = used;
+    }
+
+#if defined(DELO_ARENA_POISON)
+    if (used > mark)
+    {
+        memset(arena->base + mark, DELO_ARENA_POISON_BYTE, used - mark);
+    }
+#endif
+
+    atomic_store_explicit(&arena->used, mark, memory_order_relaxed);
+}
+void d2d_arena_reset(Arena* arena)
+{
+    d2d_arena_release(arena, 0);
+}
+#if defined(DELO_ALLOC_COUNT)
+// Link with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so every heap allocation made from this code is counted.
+static _Atomic uint64_t d2d_allocations = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&d2d_allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+void* __wrap_calloc(size_t count
+                   ,size_t size
+                   )
+{
+    atomic_fetch_add_explicit(&d2d_allocations, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+void* __wrap_realloc(void*  ptr
+                    ,size_t size
+                    )
+{
+    atomic_fetch_add_explicit(&d2d_allocations, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+uint64_t d2d_alloc_count(void)
+{
+    return atomic_load_explicit(&d2d_allocations, memory_order_relaxed);
+}
+#else
+uint64_t d2d_alloc_count(void)
+{
+    return 0;
+}
+#endif
+// ================================
+// Job system functions
+// ================================
+_Thread_local uint32_t d2d_job_worker_index = 0;
+
+static int8_t d2d_job_deque_push(JobDeque* deque
+                                ,Job*      job
+                                )
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top    = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if (bottom - top >= DELO_JOB_DEQUE_SIZE)
+    {
+        return DELO_ERROR;
+    }
+
+    deque->jobs[bottom & (DELO_JOB_DEQUE_SIZE - 1)] = *job;
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+    return DELO_SUCCESS;
+}
+// Owner end of the Chase-Lev deque, only the worker that owns it may pop.
+static uint8_t d2d_job_deque_pop(JobDeque* deque
+                                ,Job*      job
+                                )
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return 0;
+    }
+
+    *job = deque->jobs[bottom & (DELO_JOB_DEQUE_SIZE - 1)];
+
+    if (top == bottom)
+    {
+        // Last job, race the thieves for it.
+        uint8_t won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won;
+    }
+
+    return 1;
+}
+static uint8_t d2d_job_deque_steal(JobDeque* deque
+                                  ,Job*      job
+                                  )
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom)
+    {
+        return 0;
+    }
+
+    *job = deque->jobs[top & (DELO_JOB_DEQUE_SIZE - 1)];
+
+    return atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+static void d2d_job_execute(JobSystem* system
+                           ,JobWorker* worker
+                           ,Job*       job
+                           )
+{
+    double start = glfwGetTime();
+
+    job->fn(job->data, job->begin, job->end, worker->index);
+
+    double end = glfwGetTime();
+
+    worker->stats.jobs++;
+    worker->stats.busy += end - start;
+
+    if (system->profile_fn != NULL)
+    {
+        system->profile_fn(system->profile_user, worker->index, job->name, start, end);
+    }
+
+    if (job->counter != NULL)
+    {
+        atomic_fetch_sub_explicit(&job->counter->value, 1, memory_order_release);
+    }
+}
+static uint8_t d2d_job_run_one(JobSystem* system
+                              ,JobWorker* worker
+                              )
+{
+    Job job;
+
+    if (d2d_job_deque_pop(&worker->deque, &job))
+    {
+        atomic_fetch_sub(&system->pending, 1);
+        d2d_job_execute(system, worker, &job);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < system->worker_count; i++)
+    {
+        // xorshift picks victims so workers do not all hammer the same deque.
+        worker->random ^= worker->random << 13;
+        worker->random ^= worker->random >> 17;
+        worker->random ^= worker->random << 5;
+
+        uint32_t victim = worker->random % system->worker_count;
+
+        if (victim == worker->index)
+        {
+            continue;
+        }
+
+        if (d2d_job_deque_steal(&system->workers[victim].deque, &job))
+        {
+            atomic_fetch_sub(&system->pending, 1);
+            worker->stats.steals++;
+            d2d_job_execute(system, worker, &job);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+static void d2d_job_pin(JobWorker* worker)
+{
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(worker->index % (uint32_t)sysconf(_SC_NPROCESSORS_ONLN), &cpu_set);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+    {
+        fprintf(stderr, "Error pinning job worker %u\n", worker->index);
+    }
+#else
+    fprintf(stderr, "Job worker pinning is not supported on this platform\n");
+#endif
+}
+static void* d2d_job_worker_main(void* argument)
+{
+    JobWorker *worker = (JobWorker *)argument;
+    JobSystem *system = worker->system;
+
+    d2d_job_worker_index = worker->index;
+
+    if (system->pin)
+    {
+        d2d_job_pin(worker);
+    }
+
+    while (atomic_load(&system->running))
+    {
+        if (d2d_job_run_one(system, worker))
+        {
+            continue;
+        }
+
+        // Spin briefly before sleeping, parallel_for bursts tend to arrive back to back.
+        uint8_t found = 0;
+
+        for (uint32_t i = 0; i < DELO_JOB_SPIN && !found; i++)
+        {
+            sched_yield();
+            found = atomic_load(&system->pending) > 0;
+        }
+
+        if (found)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&system->mutex);
+        atomic_fetch_add(&system->sleepers, 1);
+
+        while (atomic_load(&system->pending) <= 0 && atomic_load(&system->running))
+        {
+            pthread_cond_wait(&system->wake, &system->mutex);
+        }
+
+        atomic_fetch_sub(&system->sleepers, 1);
+        pthread_mutex_unlock(&system->mutex);
+    }
+
+    return NULL;
+}
+int8_t d2d_job_system_init(JobSystem* system
+                          ,uint32_t   worker_count
+                          ,uint8_t    pin
+                          )
+{
+    if (worker_count == 0 || worker_count > DELO_JOB_WORKERS)
+    {
+        fprintf(stderr, "Error job system supports 1 to %u workers, got %u\n", DELO_JOB_WORKERS, worker_count);
+        return DELO_ERROR;
+    }
+
+    system->workers = calloc(worker_count, sizeof(JobWorker));
+
+    if (system->workers == NULL)
+    {
+        fprintf(stderr, "Error allocating job workers\n");
+        return DELO_ERROR;
+    }
+
+    system->worker_count = worker_count;
+    system->pin          = pin;
+    system->profile_fn   = NULL;
+    system->profile_user = NULL;
+
+    atomic_store(&system->running, 1);
+    atomic_store(&system->pending, 0);
+    atomic_store(&system->sleepers, 0);
+
+    pthread_mutex_init(&system->mutex, NULL);
+    pthread_cond_init(&system->wake, NULL);
+
+    // Worker 0 is the calling thread, it runs jobs while it waits on counters.
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        JobWorker *worker = &system->workers[i];
+
+        worker->system = system;
+        worker->index  = i;
+        worker->random = 2463534242u + i * 2654435761u;
+
+        atomic_store(&worker->deque.top, 0);
+        atomic_store(&worker->deque.bottom, 0);
+    }
+
+    d2d_job_worker_index = 0;
+
+    if (pin)
+    {
+        d2d_job_pin(&system->workers[0]);
+    }
+
+    for (uint32_t i = 1; i < worker_count; i++)
+    {
+        if (pthread_create(&system->workers[i].thread, NULL, d2d_job_worker_main, &system->workers[i]) != 0)
+        {
+            fprintf(stderr, "Error starting job worker %u\n", i);
+            system->worker_count = i;
+            d2d_job_system_free(system);
+            return DELO_ERROR;
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+void d2d_job_system_free(JobSystem* system)
+{
+    pthread_mutex_lock(&system->mutex);
+    atomic_store(&system->running, 0);
+    pthread_cond_broadcast(&system->wake);
+    pthread_mutex_unlock(&system->mutex);
+
+    for (uint32_t i = 1; i < system->worker_count; i++)
+    {
+        pthread_join(system->workers[i].thread, NULL);
+    }
+
+    pthread_mutex_destroy(&system->mutex);
+    pthread_cond_destroy(&system->wake);
+
+    free(system->workers);
+    system->workers      = NULL;
+    system->worker_count = 0;
+}
+void d2d_job_system_profile(JobSystem*   system
+                           ,JobProfileFn profile_fn
+                           ,void*        user
+                           )
+{
+    system->profile_fn   = profile_fn;
+    system->profile_user = user;
+}
+void d2d_job_system_stats_reset(JobSystem* system)
+{
+    for (uint32_t i = 0; i < system->worker_count; i++)
+    {
+        system->workers[i].stats = (JobWorkerStats){0, 0, 0};
+    }
+}
+void d2d_job_submit(JobSystem*  system
+                   ,JobFn       fn
+                   ,void*       data
+                   ,uint32_t    begin
+                   ,uint32_t    end
+                   ,JobCounter* counter
+                   ,const char* name
+                   )
+{
+    JobWorker *worker = &system->workers[d2d_job_worker_index];
+    Job        job    = {fn, data, begin, end, counter, name};
+
+    if (counter != NULL)
+    {
+        atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
+    }
+
+    // A full deque runs the job inline rather than failing the submit.
+    if (d2d_job_deque_push(&worker->deque, &job) == DELO_ERROR)
+    {
+        d2d_job_execute(system, worker, &job);
+        return;
+    }
+
+    atomic_fetch_add(&system->pending, 1);
+
+    if (atomic_load(&system->sleepers) > 0)
+    {
+        pthread_mutex_lock(&system->mutex);
+        pthread_cond_signal(&system->wake);
+        pthread_mutex_unlock(&system->mutex);
+    }
+}
+void d2d_job_parallel_for(JobSystem*  system
+                         ,JobFn       fn
+                         ,void*       data
+                         ,uint32_t    count
+                         ,uint32_t    grain
+                         ,JobCounter* counter
+                         ,const char* name
+                         )
+{
+    grain = (grain == 0) ? 1 : grain;
+
+    for (uint32_t begin = 0; begin < count; begin += grain)
+    {
+        uint32_t end = (count - begin > grain) ? begin + grain : count;
+        d2d_job_submit(system, fn, data, begin, end, counter, name);
+    }
+
+    if (atomic_load(&system->sleepers) > 0)
+    {
+        pthread_mutex_lock(&system->mutex);
+        pthread_cond_broadcast(&system->wake);
+        pthread_mutex_unlock(&system->mutex);
+    }
+}
+void d2d_job_wait(JobSystem*  system
+                 ,JobCounter* counter
+                 )
+{
+    JobWorker *worker = &system->workers[d2d_job_worker_index];
+
+    // The waiting thread keeps working instead of blocking, which also makes nested waits safe.
+    while (atomic_load_explicit(&counter->value, memory_order_acquire) > 0)
+    {
+        if (!d2d_job_run_one(system, worker))
+        {
+            sched_yield();
+        }
+    }
+}
+// ================================
+// Command recording functions
+// ================================
+int8_t d2d_command_recorder_init(CommandRecorder* recorder
+                                ,uint32_t         thread_count
+                                )
+{
+    if (thread_count == 0 || thread_count > DELO_COMMAND_THREADS)
+    {
+        fprintf(stderr, "Error command recorder supports 1 to %u threads, got %u\n", DELO_COMMAND_THREADS, thread_count);
+        return DELO_ERROR;
+    }
+
+    recorder->buckets = calloc(thread_count, sizeof(CommandBucket));
+
+    if (recorder->buckets == NULL)
+    {
+        fprintf(stderr, "Error allocating command buckets\n");
+        return DELO_ERROR;
+    }
+
+    recorder->thread_count = thread_count;
+    recorder->merged       = 0;
+    recorder->arena        = NULL;
+
+    return DELO_SUCCESS;
+}
+void d2d_command_recorder_free(CommandRecorder* recorder)
+{
+    free(recorder->buckets);
+    recorder->buckets      = NULL;
+    recorder->thread_count = 0;
+}
+// Commands are stored in the given arena, usually d2d_frame_arena, so recording never touches the heap.
+void d2d_command_recorder_reset(CommandRecorder* recorder
+                               ,Arena*           arena
+                               )
+{
+    for (uint32_t t = 0; t < recorder->thread_count; t++)
+    {
+        CommandBucket *bucket    = &recorder->buckets[t];
+        uint32_t       overflows = bucket->overflows;
+
+        memset(bucket, 0, sizeof(CommandBucket));
+        bucket->arena     = arena;
+        bucket->overflows = overflows;
+    }
+
+    recorder->merged = 0;
+    recorder->arena  = arena;
+}
+CommandBucket* d2d_command_recorder_bucket(CommandRecorder* recorder
+                                          ,uint32_t         thread_index
+                                          )
+{
+    return &recorder->buckets[thread_index];
+}
+static int8_t d2d_command_grow(Arena*   arena
+                              ,void**   array
+                              ,size_t   size
+                              ,uint32_t count
+                              ,uint32_t capacity
+                              )
+{
+    void *grown = d2d_arena_grow(arena, *array, size * count, size * capacity);
+
+    if (grown == NULL)
+    {
+        return DELO_ERROR;
+    }
+
+    *array = grown;
+    return DELO_SUCCESS;
+}
+static uint32_t d2d_command_capacity(uint32_t capacity)
+{
+    return (capacity == 0) ? DELO_COMMAND_INITIAL_CAPACITY : capacity * 2;
+}
+// Sprites are chunked rather than grown: four arrays can't all be extended in place, and copying them would waste most of the arena.
+static SpriteChunk* d2d_command_sprite_chunk(Arena*   arena
+                                            ,uint32_t previous
+                                            )
+{
+    uint32_t capacity = d2d_command_capacity(previous);
+
+    if (capacity > DELO_COMMAND_CHUNK_CAPACITY)
+    {
+        capacity = DELO_COMMAND_CHUNK_CAPACITY;
+    }
+
+    SpriteChunk *chunk = d2d_arena_alloc(arena, sizeof(SpriteChunk) + (sizeof(Color) + sizeof(Matrix44) + sizeof(Vector2f) + sizeof(Rectangle_f)) * capacity);
+
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    chunk->next       = NULL;
+    chunk->count      = 0;
+    chunk->capacity   = capacity;
+    chunk->transforms = (Matrix44 *)(chunk + 1);
+    chunk->colors     = (Color *)(chunk->transforms + capacity);
+    chunk->offsets    = (Vector2f *)(chunk->colors + capacity);
+    chunk->src_rects  = (Rectangle_f *)(chunk->offsets + capacity);
+
+    return chunk;
+}
+int8_t d2d_command_sprite(CommandBucket* bucket
+                         ,uint8_t        layer
+                         ,float          x
+                         ,float          y
+                         ,float          dest_width
+                         ,float          dest_height
+                         ,Rectangle_f    src_rect
+                         ,Texture*       texture
+                         ,Color          color
+                         )
+{
+    uint64_t      key     = ((uint64_t)layer << 32) | texture->renderer_id;
+    SpriteBucket *sprites = NULL;
+
+    for (uint32_t i = bucket->sprite_bucket_count; i > 0; i--)
+    {
+        if (bucket->sprites[i - 1].key == key)
+        {
+            sprites = &bucket->sprites[i - 1];
+            break;
+        }
+    }
+
+    if (sprites == NULL)
+    {
+        if (bucket->sprite_bucket_count >= DELO_COMMAND_SPRITE_BUCKETS)
+        {
+            bucket->overflows++;
+            return DELO_ERROR;
+        }
+
+        sprites          = &bucket->sprites[bucket->sprite_bucket_count++];
+        sprites->key     = key;
+        sprites->texture = texture;
+        sprites->first   = NULL;
+        sprites->last    = NULL;
+        sprites->count   = 0;
+    }
+
+    SpriteChunk *chunk = sprites->last;
+
+    if (chunk == NULL || chunk->count == chunk->capacity)
+    {
+        chunk = d2d_command_sprite_chunk(bucket->arena, (chunk == NULL) ? 0 : chunk->capacity);
+
+        if (chunk == NULL)
+        {
+            bucket->overflows++;
+            return DELO_ERROR;
+        }
+
+        if (sprites->last == NULL)
+        {
+            sprites->first = chunk;
+        }
+        else
+        {
+            sprites->last->next = chunk;
+        }
+
+        sprites->last = chunk;
+    }
+
+    uint32_t index = chunk->count++;
+
+    sprites->count++;
+
+    chunk->colors[index]           = color;
+    chunk->transforms[index]       = d2d_matrix44_scale(dest_width * 0.5, dest_height * 0.5, 1);
+    chunk->offsets[index].x        = x;
+    chunk->offsets[index].y        = y;
+    chunk->src_rects[index].x      = src_rect.x / texture->width;
+    chunk->src_rects[index].y      = src_rect.y / texture->height;
+    chunk->src_rects[index].width  = src_rect.width / texture->width;
+    chunk->src_rects[index].height = src_rect.height / texture->height;
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_command_primitive(CommandBucket* bucket
+                            ,Vector2f       position
+                            ,Color          color
+                            )
+{
+    if (bucket->vertex_count == bucket->vertex_capacity)
+    {
+        uint32_t capacity = d2d_command_capacity(bucket->vertex_capacity);
+
+        if (d2d_command_grow(bucket->arena, (void **)&bucket->vertices, sizeof(PrimitiveVertex), bucket->vertex_capacity, capacity) == DELO_ERROR)
+        {
+            bucket->overflows++;
+            return DELO_ERROR;
+        }
+
+        bucket->vertex_capacity = capacity;
+    }
+
+    bucket->vertices[bucket->vertex_count].position = position;
+    bucket->vertices[bucket->vertex_count].color    = d2d_color_pack(color);
+    bucket->vertex_count++;
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_command_circle(CommandBucket* bucket
+                         ,Vector2f       position
+                         ,Color          color
+                         ,float          radius
+                         )
+{
+    if (bucket->circle_count == bucket->circle_capacity)
+    {
+        uint32_t capacity = d2d_command_capacity(bucket->circle_capacity);
+
+        if (d2d_command_grow(bucket->arena, (void **)&bucket->circle_positions, sizeof(Vector2f), bucket->circle_capacity, capacity) == DELO_ERROR
+         || d2d_command_grow(bucket->arena, (void **)&bucket->circle_colors, sizeof(Color), bucket->circle_capacity, capacity) == DELO_ERROR
+         || d2d_command_grow(bucket->arena, (void **)&bucket->circle_radii, sizeof(float), bucket->circle_capacity, capacity) == DELO_ERROR)
+        {
+            bucket->overflows++;
+            return DELO_ERROR;
+        }
+
+        bucket->circle_capacity = capacity;
+    }
+
+    bucket->circle_positions[bucket->circle_count] = position;
+    bucket->circle_colors[bucket->circle_count]    = color;
+    bucket->circle_radii[bucket->circle_count]     = radius;
+    bucket->circle_count++;
+
+    return DELO_SUCCESS;
+}
+// Glyphs can be rasterized into the atlas on first use, which needs the GL context, so text is recorded as runs and laid out at merge.
+int8_t d2d_command_text(CommandBucket* bucket
+                       ,uint8_t        layer
+                       ,SpriteFont*    sprite_font
+                       ,const char*    text
+                       ,uint32_t       max_length
+                       ,Vector2f       position
+                       ,Color          color
+                       ,float          size
+                       )
+{
+    uint32_t length = (uint32_t)strlen(text);
+
+    if (bucket->run_count == bucket->run_capacity)
+    {
+        uint32_t capacity = d2d_command_capacity(bucket->run_capacity);
+
+        if (d2d_command_grow(bucket->arena, (void **)&bucket->runs, sizeof(TextRun), bucket->run_capacity, capacity) == DELO_ERROR)
+        {
+            bucket->overflows++;
+            return DELO_ERROR;
+        }
+
+        bucket->run_capacity = capacity;
+    }
+
+    while (bucket->char_count + length + 1 > bucket->char_capacity)
+    {
+        uint32_t capacity = d2d_command_capacity(bucket->char_capacity);
+
+        if (d2d_command_grow(bucket->arena, (void **)&bucket->chars, sizeof(char), bucket->char_capacity, capacity) == DELO_ERROR)
+        {
+            bucket->overflows++;
+            return DELO_ERROR;
+        }
+
+        bucket->char_capacity = capacity;
+    }
+
+    TextRun *run = &bucket->runs[bucket->run_count++];
+
+    run->font       = sprite_font;
+    run->text       = bucket->char_count;
+    run->max_length = max_length;
+    run->position   = position;
+    run->color      = color;
+    run->size       = size;
+    run->layer      = layer;
+
+    memcpy(&bucket->chars[bucket->char_count], text, length + 1);
+    bucket->char_count += length + 1;
+
+    return DELO_SUCCESS;
+}
+static int d2d_command_compare_sprites(const void* a
+                                      ,const void* b
+                                      )
+{
+    const SpriteBucket *sa = *(const SpriteBucket **)a;
+    const SpriteBucket *sb = *(const SpriteBucket **)b;
+
+    if (sa->key != sb->key)
+    {
+        return (sa->key > sb->key) - (sa->key < sb->key);
+    }
+
+    // Buckets live in thread order, so equal keys keep the order the threads were given.
+    return (sa > sb) - (sa < sb);
+}
+int8_t d2d_command_merge_sprites(CommandRecorder* recorder
+                                ,RendererSprite*  renderer
+                                )
+{
+    SpriteBucket *order[DELO_COMMAND_THREADS * DELO_COMMAND_SPRITE_BUCKETS];
+    uint32_t      order_count = 0;
+
+    for (uint32_t t = 0; t < recorder->thread_count; t++)
+    {
+        CommandBucket *bucket = &recorder->buckets[t];
+
+        for (uint32_t i = 0; i < bucket->sprite_bucket_count; i++)
+        {
+            order[order_count++] = &bucket->sprites[i];
+        }
+    }
+
+    qsort(order, order_count, sizeof(SpriteBucket *), d2d_command_compare_sprites);
+
+    for (uint32_t i = 0; i < order_count; i++)
+    {
+        SpriteBucket *sprites = order[i];
+
+        if (sprites->count == 0)
+        {
+            continue;
+        }
+
+        int32_t texture_index = d2d_renderer_sprite_add_texture(renderer, sprites->texture->renderer_id);
+
+        if (texture_index == -1 || d2d_renderer_sprite_clip(renderer) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
+
+        for (SpriteChunk *chunk = sprites->first; chunk != NULL; chunk = chunk->next)
+        {
+            for (uint32_t copied = 0; copied < chunk->count;)
+            {
+                if (renderer->count == renderer->capacity && d2d_renderer_sprite_reserve(renderer, 1) == DELO_ERROR)
+                {
+                    return DELO_ERROR;
+                }
+
+                uint32_t index = renderer->count;
+                uint32_t count = chunk->count - copied;
+
+                count = (count > renderer->capacity - index) ? renderer->capacity - index : count;
+
+                memcpy(&renderer->colors[index], &chunk->colors[copied], sizeof(Color) * count);
+                memcpy(&renderer->transforms[index], &chunk->transforms[copied], sizeof(Matrix44) * count);
+                memcpy(&renderer->offsets[index], &chunk->offsets[copied], sizeof(Vector2f) * count);
+                memcpy(&renderer->src_rects[index], &chunk->src_rects[copied], sizeof(Rectangle_f) * count);
+
+                for (uint32_t j = 0; j < count; j++)
+                {
+                    renderer->texture_indices[index + j] = (float)texture_index;
+                }
+
+                renderer->count  += count;
+                recorder->merged += count;
+                copied           += count;
+            }
+        }
+
+        renderer->change_mask = 0b11111111;
+    }
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_command_merge_primitives(CommandRecorder*   recorder
+                                   ,RendererPrimitive* renderer
+                                   )
+{
+    for (uint32_t t = 0; t < recorder->thread_count; t++)
+    {
+        CommandBucket *bucket = &recorder->buckets[t];
+
+        // Copied in pieces so a bucket larger than the renderer is drawn over several flushes.
+        for (uint32_t copied = 0; copied < bucket->vertex_count;)
+        {
+            if (d2d_renderer_primitive_open(renderer, renderer->type, 1, 1) == DELO_ERROR)
+            {
+                return DELO_ERROR;
+            }
+
+            uint32_t index = renderer->count;
+            uint32_t count = bucket->vertex_count - copied;
+
+            count = (count > renderer->capacity - index) ? renderer->capacity - index : count;
+            count = (count > renderer->index_capacity - renderer->index_count) ? renderer->index_capacity - renderer->index_count : count;
+
+            memcpy(&renderer->vertices[index], &bucket->vertices[copied], sizeof(PrimitiveVertex) * count);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                renderer->indices[renderer->index_count++] = index + i;
+            }
+
+            renderer->count  += count;
+            recorder->merged += count;
+            copied           += count;
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_command_merge_circles(CommandRecorder* recorder
+                                ,RendererCircle*  renderer
+                                )
+{
+    for (uint32_t t = 0; t < recorder->thread_count; t++)
+    {
+        CommandBucket *bucket = &recorder->buckets[t];
+
+        if (bucket->circle_count > 0 && d2d_renderer_circle_clip(renderer) == DELO_ERROR)
+        {
+            return DELO_ERROR;
+        }
+
+        for (uint32_t copied = 0; copied < bucket->circle_count;)
+        {
+            if (renderer->count == renderer->capacity && d2d_renderer_circle_reserve(renderer, 1) == DELO_ERROR)
+            {
+                return DELO_ERROR;
+            }
+
+            uint32_t index = renderer->count;
+            uint32_t count = bucket->circle_count - copied;
+
+            count = (count > renderer->capacity - index) ? renderer->capacity - index : count;
+
+            memcpy(&renderer->positions[index], &bucket->circle_positions[copied], sizeof(Vector2f) * count);
+            memcpy(&renderer->colors[index], &bucket->circle_colors[copied], sizeof(Color) * count);
+            memcpy(&renderer->radii[index], &bucket->circle_radii[copied], sizeof(float) * count);
+
+            renderer->count  += count;
+            recorder->merged += count;
+            copied           += count;
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+int8_t d2d_command_merge_text(CommandRecorder*    recorder
+                             ,RendererSpriteFont* renderer
+                             )
+{
+    uint8_t layer_max = 0;
+
+    for (uint32_t t = 0; t < recorder->thread_count; t++)
+    {
+        for (uint32_t i = 0; i < recorder->buckets[t].run_count; i++)
+        {
+            layer_max = (recorder->buckets[t].runs[i].layer > layer_max) ? recorder->buckets[t].runs[i].layer : layer_max;
+        }
+    }
+
+    // Runs are few next to glyphs, so layers are walked in order instead of sorting.
+    for (uint32_t layer = 0; layer <= layer_max; layer++)
+    {
+        for (uint32_t t = 0; t < recorder->thread_count; t++)
+        {
+            CommandBucket *bucket = &recorder->buckets[t];
+
+            for (uint32_t i = 0; i < bucket->run_count; i++)
+            {
+                TextRun *run = &bucket->runs[i];
+
+                if (run->layer != layer)
+                {
+                    continue;
+                }
+
+                d2d_renderer_sprite_font_add_text_sized(renderer, run->font, &bucket->chars[run->text], run->max_length, run->position, run->color, run->size);
+                recorder->merged++;
+            }
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+// ================================
+// Text cache functions
+// ================================
+int8_t d2d_text_cache_init(TextCache* cache)
+{
+    cache->layouts = malloc(sizeof(TextLayout) * DELO_TEXT_CACHE_SETS * DELO_TEXT_CACHE_WAYS);
+
+    if (cache->layouts == NULL)
+    {
+        fprintf(stderr, "Error allocating memory\n");
+        return DELO_ERROR;
+    }
+
+    d2d_text_cache_clear(cache);
+
+    return DELO_SUCCESS;
+}
+void d2d_text_cache_free(TextCache* cache)
+{
+    free(cache->layouts);
+    cache->layouts = NULL;
+}
+void d2d_text_cache_clear(TextCache* cache)
+{
+    for (uint32_t i = 0; i < DELO_TEXT_CACHE_SETS * DELO_TEXT_CACHE_WAYS; i++)
+    {
+        cache->layouts[i].valid = 0;
+    }
+
+    cache->tick      = 0;
+    cache->hits      = 0;
+    cache->misses    = 0;
+    cache->evictions = 0;
+    cache->bypasses  = 0;
+}
+static void d2d_text_layout_build(TextLayout* layout
+                                 ,SpriteFont* sprite_font
+                                 ,const char* text
+                                 ,uint32_t    max_length
+                                 ,float       scale
+                                 )
+{
+    // Measuring first rasterizes any missing glyphs, so the run below only hits the atlas.
+    d2d_sprite_font_measure(sprite_font, text, -1, -1, -1.0f, &layout->measurement);
+
+    const uint8_t *s        = (const uint8_t*)text;
+    const uint8_t *end      = s + layout->length;
+    Vector2f       position = {0, 0};
+
+    layout->count     = 0;
+    layout->page_mask = 0;
+
+    uint32_t previous = 0;
+    float    min_x    = 0;
+    float    min_y    = 0;
+    float    max_x    = 0;
+    float    max_y    = 0;
+
+    sprite_font->tick++;
+
+    for (uint32_t i = 0; s < end; i++)
+    {
+        if (max_length > 0 && i > max_length)
+        {
+            break;
+        }
+
+        uint32_t length;
+        uint32_t c = d2d_utf8_decode(s, end, &length);
+        s += length;
+
+        if (c == 32)
+        {
+            position.x += sprite_font->advance * scale;
+            previous = 0;
+            continue;
+        }
+
+        Glyph *glyph = (c > 32) ? d2d_sprite_font_glyph(sprite_font, c) : NULL;
+
+        if (glyph == NULL)
+        {
+            continue;
+        }
+
+        position.x += d2d_sprite_font_kerning(sprite_font, previous, c) * scale;
+        previous    = c;
+
+        uint16_t index = layout->count++;
+
+        d2d_sprite_font_place_glyph(sprite_font
+                                   ,glyph
+                                   ,position
+                                   ,scale
+                                   ,&layout->transforms[index]
+                                   ,&layout->offsets[index]
+                                   ,&layout->src_rects[index]
+                                   );
+
+        layout->pages[index] = glyph->page;
+        layout->page_mask   |= 1 << glyph->page;
+
+        Vector2f offset = layout->offsets[index];
+        float    half_w = layout->transforms[index].x11;
+        float    half_h = layout->transforms[index].x22;
+
+        min_x = (index == 0) ? offset.x - half_w : fminf(min_x, offset.x - half_w);
+        min_y = (index == 0) ? offset.y - half_h : fminf(min_y, offset.y - half_h);
+        max_x = (index == 0) ? offset.x + half_w : fmaxf(max_x, offset.x + half_w);
+        max_y = (index == 0) ? offset.y + half_h : fmaxf(max_y, offset.y + half_h);
+
+        position.x += glyph->advance * scale;
+    }
+
+    layout->bounds     = (Rectangle_f){min_x, min_y, max_x - min_x, max_y - min_y};
+    layout->generation = sprite_font->generation;
+}
+TextLayout* d2d_text_cache_get(TextCache*  cache
+                              ,SpriteFont* sprite_font
+                              ,const char* text
+                              ,uint32_t    max_length
+                              ,float       scale
+                              )
+{
+    uint32_t length = strlen(text);
+
+    if (length > DELO_TEXT_LAYOUT_GLYPHS)
+    {
+        cache->bypasses++;
+        return NULL;
+    }
+
+    uint64_t key = 14695981039346656037ULL;
+    key = d2d_hash_fnv1a(&sprite_font, sizeof(sprite_font), key);
+    key = d2d_hash_fnv1a(&max_length, sizeof(max_length), key);
+    key = d2d_hash_fnv1a(&scale, sizeof(scale), key);
+    key = d2d_hash_fnv1a(text, length, key);
+
+    TextLayout *set    = &cache->layouts[((key ^ (key >> 32)) % DELO_TEXT_CACHE_SETS) * DELO_TEXT_CACHE_WAYS];
+    TextLayout *victim = &set[0];
+    uint8_t     stale  = 0;
+
+    cache->tick++;
+
+    for (uint32_t i = 0; i < DELO_TEXT_CACHE_WAYS; i++)
+    {
+        TextLayout *layout = &set[i];
+
+        if (layout->valid && layout->key == key && layout->font == sprite_font && layout->length == length && layout->max_length == max_length && layout->scale == scale)
+        {
+            // An atlas page was evicted since this run was built, its source rects may be stale.
+            if (layout->generation != sprite_font->generation)
+            {
+                victim = layout;
+                stale  = 1;
+                break;
+            }
+
+            sprite_font->tick++;
+
+            for (uint8_t p = 0; p < sprite_font->page_count; p++)
+            {
+                if (layout->page_mask & (1 << p))
+                {
+                    sprite_font->pages[p].last_used = sprite_font->tick;
+                }
+            }
+
+            layout->last_used = cache->tick;
+            cache->hits++;
+            return layout;
+        }
+
+        if (!victim->valid)
+        {
+            continue;
+        }
+        if (!layout->valid || layout->last_used < victim->last_used)
+        {
+            victim = layout;
+        }
+    }
+
+    cache->misses++;
+    cache->evictions += victim->valid && !stale;
+
+    victim->key        = key;
+    victim->font       = sprite_font;
+    victim->length     = length;
+    victim->max_length = max_length;
+    victim->scale      = scale;
+    victim->last_used  = cache->tick;
+    victim->valid      = 1;
+
+    d2d_text_layout_build(victim, sprite_font, text, max_length, scale);
+
+    return victim;
+}
+void d2d_text_cache_measure(TextCache*       cache
+                           ,SpriteFont*      sprite_font
+                           ,const char*      text
+                           ,FontMeasurement* measurement
+                           )
+{
+    TextLayout *layout = (cache == NULL) ? NULL : d2d_text_cache_get(cache, sprite_font, text, 0, 1.0f);
+
+    if (layout != NULL)
+    {
+        *measurement = layout->measurement;
+    }
+    else
+    {
+        d2d_sprite_font_measure(sprite_font, text, -1, -1, -1.0f, measurement);
+    }
+}
+// ================================
+// SpriteFont functions
+// ================================
+void d2d_sprite_font_place_glyph(SpriteFont*  sprite_font
+                                ,Glyph*       glyph
+                                ,Vector2f     position
+                                ,float        scale
+                                ,Matrix44*    transform
+                                ,Vector2f*    offset
+                                ,Rectangle_f* src_rect
+                                )
+{
+    float page_size = (float)sprite_font->page_size;
+
+    *transform       = d2d_matrix44_scale((float)glyph->w * 0.5 * scale, (float)glyph->h * 0.5 * scale, 1);
+    offset->x        = position.x + (glyph->bearing_x + sprite_font->padding) * scale;
+    offset->y        = position.y + (sprite_font->font_size + sprite_font->padding - glyph->bearing_y) * scale;
+    src_rect->x      = (float)glyph->x / page_size;
+    src_rect->y      = (float)glyph->y / page_size;
+    src_rect->width  = (float)glyph->w / page_size;
+    src_rect->height = (float)glyph->h / page_size;
+}
+static int8_t d2d_sprite_font_face_open(SpriteFont* sprite_font)
+{
+    if (FT_Init_FreeType(&sprite_font->ft))
+    {
+        fprintf(stderr, "Error: Could not initialize FreeType library\n");
+        return DELO_ERROR;
+    }
+
+    if (FT_New_Face(sprite_font->ft, sprite_font->path, 0, &sprite_font->face))
+    {
+        fprintf(stderr, "Error: Could not open font file\n");
+        FT_Done_FreeType(sprite_font->ft);
+        sprite_font->face = NULL;
+        return DELO_ERROR;
+    }
+
+    if (FT_Set_Pixel_Sizes(sprite_font->face, 0, (FT_UInt)sprite_font->font_size))
+    {
+        FT_Done_Face(sprite_font->face);
+        FT_Done_FreeType(sprite_font->ft);
+        sprite_font->face = NULL;
+        return DELO_ERROR;
+    }
+
+    return DELO_SUCCESS;
+}
+static GlyphPage* d2d_sprite_font_page_create(SpriteFont*          sprite_font
+                                             ,const unsigned char* pixels
+                                             )
+{
+    GlyphPage *page = &sprite_font->pages[sprite_font->page_count++];
+    uint16_t   size = sprite_font->page_size;
+
+    page->shelf_count = 0;
+    page->bottom      = 0;
+    page->last_used   = sprite_font->tick;
+
+    unsigned char* black_pixels = (pixels == NULL) ? (unsigned char*)calloc((size_t)size * size, sizeof(unsigned char)) : NULL;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glGenTextures(1, &page->texture.renderer_id);
+    glBindTexture(GL_TEXTURE_2D, page->texture.renderer_id);
+
+    // Distance fields are meant to be interpolated, coverage bitmaps are drawn texel for texel.
+    GLint filter = sprite_font->sdf ? GL_LINEAR : GL_NEAREST;
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, size, size, 0, GL_RED, GL_UNSIGNED_BYTE, (pixels == NULL) ? black_pixels : pixels);
+
+    free(black_pixels);
+
+    page->texture.width           = size;
+    page->texture.height          = size;
+    page->texture.bytes_per_pixel = 1;
+    page->texture.initialized     = 1;
+
+    return page;
+}
+static uint8_t d2d_sprite_font_page_pack(GlyphPage* page
+                                        ,uint16_t   size
+                                        ,uint16_t   w
+                                        ,uint16_t   h
+                                        ,uint16_t*  x
+                                        ,uint16_t*  y
+                                        )
+{
+    GlyphShelf *best = NULL;
+
+    // Best fit by height keeps short glyphs out of tall shelves.
+    for (uint16_t i = 0; i < page->shelf_count; i++)
+    {
+        GlyphShelf *shelf = &page->shelves[i];
+
+        if (shelf->height >= h && size - shelf->x >= w && (best == NULL || shelf->height < best->height))
+        {
+            best = shelf;
+        }
+    }
+
+    if (best == NULL)
+    {
+        if (page->shelf_count >= DELO_GLYPH_ATLAS_SHELVES || size - page->bottom < h)
+        {
+            return 0;
+        }
+
+        best = &page->shelves[page->shelf_count++];
+        best->x      = 0;
+        best->y      = page->bottom;
+        best->height = h;
+
+        page->bottom += h;
+    }
+
+    *x = best->x;
+    *y = best->y;
+    best->x += w;
+
+    return 1;
+}
+static void d2d_sprite_font_table_insert(SpriteFont*  sprite_font
+                                        ,uint32_t     codepoint
+                                        ,const Glyph* glyph
+                                        )
+{
+    uint32_t mask = DELO_GLYPH_TABLE_CAPACITY - 1;
+    uint32_t slot = (codepoint * 2654435761u) >> (32 - DELO_GLYPH_TABLE_BITS);
+
+    while (sprite_font->glyphs[slot].codepoint != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    sprite_font->glyphs[slot].codepoint = codepoint;
+    sprite_font->glyphs[slot].glyph     = *glyph;
+    sprite_font->glyph_count++;
+}
+// Drops the least recently used page that nothing queued this frame refers to.
+static int8_t d2d_sprite_font_page_evict(SpriteFont* sprite_font
+                                        ,uint8_t*    evicted
+                                        )
+{
+    int32_t victim = -1;
+
+    for (uint8_t p = 0; p < sprite_font->page_count; p++)
+    {
+        if (sprite_font->pages[p].last_used > sprite_font->frame_tick)
+        {
+            continue;
+        }
+        if (victim == -1 || sprite_font->pages[p].last_used < sprite_font->pages[victim].last_used)
+        {
+            victim = p;
+        }
+    }
+
+    if (victim == -1)
+    {
+        return DELO_ERROR;
+    }
+
+    GlyphEntry *entries = malloc(sizeof(GlyphEntry) * DELO_GLYPH_TABLE_CAPACITY);
+
+    if (entries == NULL)
+    {
+        return DELO_ERROR;
+    }
+
+    memcpy(entries, sprite_font->glyphs, sizeof(GlyphEntry) * DELO_GLYPH_TABLE_CAPACITY);
+    memset(sprite_font->glyphs, 0, sizeof(GlyphEntry) * DELO_GLYPH_TABLE_CAPACITY);
+    sprite_font->glyph_count = 0;
+
+    for (uint32_t i = 0; i < DELO_GLYPH_TABLE_CAPACITY; i++)
+    {
+        if (entries[i].codepoint != 0 && entries[i].glyph.page != victim)
+        {
+            d2d_sprite_font_table_insert(sprite_font, entries[i].codepoint, &entries[i].glyph);
+        }
+    }
+
+    free(entries);
+
+    sprite_font->pages[victim].shelf_count = 0;
+    sprite_font->pages[victim].bottom      = 0;
+    sprite_font->generation++;
+    sprite_font->evictions++;
+
+    *evicted = victim;
+
+    return DELO_SUCCESS;
+}
+static Glyph* d2d_sprite_font_rasterize(SpriteFont* sprite_font
+                                       ,uint32_t    codepoint
+                                       )
+{
+    // Fonts restored from the font cache only open FreeType once a glyph is missing.
+    if (sprite_font->face == NULL)
+    {
+        if (sprite_font->path[0] == '\0' || d2d_sprite_font_face_open(sprite_font) == DELO_ERROR)
+        {
+            sprite_font->path[0] = '\0';
+            return NULL;
+        }
+    }
+
+    FT_Face face = sprite_font->face;
+
+    if (FT_Load_Char(face, codepoint, sprite_font->sdf ? FT_LOAD_DEFAULT : FT_LOAD_RENDER))
+    {
+        return NULL;
+    }
+
+#if defined(DELO_FREETYPE_SDF)
+    if (sprite_font->sdf && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF))
+    {
+        return NULL;
+    }
+#endif
+
+    FT_GlyphSlot g    = face->glyph;
+    uint16_t     size = sprite_font->page_size;
+    uint16_t     w    = g->bitmap.width + sprite_font->padding;
+    uint16_t     h    = (g->bitmap.rows > sprite_font->line_spacing) ? g->bitmap.rows : sprite_font->line_spacing;
+
+    if (w > size || h > size)
+    {
+        return NULL;
+    }
+
+    uint8_t page = 0;
+
+    if (sprite_font->glyph_count >= DELO_GLYPH_TABLE_CAPACITY * 3 / 4 && d2d_sprite_font_page_evict(sprite_font, &page) == DELO_ERROR)
+    {
+        return NULL;
+    }
+
+    uint16_t x;
+    uint16_t y;
+
+    for (page = 0; page < sprite_font->page_count; page++)
+    {
+        if (d2d_sprite_font_page_pack(&sprite_font->pages[page], size, w, h, &x, &y))
+        {
+            break;
+        }
+    }
+
+    if (page == sprite_font->page_count)
+    {
+        if (sprite_font->page_count < DELO_GLYPH_ATLAS_PAGES)
+        {
+            d2d_sprite_font_page_create(sprite_font, NULL);
+            page = sprite_font->page_count - 1;
+        }
+        else if (d2d_sprite_font_page_evict(sprite_font, &page) == DELO_ERROR)
+        {
+            return NULL;
+        }
+
+        d2d_sprite_font_page_pack(&sprite_font->pages[page], size, w, h, &x, &y);
+    }
+
+    // Upload the whole cell so the padding around the bitmap is cleared along with it.
+    unsigned char *cell = calloc((size_t)w * h, sizeof(unsigned char));
+
+    if (cell == NULL)
+    {
+        return NULL;
     }
-    else
+
+    for (uint32_t row = 0; row < g->bitmap.rows; row++)
     {
-        return -1;
+        memcpy(&cell[row * w], &g->bitmap.buffer[row * g->bitmap.pitch], g->bitmap.width);
     }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, sprite_font->pages[page].texture.renderer_id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RED, GL_UNSIGNED_BYTE, cell);
+
+    free(cell);
+
+    Glyph glyph;
+    glyph.x         = x;
+    glyph.y         = y;
+    glyph.w         = w;
+    glyph.h         = h;
+    glyph.advance   = g->advance.x >> 6;
+    glyph.bearing_x = g->bitmap_left;
+    glyph.bearing_y = g->bitmap_top;
+    glyph.page      = page;
+
+    d2d_sprite_font_table_insert(sprite_font, codepoint, &glyph);
+    sprite_font->pages[page].last_used = sprite_font->tick;
+    sprite_font->rasterized++;
+    sprite_font->cache_dirty = 1;
+
+    return d2d_sprite_font_glyph(sprite_font, codepoint);
 }
-int8_t d2d_renderer_sprite_font_render(RendererSpriteFont* renderer)
+Glyph* d2d_sprite_font_glyph(SpriteFont* sprite_font
+                            ,uint32_t    codepoint
+                            )
 {
-    /*------------------Draw instances-----------------*/
-    glBindVertexArray(renderer->vao);
+    uint32_t mask = DELO_GLYPH_TABLE_CAPACITY - 1;
+    uint32_t slot = (codepoint * 2654435761u) >> (32 - DELO_GLYPH_TABLE_BITS);
 
-    // Use the shader program
-    glUseProgram(renderer->shader);
+    while (sprite_font->glyphs[slot].codepoint != 0)
+    {
+        if (sprite_font->glyphs[slot].codepoint == codepoint)
+        {
+            Glyph *glyph = &sprite_font->glyphs[slot].glyph;
+            sprite_font->pages[glyph->page].last_used = sprite_font->tick;
+            return glyph;
+        }
+        slot = (slot + 1) & mask;
+    }
 
-    if (renderer->texture_id_0 != -1)
+    return d2d_sprite_font_rasterize(sprite_font, codepoint);
+}
+// Glyph instances queued since the last frame end still point into their pages, so the first
+// text of a new frame moves the eviction horizon up to the current tick.
+void d2d_sprite_font_frame(SpriteFont* sprite_font
+                          ,D2DContext* context
+                          )
+{
+    if (sprite_font->frame != context->frame)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_0);
-        glUniform1i(renderer->uniform_location_u_texture0, 0);
+        sprite_font->frame      = context->frame;
+        sprite_font->frame_tick = sprite_font->tick;
     }
+}
+static int8_t d2d_sprite_font_open(SpriteFont* sprite_font
+                                  ,char*       path
+                                  ,uint16_t    font_size
+                                  ,uint8_t     sdf
+                                  )
+{
+    double t0 = glfwGetTime();
 
-    if (renderer->texture_id_1 != -1)
+    memset(sprite_font, 0, sizeof(SpriteFont));
+    snprintf(sprite_font->path, sizeof(sprite_font->path), "%s", path);
+
+    sprite_font->sdf       = sdf;
+    sprite_font->font_size = font_size;
+    sprite_font->padding   = 8;
+
+    GLint max_texture_size = DELO_GLYPH_ATLAS_SIZE;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+    sprite_font->page_size = (max_texture_size < DELO_GLYPH_ATLAS_SIZE) ? max_texture_size : DELO_GLYPH_ATLAS_SIZE;
+    sprite_font->glyphs    = calloc(DELO_GLYPH_TABLE_CAPACITY, sizeof(GlyphEntry));
+
+    if (sprite_font->glyphs == NULL)
     {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_1);
-        glUniform1i(renderer->uniform_location_u_texture1, 1);
+        fprintf(stderr, "Error allocating memory\n");
+        return DELO_ERROR;
     }
 
-    if (renderer->texture_id_2 != -1)
+    if (d2d_font_cache.enabled)
     {
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_2);
-        glUniform1i(renderer->uniform_location_u_texture2, 2);
+        sprite_font->cache_key = d2d_font_cache_key(sprite_font);
+
+        if (sprite_font->cache_key != 0 && d2d_font_cache_load(sprite_font) == DELO_SUCCESS)
+        {
+            d2d_font_cache.hits++;
+            d2d_font_cache.load_time += glfwGetTime() - t0;
+            return DELO_SUCCESS;
+        }
     }
 
-    if (renderer->texture_id_3 != -1)
+    if (d2d_sprite_font_face_open(sprite_font) == DELO_ERROR)
     {
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, renderer->texture_id_3);
-        glUniform1i(renderer->uniform_location_u_texture3, 3);
+        free(sprite_font->glyphs);
+        sprite_font->glyphs = NULL;
+        return DELO_ERROR;
     }
 
-    // Set the MVP matrix
-    Matrix44 *projection = &renderer->projection;
-    glUniformMatrix4fv(renderer->uniform_location_u_mvp, 1, GL_FALSE, &projection->x11);
+    FT_Face face = sprite_font->face;
 
-    // Draw the geometry
-    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, renderer->count);
+    sprite_font->line_spacing = face->size->metrics.height >> 6;
 
-    if (renderer->texture_id_3 != -1)
+    if (FT_Load_Char(face, 32, FT_LOAD_NO_BITMAP))
     {
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        fprintf(stderr, "Failed to load glyph\n");
     }
-
-    if (renderer->texture_id_2 != -1)
+    else
     {
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        sprite_font->advance = face->glyph->advance.x / 64;
     }
 
-    if (renderer->texture_id_1 != -1)
+    d2d_sprite_font_page_create(sprite_font, NULL);
+
+    // Printable ASCII up front, everything else is rasterized the first time it is drawn.
+    for (uint32_t c = 33; c < 127; c++)
     {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        d2d_sprite_font_glyph(sprite_font, c);
     }
 
-    if (renderer->texture_id_0 != -1)
+    if (d2d_font_cache.enabled && sprite_font->cache_key != 0)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        d2d_font_cache.misses++;
+        d2d_font_cache_store(sprite_font);
     }
 
-    // Cleanup
-    glBindVertexArray(0);
-    glUseProgram(0);
+    d2d_font_cache.load_time += glfwGetTime() - t0;
 
-    /*------------------Draw instances-----------------*/
+    return DELO_SUCCESS;
 }
-int8_t d2d_renderer_sprite_font_begin(RendererSpriteFont* renderer
-                                     ,Matrix44            projection
-                                     )
+int8_t d2d_sprite_font_load(SpriteFont* sprite_font
+                           ,char*       path
+                           ,uint16_t    font_size
+                           )
 {
-    renderer->count        = 0;
-    renderer->projection   = projection;
-
-    renderer->texture_id_0 = -1;
-    renderer->texture_id_1 = -1;
-    renderer->texture_id_2 = -1;
-    renderer->texture_id_3 = -1;
+    return d2d_sprite_font_open(sprite_font, path, font_size, 0);
 }
-int8_t d2d_renderer_sprite_font_end(RendererSpriteFont* renderer)
+// Distance field glyphs are generated once at reference_size and drawn at any size
+// with add_text_sized and the sprite_font_sdf shader.
+int8_t d2d_sprite_font_load_sdf(SpriteFont* sprite_font
+                               ,char*       path
+                               ,uint16_t    reference_size
+                               )
 {
-    d2d_renderer_sprite_font_update(renderer);
-    d2d_renderer_sprite_font_render(renderer);
+#if defined(DELO_FREETYPE_SDF)
+    return d2d_sprite_font_open(sprite_font, path, reference_size, 1);
+#else
+    fprintf(stderr, "Error: Signed distance field fonts require FreeType 2.11 or newer\n");
+    return DELO_ERROR;
+#endif
 }
-int8_t d2d_renderer_sprite_font_add_text(RendererSpriteFont* renderer
-                                        ,SpriteFont*         sprite_font
-                                        ,char*               text
-                                        ,uint32_t            max_length
-                                        ,Vector2f            position
-                                        ,Color               color
-                                        ,Vector2f            limit_y
-                                        )
+void d2d_sprite_font_free(SpriteFont* sprite_font)
 {
-    int32_t texture_index = d2d_renderer_sprite_font_add_font(renderer, sprite_font);
-
-    if (texture_index != -1)
+    if (d2d_font_cache.enabled && sprite_font->cache_key != 0 && sprite_font->cache_dirty)
     {
-        uint32_t length = strlen(text);
+        d2d_font_cache_store(sprite_font);
+    }
 
-        uint16_t texture_width = sprite_font->texture.width;
-        uint16_t texture_height = sprite_font->texture.height;
+    for (uint8_t p = 0; p < sprite_font->page_count; p++)
+    {
+        glDeleteTextures(1, &sprite_font->pages[p].texture.renderer_id);
+    }
 
-        for (uint32_t i = 0; i < length; i++)
-        {
-            if (max_length > 0)
-            {
-                if (i > max_length)
-                {
-                    break;
-                }
-            }
-            int32_t index = renderer->count;
+    free(sprite_font->glyphs);
+    free(sprite_font->kerning_pairs);
+    sprite_font->glyphs        = NULL;
+    sprite_font->kerning_pairs = NULL;
+    sprite_font->kerning       = DELO_KERNING_OFF;
+    sprite_font->page_count    = 0;
 
-            if (index < renderer->capacity)
-            {
-                int32_t gindex = (int32_t)text[i] - 33;
-                Glyph *glyph = &sprite_font->glyphs[gindex];
+    if (sprite_font->face != NULL)
+    {
+        FT_Done_Face(sprite_font->face);
+        FT_Done_FreeType(sprite_font->ft);
+        sprite_font->face = NULL;
+    }
+}
+// The face is opened at the first pair lookup, so a font loaded from the cache stays off FreeType until text actually needs it.
+int8_t d2d_sprite_font_enable_kerning(SpriteFont* sprite_font)
+{
+    if (sprite_font->kerning != DELO_KERNING_OFF)
+    {
+        return DELO_SUCCESS;
+    }
 
-                if (gindex > 0)
-                {
-                    renderer->colors[index]           = color;
-                    renderer->transforms[index]       = d2d_matrix44_scale((float)glyph->w * 0.5, (float)glyph->h * 0.5, 1);
-                    renderer->offsets[index].x        = position.x + glyph->bearing_x + sprite_font->padding;
-                    renderer->offsets[index].y        = position.y - glyph->bearing_y + sprite_font->font_size + sprite_font->padding;
-                    renderer->src_rects[index].x      = (float)glyph->x / texture_width;
-                    renderer->src_rects[index].y      = (float)glyph->y / texture_height;
-                    renderer->src_rects[index].width  = (float)glyph->w / texture_width;
-                    renderer->src_rects[index].height = (float)glyph->h / texture_height;
-                    renderer->limit_ys[index].x       = limit_y.x;
-                    renderer->limit_ys[index].y       = limit_y.y;
-
-                    renderer->texture_indices[index] = (float)texture_index;
-                    renderer->count++;
-                    position.x += glyph->advance;
-                }
+    if (sprite_font->kerning_pairs == NULL)
+    {
+        sprite_font->kerning_pairs = calloc(DELO_KERNING_TABLE_CAPACITY, sizeof(KerningPair));
 
-                position.x += (int32_t)text[i] == 32 ? sprite_font->advance : 0;
-            }
+        if (sprite_font->kerning_pairs == NULL)
+        {
+            fprintf(stderr, "Error allocating memory\n");
+            return DELO_ERROR;
         }
     }
-}
 
-// ================================
-// SpriteFont functions
-// ================================
-int8_t d2d_sprite_font_load(SpriteFont* sprite_font
-                           ,char*       path
-                           ,uint16_t    font_size
-                           )
-{
-    setlocale(LC_ALL, "en_US.UTF-8");
-    uint32_t max = 256;
-    FT_Library ft;
-    FT_Face face;
+    sprite_font->kerning_count = 0;
+    sprite_font->kerning       = DELO_KERNING_REQUESTED;
 
-    if (FT_Init_FreeType(&ft))
+    // Cached layouts were built without kerning, there are none before any text was laid out.
+    if (sprite_font->tick != 0)
     {
-        fprintf(stderr, "Error: Could not initialize FreeType library\n");
-        return DELO_ERROR;
+        sprite_font->generation++;
     }
 
-    if (FT_New_Face(ft, path, 0, &face))
+    return DELO_SUCCESS;
+}
+static uint8_t d2d_sprite_font_kerning_resolve(SpriteFont* sprite_font)
+{
+    if (sprite_font->face == NULL && d2d_sprite_font_face_open(sprite_font) == DELO_ERROR)
     {
-        fprintf(stderr, "Error: Could not open font file\n");
-        FT_Done_FreeType(ft);
-        return DELO_ERROR;
+        sprite_font->kerning = DELO_KERNING_OFF;
+        return 0;
     }
 
-    if (FT_Set_Pixel_Sizes(face, 0, (FT_UInt)font_size))
+    // FT_Get_Kerning only reads the legacy kern table, fonts that kern through GPOS alone report none.
+    sprite_font->kerning = FT_HAS_KERNING(sprite_font->face) ? DELO_KERNING_ON : DELO_KERNING_OFF;
+
+    return sprite_font->kerning == DELO_KERNING_ON;
+}
+int32_t d2d_sprite_font_kerning(SpriteFont* sprite_font
+                               ,uint32_t    left
+                               ,uint32_t    right
+                               )
+{
+    if (sprite_font->kerning == DELO_KERNING_OFF || left == 0)
     {
-        FT_Done_FreeType(ft);
-        return DELO_ERROR;
+        return 0;
     }
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (sprite_font->kerning == DELO_KERNING_REQUESTED && !d2d_sprite_font_kerning_resolve(sprite_font))
+    {
+        return 0;
+    }
 
-    glGenTextures(1, &sprite_font->texture.renderer_id);
-    glBindTexture(GL_TEXTURE_2D, sprite_font->texture.renderer_id);
+    uint64_t key  = ((uint64_t)left << 32) | right;
+    uint32_t mask = DELO_KERNING_TABLE_CAPACITY - 1;
+    uint32_t slot = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - DELO_KERNING_TABLE_BITS));
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    while (sprite_font->kerning_pairs[slot].key != 0)
+    {
+        if (sprite_font->kerning_pairs[slot].key == key)
+        {
+            return sprite_font->kerning_pairs[slot].value;
+        }
+        slot = (slot + 1) & mask;
+    }
 
-    sprite_font->texture.width = 0;
-    sprite_font->texture.height = 0;
-    sprite_font->padding = 8;
+    // Pairs are cheap to query again, so a full table is simply started over.
+    if (sprite_font->kerning_count >= DELO_KERNING_TABLE_CAPACITY * 3 / 4)
+    {
+        memset(sprite_font->kerning_pairs, 0, sizeof(KerningPair) * DELO_KERNING_TABLE_CAPACITY);
+        sprite_font->kerning_count = 0;
+        slot = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - DELO_KERNING_TABLE_BITS));
+    }
 
-    int32_t max_ascent = 0;
-    int32_t max_descent = 0;
+    FT_Vector delta = {0, 0};
+    FT_Face   face  = sprite_font->face;
 
-    if (FT_Load_Char(face, 32, FT_LOAD_NO_BITMAP))
+    FT_Get_Kerning(face, FT_Get_Char_Index(face, left), FT_Get_Char_Index(face, right), FT_KERNING_DEFAULT, &delta);
+
+    sprite_font->kerning_pairs[slot].key   = key;
+    sprite_font->kerning_pairs[slot].value = (int16_t)(delta.x >> 6);
+    sprite_font->kerning_count++;
+
+    return sprite_font->kerning_pairs[slot].value;
+}
+int32_t d2d_sprite_font_set_caret_mouse(char*       text
+                                       ,uint32_t    offset
+                                       ,SpriteFont* sprite_font
+                                       ,Vector2f    mp
+                                       )
+{
+    if (mp.x <= 0)
     {
-        fprintf(stderr, "Failed to load glyph\n");
+        return 0;
     }
-    else
+
+    const uint8_t *s   = (const uint8_t*)text;
+    const uint8_t *end = s + strlen(text);
+
+    for (uint32_t i = 0; i < offset && s < end; i++)
     {
-        sprite_font->advance = face->glyph->advance.x / 64;
+        uint32_t length;
+        d2d_utf8_decode(s, end, &length);
+        s += length;
     }
 
-    sprite_font->texture.width = sprite_font->padding;
-    for (uint32_t c = 33; c < max; c++)
-    {
+    FontMeasurement measurement;
+    d2d_sprite_font_measure(sprite_font, (const char*)s, -1, -1, mp.x, &measurement);
+
+    return offset + measurement.caret_index;
+}
+uint32_t d2d_sprite_font_calc_char_limit(char*       text
+                                        ,SpriteFont* sprite_font
+                                        ,int32_t     max_width
+                                        )
+{
+    return 1;
+}
+void d2d_sprite_font_measure(SpriteFont*      sprite_font
+                            ,const char*      text
+                            ,int32_t          limit_ch
+                            ,int32_t          limit_px
+                            ,float            caret_x
+                            ,FontMeasurement* measurement
+                            )
+{
+    const uint8_t *s   = (const uint8_t*)text;
+    const uint8_t *end = s + strlen(text);
+
+    int32_t  width_px    = 0;
+    int32_t  width_ch    = 0;
+    int32_t  count       = 0;
+    int32_t  caret_index = 0;
+    float    caret_min   = FLT_MAX;
+    uint32_t ascii       = 0;
+    uint32_t previous    = 0;
+
+    measurement->limit_ch_hit = 0;
+    measurement->limit_px_hit = 0;
+
+    sprite_font->tick++;
 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+    while (s < end)
+    {
+        if (limit_ch != -1 && count >= limit_ch)
         {
-            fprintf(stderr, "Failed to load glyph\n");
-            continue;
+            measurement->limit_ch_hit = 1;
+            break;
         }
-        else
+        else if (limit_px != -1 && width_px >= limit_px)
+        {
+            measurement->limit_px_hit = 1;
+            break;
+        }
+
+        if (ascii == 0)
         {
-            sprite_font->texture.width += face->glyph->bitmap.width + sprite_font->padding;
-            sprite_font->texture.height = (face->glyph->bitmap.rows > sprite_font->texture.height) ? face->glyph->bitmap.rows : sprite_font->texture.height;
+            ascii = d2d_utf8_ascii_run(s, end);
+        }
 
-            sprite_font->line_spacing = face->size->metrics.height >> 6;
+        uint32_t c;
 
-            FT_GlyphSlot g = face->glyph;
+        if (ascii > 0)
+        {
+            c = *s++;
+            ascii--;
+        }
+        else
+        {
+            uint32_t length;
+            c = d2d_utf8_decode(s, end, &length);
+            s += length;
+        }
 
-            int32_t ascent  = g->bitmap_top;
-            int32_t descent = g->bitmap.rows - g->bitmap_top;
+        if (c == 32)
+        {
+            width_px += sprite_font->advance;
+            width_ch++;
+            previous = 0;
+        }
+        else if (c > 32)
+        {
+            Glyph *glyph = d2d_sprite_font_glyph(sprite_font, c);
 
-            if (ascent > max_ascent)
+            if (glyph != NULL)
             {
-                max_ascent = ascent;
+                width_px += d2d_sprite_font_kerning(sprite_font, previous, c) + glyph->advance;
+                width_ch++;
+                previous = c;
             }
-            if (descent > max_descent)
+        }
+
+        count++;
+
+        if (caret_x >= 0)
+        {
+            float dist = floorf(fabsf((float)width_px - caret_x));
+            if (dist <= caret_min)
             {
-                max_descent = descent;
+                caret_min   = dist;
+                caret_index = count;
             }
         }
     }
-    int width  = sprite_font->texture.width;
-    int height = sprite_font->texture.height;
 
-    unsigned char* black_pixels = (unsigned char*)malloc(width * height * sizeof(unsigned char));
-    memset(black_pixels, 0, width * height * sizeof(unsigned char));
-    
-    glTexImage2D(GL_TEXTURE_2D
-                ,0
-                ,GL_RED
-                ,sprite_font->texture.width
-                ,sprite_font->texture.height
-                ,0
-                ,GL_RED
-                ,GL_UNSIGNED_BYTE
-                ,black_pixels
-                );
+    measurement->width_in_ch  = width_ch;
+    measurement->width_in_px  = width_px;
+    measurement->height_in_px = sprite_font->font_size + sprite_font->padding;
+    measurement->caret_index  = caret_index;
+}
+void d2d_sprite_font_measure_string(char*            text
+                                   ,SpriteFont*      sprite_font
+                                   ,FontMeasurement* measurement
+                                   ,int16_t          limit_ch
+                                   ,int16_t          limit_px
+                                   )
+{
+    d2d_sprite_font_measure(sprite_font, text, limit_ch, limit_px, -1.0f, measurement);
+}
+Vector2f d2d_sprite_font_measure_string2(char*       text
+                                        ,SpriteFont* sprite_font
+                                        )
+{
+    FontMeasurement measurement;
+    d2d_sprite_font_measure(sprite_font, text, -1, -1, -1.0f, &measurement);
 
-    free(black_pixels);
+    return (Vector2f){measurement.width_in_px, measurement.height_in_px};
+}
+
+// ================================
+// Font cache functions
+// ================================
+FontCache d2d_font_cache = {0};
 
-    float offset_x = sprite_font->padding;
-    float offset_y = 0;
+int8_t d2d_font_cache_init(char* directory)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    mkdir(directory, 0755);
 
-    int32_t index = 0;
+    snprintf(d2d_font_cache.directory, sizeof(d2d_font_cache.directory), "%s", directory);
+    d2d_font_cache.enabled = 1;
 
-    for (uint32_t c = 33; c < max; c++)
+    return DELO_SUCCESS;
+#else
+    d2d_font_cache.enabled = 0;
+    return DELO_ERROR;
+#endif
+}
+uint64_t d2d_font_cache_key(SpriteFont* sprite_font)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(sprite_font->path, O_RDONLY);
+    if (fd < 0)
     {
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            fprintf(stderr, "Failed to load glyph\n");
-            continue;
-        }
-        else
-        {
-            offset_y = ((float)max_ascent) - ((float)face->glyph->bitmap_top);
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
 
-            sprite_font->glyphs[index].x         = offset_x;
-            sprite_font->glyphs[index].y         = 0;
-            sprite_font->glyphs[index].w         = face->glyph->bitmap.width + sprite_font->padding;
-            sprite_font->glyphs[index].h         = (face->size->metrics.height >> 6);
-            sprite_font->glyphs[index].advance   = face->glyph->advance.x >> 6;
-            sprite_font->glyphs[index].bearing_x = face->glyph->bitmap_left;
-            sprite_font->glyphs[index].bearing_y = face->glyph->bitmap_top;
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
 
-            index++;
-            int32_t length = face->glyph->bitmap.rows * face->glyph->bitmap.pitch;
+    if (data == MAP_FAILED)
+    {
+        return 0;
+    }
 
-            glTexSubImage2D(GL_TEXTURE_2D
-                           ,0
-                           ,offset_x
-                           ,0
-                           ,face->glyph->bitmap.width
-                           ,face->glyph->bitmap.rows
-                           ,GL_RED
-                           ,GL_UNSIGNED_BYTE
-                           ,face->glyph->bitmap.buffer
-                           );
+    uint32_t version = DELO_FONT_CACHE_VERSION;
+    uint64_t hash    = 14695981039346656037ULL;
 
-            offset_x += face->glyph->bitmap.width + sprite_font->padding;
-        }
-    }
+    hash = d2d_hash_fnv1a(data, st.st_size, hash);
+    hash = d2d_hash_fnv1a(&version, sizeof(version), hash);
+    hash = d2d_hash_fnv1a(&sprite_font->font_size, sizeof(sprite_font->font_size), hash);
+    hash = d2d_hash_fnv1a(&sprite_font->page_size, sizeof(sprite_font->page_size), hash);
+    hash = d2d_hash_fnv1a(&sprite_font->padding, sizeof(sprite_font->padding), hash);
+    hash = d2d_hash_fnv1a(&sprite_font->sdf, sizeof(sprite_font->sdf), hash);
 
-    sprite_font->font_size               = font_size;
-    sprite_font->texture.bytes_per_pixel = 4;
-    sprite_font->texture.initialized     = 1;
+    munmap(data, st.st_size);
 
-    return DELO_SUCCESS;
+    return (hash == 0) ? 1 : hash;
+#else
+    return 0;
+#endif
 }
-uint32_t *sprite_font_convert_to_unicode(const char *string_utf8)
+int8_t d2d_font_cache_load(SpriteFont* sprite_font)
 {
-    setlocale(LC_ALL, "en_US.UTF-8");
-    size_t length_utf8 = strlen(string_utf8);
-
-    size_t wchar_size = mbstowcs(NULL, string_utf8, 0);
+#if defined(__unix__) || defined(__APPLE__)
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%016llx.font", d2d_font_cache.directory, (unsigned long long)sprite_font->cache_key);
 
-    if (wchar_size == (size_t)-1)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
     {
-        perror("mbstowcs");
-        exit(EXIT_FAILURE);
+        return DELO_ERROR;
     }
 
-    wchar_t *unicode_string = (wchar_t *)malloc((wchar_size + 1) * sizeof(wchar_t));
-    if (unicode_string == NULL)
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FontCacheHeader))
     {
-        perror("malloc");
-        exit(EXIT_FAILURE);
+        close(fd);
+        return DELO_ERROR;
     }
 
-    if (mbstowcs(unicode_string, string_utf8, length_utf8) == (size_t)-1)
+    uint8_t *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
     {
-        perror("mbstowcs");
-        free(unicode_string);
-        exit(EXIT_FAILURE);
+        return DELO_ERROR;
     }
 
-    unicode_string[wchar_size] = L'\0';
+    const FontCacheHeader *header = (const FontCacheHeader*)data;
 
-    uint32_t *result = (uint32_t *)malloc((wchar_size + 1) * sizeof(uint32_t));
-    if (result == NULL)
+    size_t page_bytes = (size_t)header->page_size * header->page_size;
+    size_t expected   = sizeof(FontCacheHeader)
+                      + sizeof(FontCachePage) * header->page_count
+                      + sizeof(GlyphEntry) * header->glyph_count
+                      + page_bytes * header->page_count;
+
+    if (header->magic       != DELO_FONT_CACHE_MAGIC
+     || header->version     != DELO_FONT_CACHE_VERSION
+     || header->key         != sprite_font->cache_key
+     || header->page_size   != sprite_font->page_size
+     || header->page_count  == 0
+     || header->page_count  >  DELO_GLYPH_ATLAS_PAGES
+     || header->glyph_count >  DELO_GLYPH_TABLE_CAPACITY * 3 / 4
+     || expected            != (size_t)st.st_size)
     {
-        perror("malloc");
-        free(unicode_string);
-        exit(EXIT_FAILURE);
+        munmap(data, st.st_size);
+        return DELO_ERROR;
     }
 
-    for (size_t i = 0; i <= wchar_size; ++i)
+    const FontCachePage *pages   = (const FontCachePage*)(data + sizeof(FontCacheHeader));
+    const GlyphEntry    *entries = (const GlyphEntry*)(pages + header->page_count);
+    const uint8_t       *pixels  = (const uint8_t*)(entries + header->glyph_count);
+
+    // The payload is checked as carefully as the header, anything out of range means rasterizing again.
+    uint8_t valid = 1;
+
+    for (uint8_t p = 0; p < header->page_count; p++)
     {
-        result[i] = (uint32_t)unicode_string[i];
+        valid &= pages[p].shelf_count <= DELO_GLYPH_ATLAS_SHELVES && pages[p].bottom <= header->page_size;
     }
 
-    free(unicode_string);
+    for (uint32_t i = 0; i < header->glyph_count; i++)
+    {
+        const Glyph *glyph = &entries[i].glyph;
 
-    return result;
-}
-int32_t d2d_sprite_font_set_caret_mouse(char*       text
-                                       ,uint32_t    offset
-                                       ,SpriteFont* sprite_font
-                                       ,Vector2f    mp
-                                       )
-{
-    setlocale(LC_ALL, "en_US.UTF-8");
-    Vector2f measure = {0, 0};
-    uint32_t *unicode_array = sprite_font_convert_to_unicode(text);
-    double min = FLT_MAX;
-    int32_t min_index = offset;
+        valid &= entries[i].codepoint != 0
+              && glyph->page < header->page_count
+              && glyph->x >= 0 && glyph->w >= 0 && (int64_t)glyph->x + glyph->w <= header->page_size
+              && glyph->y >= 0 && glyph->h >= 0 && (int64_t)glyph->y + glyph->h <= header->page_size;
+    }
 
-    if (mp.x <= 0)
+    if (!valid)
     {
-        return 0;
+        fprintf(stderr, "Error: font cache %s is corrupt, rasterizing instead\n", path);
+        munmap(data, st.st_size);
+        return DELO_ERROR;
     }
 
-    for (size_t i = offset; unicode_array[i] != 0; ++i)
-    {
-        uint32_t c = unicode_array[i];
+    sprite_font->line_spacing = header->line_spacing;
+    sprite_font->advance      = header->advance;
 
-        if (c > 32 && c < 256)
-        {
-            Glyph *glyph = &sprite_font->glyphs[(int32_t)c - 33];
+    for (uint8_t p = 0; p < header->page_count; p++)
+    {
+        GlyphPage *page = d2d_sprite_font_page_create(sprite_font, pixels + page_bytes * p);
 
-            measure.x += glyph->advance;
-            measure.y = glyph->h;
-        }
-        else if (c == 32)
-        {
-            measure.x += sprite_font->advance;
-        }
+        memcpy(page->shelves, pages[p].shelves, sizeof(page->shelves));
+        page->shelf_count = pages[p].shelf_count;
+        page->bottom      = pages[p].bottom;
+    }
 
-        double dist = floor(fabs(measure.x - mp.x));
-        if (dist <= min)
-        {
-            min = dist;
-            min_index = i + 1;
-        }
+    for (uint32_t i = 0; i < header->glyph_count; i++)
+    {
+        d2d_sprite_font_table_insert(sprite_font, entries[i].codepoint, &entries[i].glyph);
     }
-    free(unicode_array);
 
-    return min_index;
-}
-uint32_t d2d_sprite_font_calc_char_limit(char*       text
-                                        ,SpriteFont* sprite_font
-                                        ,int32_t     max_width
-                                        )
-{
-    return 1;
+    munmap(data, st.st_size);
+
+    return DELO_SUCCESS;
+#else
+    return DELO_ERROR;
+#endif
 }
-void d2d_sprite_font_measure_string(char*            text
-                                   ,SpriteFont*      sprite_font
-                                   ,FontMeasurement* measurement
-                                   ,int16_t          limit_ch
-                                   ,int16_t          limit_px
-                                   )
+int8_t d2d_font_cache_store(SpriteFont* sprite_font)
 {
-    setlocale(LC_ALL, "en_US.UTF-8");
-    Vector2f measure = {0, 0};
-    uint32_t *unicode_array = sprite_font_convert_to_unicode(text);
+    size_t page_bytes = (size_t)sprite_font->page_size * sprite_font->page_size;
+    size_t size       = sizeof(FontCacheHeader)
+                      + sizeof(FontCachePage) * sprite_font->page_count
+                      + sizeof(GlyphEntry) * sprite_font->glyph_count
+                      + page_bytes * sprite_font->page_count;
+
+    uint8_t *data = calloc(size, 1);
+    if (data == NULL)
+    {
+        return DELO_ERROR;
+    }
 
-    int16_t width_px = 0;
-    int16_t width_ch = 0;
+    FontCacheHeader *header  = (FontCacheHeader*)data;
+    FontCachePage   *pages   = (FontCachePage*)(data + sizeof(FontCacheHeader));
+    GlyphEntry      *entries = (GlyphEntry*)(pages + sprite_font->page_count);
+    uint8_t         *pixels  = (uint8_t*)(entries + sprite_font->glyph_count);
 
-    measurement->limit_ch_hit = 0;
-    measurement->limit_px_hit = 0;
+    header->magic        = DELO_FONT_CACHE_MAGIC;
+    header->version      = DELO_FONT_CACHE_VERSION;
+    header->key          = sprite_font->cache_key;
+    header->line_spacing = sprite_font->line_spacing;
+    header->advance      = sprite_font->advance;
+    header->glyph_count  = sprite_font->glyph_count;
+    header->page_size    = sprite_font->page_size;
+    header->page_count   = sprite_font->page_count;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-    for (size_t i = 0; unicode_array[i] != 0; ++i)
+    for (uint8_t p = 0; p < sprite_font->page_count; p++)
     {
-         if(i >= limit_ch && limit_ch != -1)
-        {
-            measurement->limit_ch_hit = 1;
-            break;
-        }
-        else if (width_px >= limit_px && limit_px != -1)
-        {
-            measurement->limit_px_hit = 1;
-            break;
-        }
+        memcpy(pages[p].shelves, sprite_font->pages[p].shelves, sizeof(pages[p].shelves));
+        pages[p].shelf_count = sprite_font->pages[p].shelf_count;
+        pages[p].bottom      = sprite_font->pages[p].bottom;
 
-        uint32_t c = unicode_array[i];
+        glBindTexture(GL_TEXTURE_2D, sprite_font->pages[p].texture.renderer_id);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, pixels + page_bytes * p);
+    }
 
-        if (c > 32 && c < 256)
-        {
-            Glyph *glyph = &sprite_font->glyphs[(int32_t)c - 33];
-            width_px += glyph->advance;
-            width_ch++;
-        }
-        else if (c == 32)
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < DELO_GLYPH_TABLE_CAPACITY && count < sprite_font->glyph_count; i++)
+    {
+        if (sprite_font->glyphs[i].codepoint != 0)
         {
-            width_px += sprite_font->advance;
-            width_ch++;
+            entries[count++] = sprite_font->glyphs[i];
         }
-
     }
-    measurement->width_in_ch  = width_ch;
-    measurement->width_in_px  = width_px;
-    measurement->height_in_px = sprite_font->font_size + sprite_font->padding;
-
-    free(unicode_array);
-}
-Vector2f d2d_sprite_font_measure_string2(char*       text
-                                        ,SpriteFont* sprite_font
-                                        )
-{
-    setlocale(LC_ALL, "en_US.UTF-8");
-    Vector2f measure = {0, 0};
-    uint32_t *unicode_array = sprite_font_convert_to_unicode(text);
 
-    int16_t width_px = 0;
+    char path[320];
+    char path_tmp[330];
+    snprintf(path, sizeof(path), "%s/%016llx.font", d2d_font_cache.directory, (unsigned long long)sprite_font->cache_key);
+    snprintf(path_tmp, sizeof(path_tmp), "%s.tmp", path);
 
-    for (size_t i = 0; unicode_array[i] != 0; ++i)
+    // Written aside and renamed so a reader never maps a half written file.
+    FILE *f = fopen(path_tmp, "wb");
+    if (f == NULL)
     {
-        uint32_t c = unicode_array[i];
+        free(data);
+        return DELO_ERROR;
+    }
 
-        if (c > 32 && c < 256)
-        {
-            Glyph *glyph = &sprite_font->glyphs[(int32_t)c - 33];
-            width_px += glyph->advance;
-        }
-        else if (c == 32)
-        {
-            width_px += sprite_font->advance;
-        }
+    size_t written = fwrite(data, size, 1, f);
+    fclose(f);
+    free(data);
 
+    if (written != 1 || rename(path_tmp, path) != 0)
+    {
+        remove(path_tmp);
+        return DELO_ERROR;
     }
-    measure.x = width_px;
-    measure.y = sprite_font->font_size + sprite_font->padding;
 
-    free(unicode_array);
+    sprite_font->cache_dirty = 0;
 
-    return measure;
+    return DELO_SUCCESS;
 }
-
 #endif
 
 // ================================
@@ -3093,6 +8590,10 @@ Vector2f d2d_sprite_font_measure_string2(char*       text
 // #define DELO3D_IMPLEMENTATION
 // #include <delo2d.h>
 // ================================
+#define DELO_CUBE_FLAG_SELECTED 1
+#define DELO_CUBE_ID_SHIFT      8
+#define DELO_CUBE_FRAME_SLOTS   3
+
 typedef struct Vector3f Vector3f;
 struct Vector3f
 {
@@ -3126,6 +8627,16 @@ struct Mesh
     
 };
 
+typedef struct CubeInstance CubeInstance;
+struct CubeInstance
+{
+    float    position[3];
+    float    scale;
+    int16_t  rotation[4];
+    uint32_t color;
+    uint32_t flags;
+};
+
 typedef struct RendererCubes RendererCubes;
 struct RendererCubes
 {
@@ -3137,22 +8648,36 @@ struct RendererCubes
     GLuint  uniform_location_view;
     GLuint  uniform_location_projection;
     GLuint  uniform_location_mode;
+    GLuint  uniform_location_compacted;
     GLuint  vbo;
-    GLuint  vao;
-    GLuint  vbo_instance_positions;
-    GLuint  vbo_instance_colors;
-    GLuint  vbo_instance_transforms;
-    GLuint  vbo_instance_ids;
-    GLuint  vbo_instance_selected;
+    GLuint  ebo;
+    GLuint  vao[DELO_CUBE_FRAME_SLOTS];
+    GLuint  vbo_instances[DELO_CUBE_FRAME_SLOTS];
+    GLsync  fences[DELO_CUBE_FRAME_SLOTS];
     GLuint  fbo_object_picking;
     GLuint  texture_object_picking;
     uint8_t update_depth_buffer;
-    uint8_t update_colors;
-    uint8_t update_ids;
-    uint8_t update_positions;
-    uint8_t update_transforms;
-    uint8_t update_selections;
-    GLsync fence;
+    uint8_t update_instances;
+
+    uint32_t dirty_first[DELO_CUBE_FRAME_SLOTS];
+    uint32_t dirty_last[DELO_CUBE_FRAME_SLOTS];
+    uint32_t instance_count;
+    uint32_t stall_count;
+    uint8_t  slot;
+    uint8_t  slot_acquired;
+
+    CubeInstance* instances;
+    CubeInstance* visible_instances;
+    uint32_t      capacity;
+    uint32_t      visible_count;
+    uint32_t      culled_count;
+    uint8_t       culling;
+};
+
+typedef struct Frustum Frustum;
+struct Frustum
+{
+    Vector4f planes[6];
 };
 
 #if defined(DELO3D_FUNCTION_SIGNATURES) || defined(DELO3D_IMPLEMENTATION)
@@ -3194,8 +8719,17 @@ float d3d_vector3f_dot_product(const Vector3f v1, const Vector3f v2);
 // ================================
 void  d3d_renderer_cube_instancing_init(RendererCubes*  renderer,D2DContext* context,int32_t instance_count);
 void  d3d_renderer_cube_instancing_apply_shader(RendererCubes* renderer,uint32_t shader,GLfloat projection_matrix[16]);
-void  d3d_renderer_cube_instancing_update(RendererCubes* renderer,GLfloat* instance_positions,GLfloat* instance_transforms,GLfloat* instance_colors,GLfloat* instance_ids,GLint* instance_selected,int32_t instance_count);
+void  d3d_renderer_cube_instancing_update(RendererCubes* renderer,CubeInstance* instances,int32_t instance_count);
 void  d3d_renderer_cube_instancing_render(RendererCubes* renderer,GLfloat view_matrix[16],int32_t instance_count);
+void  d3d_renderer_cube_instancing_cull(RendererCubes* renderer,GLfloat view_matrix[16],int32_t instance_count);
+void  d3d_renderer_cube_instancing_mark_dirty(RendererCubes* renderer,uint32_t first,uint32_t count);
+void  d3d_renderer_cube_instancing_acquire_slot(RendererCubes* renderer);
+void  d3d_cube_instance_define(CubeInstance* instance,Vector3f position,Vector4f rotation,float scale,Color color);
+// ================================
+// Frustum functions
+// ================================
+void    d3d_frustum_extract(Frustum* frustum,GLfloat view_matrix[16],GLfloat projection_matrix[16]);
+uint8_t d3d_frustum_test_sphere(Frustum* frustum,Vector3f center,float radius);
 // ================================
 // Mouse picking functions
 // ================================
@@ -3207,6 +8741,10 @@ int   d3d_pick(GLint fbo, float mouse_x, float mouse_y, int width, int height, i
 #ifdef DELO3D_IMPLEMENTATION
 #include <math.h>
 #include <time.h>
+#include <stddef.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 Matrix44 d3d_matrix44_perspective(float fov
                                  ,float aspect_ratio
                                  ,float near_plane
@@ -3589,72 +9127,59 @@ void d3d_renderer_cube_instancing_init(RendererCubes*  renderer
                                       )
 {
 
-    renderer->update_colors     = 0;
-    renderer->update_ids        = 0;
-    renderer->update_positions  = 0;
-    renderer->update_transforms = 0;
-    renderer->update_selections = 0;
+    renderer->update_instances = 0;
 
     srand(time(NULL));
 
     /*-------------------Define cube-------------------*/
-    int32_t cube_vertex_count = 36;
+    int32_t cube_index_count = 36;
     float cube_vertices[] = 
 {
-     // Front Face
-    -0.5, -0.5, -0.5,   0, 0, -1,   // Vertex 1 + Normal
-     0.5, -0.5, -0.5,   0, 0, -1,   // Vertex 2 + Normal
-     0.5,  0.5, -0.5,   0, 0, -1,   // Vertex 3 + Normal
-
-    -0.5, -0.5, -0.5,   0, 0, -1,   // Vertex 1 + Normal
+    // Front Face
+    -0.5, -0.5, -0.5,   0, 0, -1,   // Vertex 0 + Normal
+     0.5, -0.5, -0.5,   0, 0, -1,   // Vertex 1 + Normal
      0.5,  0.5, -0.5,   0, 0, -1,   // Vertex 2 + Normal
     -0.5,  0.5, -0.5,   0, 0, -1,   // Vertex 3 + Normal
 
     // Back Face
-    -0.5, -0.5,  0.5,   0, 0, 1,    // Vertex 1 + Normal
-     0.5, -0.5,  0.5,   0, 0, 1,    // Vertex 2 + Normal
-     0.5,  0.5,  0.5,   0, 0, 1,    // Vertex 3 + Normal
-
-    -0.5, -0.5,  0.5,   0, 0, 1,    // Vertex 1 + Normal
-     0.5,  0.5,  0.5,   0, 0, 1,    // Vertex 2 + Normal
-    -0.5,  0.5,  0.5,   0, 0, 1,    // Vertex 3 + Normal
+    -0.5, -0.5,  0.5,   0, 0, 1,    // Vertex 4 + Normal
+     0.5, -0.5,  0.5,   0, 0, 1,    // Vertex 5 + Normal
+     0.5,  0.5,  0.5,   0, 0, 1,    // Vertex 6 + Normal
+    -0.5,  0.5,  0.5,   0, 0, 1,    // Vertex 7 + Normal
 
     // Left Face
-    -0.5, -0.5, -0.5,  -1, 0, 0,     // Vertex 1 + Normal
-    -0.5, -0.5,  0.5,  -1, 0, 0,     // Vertex 2 + Normal
-    -0.5,  0.5,  0.5,  -1, 0, 0,     // Vertex 3 + Normal
-
-    -0.5, -0.5, -0.5,  -1, 0, 0,     // Vertex 1 + Normal
-    -0.5,  0.5,  0.5,  -1, 0, 0,     // Vertex 2 + Normal
-    -0.5,  0.5, -0.5,  -1, 0, 0,     // Vertex 3 + Normal
+    -0.5, -0.5, -0.5,  -1, 0, 0,    // Vertex 8 + Normal
+    -0.5, -0.5,  0.5,  -1, 0, 0,    // Vertex 9 + Normal
+    -0.5,  0.5,  0.5,  -1, 0, 0,    // Vertex 10 + Normal
+    -0.5,  0.5, -0.5,  -1, 0, 0,    // Vertex 11 + Normal
 
     // Right Face
-     0.5, -0.5, -0.5,   1, 0, 0,     // Vertex 1 + Normal
-     0.5, -0.5,  0.5,   1, 0, 0,     // Vertex 2 + Normal
-     0.5,  0.5,  0.5,   1, 0, 0,     // Vertex 3 + Normal
-
-     0.5, -0.5, -0.5,   1, 0, 0,     // Vertex 1 + Normal
-     0.5,  0.5,  0.5,   1, 0, 0,     // Vertex 2 + Normal
-     0.5,  0.5, -0.5,   1, 0, 0,     // Vertex 3 + Normal
+     0.5, -0.5, -0.5,   1, 0, 0,    // Vertex 12 + Normal
+     0.5, -0.5,  0.5,   1, 0, 0,    // Vertex 13 + Normal
+     0.5,  0.5,  0.5,   1, 0, 0,    // Vertex 14 + Normal
+     0.5,  0.5, -0.5,   1, 0, 0,    // Vertex 15 + Normal
 
     // Top Face
-    -0.5,  0.5, -0.5,   0, 1, 0,     // Vertex 1 + Normal
-     0.5,  0.5, -0.5,   0, 1, 0,     // Vertex 2 + Normal
-     0.5,  0.5,  0.5,   0, 1, 0,     // Vertex 3 + Normal
-
-    -0.5,  0.5, -0.5,   0, 1, 0,     // Vertex 1 + Normal
-     0.5,  0.5,  0.5,   0, 1, 0,     // Vertex 2 + Normal
-    -0.5,  0.5,  0.5,   0, 1, 0,     // Vertex 3 + Normal
+    -0.5,  0.5, -0.5,   0, 1, 0,    // Vertex 16 + Normal
+     0.5,  0.5, -0.5,   0, 1, 0,    // Vertex 17 + Normal
+     0.5,  0.5,  0.5,   0, 1, 0,    // Vertex 18 + Normal
+    -0.5,  0.5,  0.5,   0, 1, 0,    // Vertex 19 + Normal
 
     // Bottom Face
-    -0.5, -0.5, -0.5,   0, -1, 0,    // Vertex 1 + Normal
-     0.5, -0.5, -0.5,   0, -1, 0,    // Vertex 2 + Normal
-     0.5, -0.5,  0.5,   0, -1, 0,    // Vertex 3 + Normal
-
-    -0.5, -0.5, -0.5,   0, -1, 0,    // Vertex 1 + Normal
-     0.5, -0.5,  0.5,   0, -1, 0,    // Vertex 2 + Normal
-    -0.5, -0.5,  0.5,   0, -1, 0     // Vertex 3 + Normal
+    -0.5, -0.5, -0.5,   0, -1, 0,   // Vertex 20 + Normal
+     0.5, -0.5, -0.5,   0, -1, 0,   // Vertex 21 + Normal
+     0.5, -0.5,  0.5,   0, -1, 0,   // Vertex 22 + Normal
+    -0.5, -0.5,  0.5,   0, -1, 0    // Vertex 23 + Normal
 };
+    GLushort cube_indices[] =
+    {
+         0,  1,  2,    0,  2,  3,   // Front Face
+         4,  5,  6,    4,  6,  7,   // Back Face
+         8,  9, 10,    8, 10, 11,   // Left Face
+        12, 13, 14,   12, 14, 15,   // Right Face
+        16, 17, 18,   16, 18, 19,   // Top Face
+        20, 21, 22,   20, 22, 23    // Bottom Face
+    };
     /*-------------------Define cube-------------------*/
 
     /*--------------Create vertex buffers--------------*/
@@ -3689,55 +9214,78 @@ void d3d_renderer_cube_instancing_init(RendererCubes*  renderer
 
     glGenBuffers(1, &renderer->vbo);
     glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
 
-    glGenVertexArrays(1, &renderer->vao);
-    glBindVertexArray(renderer->vao);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);                   
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); 
-    glEnableVertexAttribArray(1);
+    glGenBuffers(1, &renderer->ebo);
+    glGenVertexArrays(DELO_CUBE_FRAME_SLOTS, &renderer->vao[0]);
+    glGenBuffers(DELO_CUBE_FRAME_SLOTS, &renderer->vbo_instances[0]);
 
-    glGenBuffers(1, &renderer->vbo_instance_positions);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_positions);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(2);
-    glVertexAttribDivisor(2, 1);
+    // One instance buffer and VAO per frame slot, the CPU fills slot N+1 while the GPU still reads slot N.
+    for (int32_t i = 0; i < DELO_CUBE_FRAME_SLOTS; i++)
+    {
+        glBindVertexArray(renderer->vao[i]);
 
-    glGenBuffers(1, &renderer->vbo_instance_colors);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_colors);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(3);
-    glVertexAttribDivisor(3, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);                   
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); 
+        glEnableVertexAttribArray(1);
 
-    glGenBuffers(1, &renderer->vbo_instance_transforms);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_transforms);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->ebo);
+        if (i == 0)
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
+        }
 
-    for (int32_t i = 0; i < 4; i++) 
-    {
-        glEnableVertexAttribArray(4 + i);
-        glVertexAttribPointer(4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4 * 4, (void*)(sizeof(float) * 4 * i));
-        glVertexAttribDivisor(4 + i, 1);
-    }
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instances[i]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(CubeInstance) * instance_count, NULL, GL_DYNAMIC_DRAW);
 
-    glGenBuffers(1, &renderer->vbo_instance_ids);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_ids);
-    glVertexAttribPointer(8, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(8);
-    glVertexAttribDivisor(8, 1);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, position));
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
 
-    glGenBuffers(1, &renderer->vbo_instance_selected);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_selected);
-    glVertexAttribIPointer(9, 1, GL_INT, sizeof(GLint), (void*)0);
-    glEnableVertexAttribArray(9);
-    glVertexAttribDivisor(9, 1);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, scale));
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+
+        glVertexAttribPointer(4, 4, GL_SHORT, GL_TRUE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, rotation));
+        glEnableVertexAttribArray(4);
+        glVertexAttribDivisor(4, 1);
+
+        glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, color));
+        glEnableVertexAttribArray(5);
+        glVertexAttribDivisor(5, 1);
+
+        glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, sizeof(CubeInstance), (void*)offsetof(CubeInstance, flags));
+        glEnableVertexAttribArray(6);
+        glVertexAttribDivisor(6, 1);
+
+        renderer->fences[i]      = NULL;
+        renderer->dirty_first[i] = UINT32_MAX;
+        renderer->dirty_last[i]  = 0;
+    }
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     /*--------------Create vertex buffers--------------*/
 
-    renderer->fence = NULL;
+    renderer->mesh.vertices        = NULL;
+    renderer->mesh.vertices_length = 0;
+    renderer->mesh.vertex_count    = cube_index_count;
 
+    renderer->slot           = 0;
+    renderer->slot_acquired  = 0;
+    renderer->stall_count    = 0;
+    renderer->instance_count = 0;
+
+    renderer->capacity      = instance_count;
+    renderer->visible_count = 0;
+    renderer->culled_count  = 0;
+    renderer->culling       = 0;
+
+    renderer->instances         = NULL;
+    renderer->visible_instances = malloc(sizeof(CubeInstance) * instance_count);
 }
 void d3d_renderer_cube_instancing_apply_shader(RendererCubes* renderer
                                               ,uint32_t       shader
@@ -3750,103 +9298,328 @@ void d3d_renderer_cube_instancing_apply_shader(RendererCubes* renderer
     renderer->uniform_location_view       = glGetUniformLocation(renderer->shader, "view"      );
     renderer->uniform_location_projection = glGetUniformLocation(renderer->shader, "projection");
     renderer->uniform_location_mode       = glGetUniformLocation(renderer->shader, "mode");
+    renderer->uniform_location_compacted  = glGetUniformLocation(renderer->shader, "compacted");
     
     glUniformMatrix4fv(renderer->uniform_location_projection, 1, GL_FALSE, projection_matrix);
-
+    memcpy(renderer->projection_matrix, projection_matrix, sizeof(GLfloat) * 16);
     
     glUseProgram(0);
 }
 void d3d_renderer_cube_instancing_update(RendererCubes* renderer
-                                        ,GLfloat*       instance_positions
-                                        ,GLfloat*       instance_transforms
-                                        ,GLfloat*       instance_colors
-                                        ,GLfloat*       instance_ids
-                                        ,GLint*         instance_selected
+                                        ,CubeInstance*  instances
                                         ,int32_t        instance_count
                                         )
 {
-    
-    
-    if(renderer->update_positions)
+    if(instance_count > (int32_t)renderer->capacity)
+    {
+        instance_count = renderer->capacity;
+    }
+
+    if(instances != renderer->instances || (uint32_t)instance_count != renderer->instance_count)
+    {
+        // The old ranges describe the previous array, so every slot is refilled from the new one.
+        for (int32_t i = 0; i < DELO_CUBE_FRAME_SLOTS; i++)
+        {
+            renderer->dirty_first[i] = 0;
+            renderer->dirty_last[i]  = instance_count;
+        }
+    }
+
+    renderer->instances      = instances;
+    renderer->instance_count = instance_count;
+
+    if(renderer->update_instances)
     {
-        renderer->update_positions = 0;
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_positions);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * instance_count * 3, instance_positions, GL_DYNAMIC_DRAW);
-        renderer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        renderer->update_instances = 0;
+        d3d_renderer_cube_instancing_mark_dirty(renderer, 0, instance_count);
     }
-    if(renderer->update_transforms)
+}
+void d3d_renderer_cube_instancing_mark_dirty(RendererCubes* renderer
+                                            ,uint32_t       first
+                                            ,uint32_t       count
+                                            )
+{
+    uint32_t last = first + count;
+
+    if(last > renderer->capacity)
     {
-        renderer->update_transforms = 0;
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_transforms);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*instance_count * 16, instance_transforms, GL_DYNAMIC_DRAW);
-        renderer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        last = renderer->capacity;
     }
-    if(renderer->update_colors)
+
+    // Every slot holds its own copy, so a change has to reach all of them before it is drawn from that slot.
+    for (int32_t i = 0; i < DELO_CUBE_FRAME_SLOTS; i++)
     {
-        renderer->update_colors = 0;
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_colors);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * instance_count * 3, instance_colors, GL_DYNAMIC_DRAW);
-        renderer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        renderer->dirty_first[i] = (first < renderer->dirty_first[i]) ? first : renderer->dirty_first[i];
+        renderer->dirty_last[i]  = (last  > renderer->dirty_last[i])  ? last  : renderer->dirty_last[i];
     }
-    if(renderer->update_ids)
+}
+void d3d_renderer_cube_instancing_acquire_slot(RendererCubes* renderer)
+{
+    if(renderer->slot_acquired)
     {
-        renderer->update_ids = 0;
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_ids);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * instance_count * 3, instance_ids, GL_DYNAMIC_DRAW);
-        renderer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return;
     }
 
-    if(renderer->update_selections)
+    GLsync fence = renderer->fences[renderer->slot];
+
+    if(fence != NULL)
     {
-        renderer->update_selections = 0;
-        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instance_selected);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLint) * instance_count, instance_selected, GL_DYNAMIC_DRAW);
-        renderer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Only blocks when the GPU is a full ring of frames behind.
+        GLenum result = glClientWaitSync(fence, 0, 0);
+
+        if(result == GL_TIMEOUT_EXPIRED)
+        {
+            renderer->stall_count++;
+
+            do
+            {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } 
+            while (result == GL_TIMEOUT_EXPIRED);
+        }
+
+        glDeleteSync(fence);
+        renderer->fences[renderer->slot] = NULL;
     }
-    glBindBuffer(GL_ARRAY_BUFFER,0);
+
+    renderer->slot_acquired = 1;
 }
 void d3d_renderer_cube_instancing_render(RendererCubes* renderer
                                         ,GLfloat        view_matrix[16]
                                         ,int32_t        instance_count
                                         )
 {
-    if(renderer->fence != NULL)
+    uint8_t compacted = renderer->culling && renderer->instances != NULL;
+    uint8_t slot      = renderer->slot;
+
+    d3d_renderer_cube_instancing_acquire_slot(renderer);
+
+    if(compacted)
+    {
+        instance_count = renderer->visible_count;
+    }
+    else if(renderer->instances != NULL && renderer->dirty_first[slot] < renderer->dirty_last[slot])
     {
-        GLenum result = glClientWaitSync(renderer->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
-        if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        uint32_t first = renderer->dirty_first[slot];
+        uint32_t last  = renderer->dirty_last[slot];
+
+        // The instance array belongs to the caller and may be shorter than the range marked dirty.
+        if(last > renderer->instance_count)
+        {
+            last = renderer->instance_count;
+        }
+
+        if(first < last)
         {
-            glWaitSync(renderer->fence, 0, GL_TIMEOUT_IGNORED);
+            glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instances[slot]);
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(CubeInstance) * first, sizeof(CubeInstance) * (last - first), &renderer->instances[first]);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
-        glDeleteSync(renderer->fence);
-        renderer->fence = NULL;
+
+        renderer->dirty_first[slot] = UINT32_MAX;
+        renderer->dirty_last[slot]  = 0;
     }
 
-    if(renderer->fence == NULL)
-    {
-        glBindVertexArray(renderer->vao);
+    glBindVertexArray(renderer->vao[slot]);
+
+    glUseProgram(renderer->shader);
+
+    glUniformMatrix4fv(renderer->uniform_location_view, 1, GL_FALSE, view_matrix);
+    glUniform1i(renderer->uniform_location_compacted, compacted);
 
-        glUseProgram(renderer->shader);
+    if(renderer->update_depth_buffer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer->fbo_object_picking);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glUniform1i(renderer->uniform_location_mode, 0);
+        glDrawElementsInstanced(GL_TRIANGLES, renderer->mesh.vertex_count, GL_UNSIGNED_SHORT, (void*)0, instance_count);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
     
-        glUniformMatrix4fv(renderer->uniform_location_view, 1, GL_FALSE, view_matrix);
+    glClearColor(0.5f, 0.6f, 0.7f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUniform1i(renderer->uniform_location_mode, 1);
+    glDrawElementsInstanced(GL_TRIANGLES, renderer->mesh.vertex_count, GL_UNSIGNED_SHORT, (void*)0, instance_count);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    renderer->fences[slot]  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    renderer->slot          = (slot + 1) % DELO_CUBE_FRAME_SLOTS;
+    renderer->slot_acquired = 0;
+}
+void d3d_renderer_cube_instancing_cull(RendererCubes* renderer
+                                      ,GLfloat        view_matrix[16]
+                                      ,int32_t        instance_count
+                                      )
+{
+    if(!renderer->culling || renderer->instances == NULL)
+    {
+        return;
+    }
+
+    if(instance_count > (int32_t)renderer->capacity)
+    {
+        instance_count = renderer->capacity;
+    }
+
+    Frustum frustum;
+    d3d_frustum_extract(&frustum, view_matrix, renderer->projection_matrix);
+
+    CubeInstance *instances = renderer->instances;
+    CubeInstance *visible   = renderer->visible_instances;
+    uint32_t      count     = 0;
+    int32_t       i         = 0;
+
+    // Half the diagonal of the unit cube, the bound is rotation invariant so only scale matters.
+    const float half_diagonal = 0.866025f;
 
-        if(renderer->update_depth_buffer)
+#if defined(__SSE__)
+    for (; i + 4 <= instance_count; i += 4)
+    {
+        CubeInstance *c = &instances[i];
+
+        __m128 cx = _mm_set_ps(c[3].position[0], c[2].position[0], c[1].position[0], c[0].position[0]);
+        __m128 cy = _mm_set_ps(c[3].position[1], c[2].position[1], c[1].position[1], c[0].position[1]);
+        __m128 cz = _mm_set_ps(c[3].position[2], c[2].position[2], c[1].position[2], c[0].position[2]);
+        __m128 nr = _mm_mul_ps(_mm_set_ps(c[3].scale, c[2].scale, c[1].scale, c[0].scale), _mm_set1_ps(-half_diagonal));
+
+        __m128 outside = _mm_setzero_ps();
+
+        for (int32_t j = 0; j < 6; j++)
         {
-            glBindFramebuffer(GL_FRAMEBUFFER, renderer->fbo_object_picking);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glUniform1i(renderer->uniform_location_mode, 0);
-            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instance_count);
+            Vector4f *plane = &frustum.planes[j];
+
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane->x))
+                                            ,_mm_mul_ps(cy, _mm_set1_ps(plane->y)))
+                                 ,_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane->z))
+                                            ,_mm_set1_ps(plane->w)));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, nr));
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        
-        glClearColor(0.5f, 0.6f, 0.7f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glUniform1i(renderer->uniform_location_mode, 1);
-        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instance_count);
 
-        glBindVertexArray(0);
-        glUseProgram(0);
+        int32_t mask = _mm_movemask_ps(outside);
+
+        for (int32_t k = 0; k < 4; k++)
+        {
+            if (!((mask >> k) & 1))
+            {
+                visible[count]        = c[k];
+                visible[count].flags  = (c[k].flags & ((1 << DELO_CUBE_ID_SHIFT) - 1)) | ((uint32_t)(i + k) << DELO_CUBE_ID_SHIFT);
+                count++;
+            }
+        }
+    }
+#endif
+    for (; i < instance_count; i++)
+    {
+        CubeInstance *c = &instances[i];
+        Vector3f center = {c->position[0], c->position[1], c->position[2]};
+
+        if (d3d_frustum_test_sphere(&frustum, center, c->scale * half_diagonal))
+        {
+            visible[count]       = *c;
+            visible[count].flags = (c->flags & ((1 << DELO_CUBE_ID_SHIFT) - 1)) | ((uint32_t)i << DELO_CUBE_ID_SHIFT);
+            count++;
+        }
+    }
+
+    renderer->visible_count = count;
+    renderer->culled_count  = instance_count - count;
+
+    uint8_t slot = renderer->slot;
+
+    d3d_renderer_cube_instancing_acquire_slot(renderer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo_instances[slot]);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CubeInstance) * count, visible);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The compacted stream overwrote this slot, it needs a full refresh if culling is switched off.
+    renderer->dirty_first[slot] = 0;
+    renderer->dirty_last[slot]  = instance_count;
+}
+void d3d_cube_instance_define(CubeInstance* instance
+                             ,Vector3f      position
+                             ,Vector4f      rotation
+                             ,float         scale
+                             ,Color         color
+                             )
+{
+    instance->position[0] = position.x;
+    instance->position[1] = position.y;
+    instance->position[2] = position.z;
+    instance->scale       = scale;
+
+    instance->rotation[0] = (int16_t)(rotation.x * 32767.0f);
+    instance->rotation[1] = (int16_t)(rotation.y * 32767.0f);
+    instance->rotation[2] = (int16_t)(rotation.z * 32767.0f);
+    instance->rotation[3] = (int16_t)(rotation.w * 32767.0f);
+
+    instance->color = ((uint32_t)(color.r * 255.0f) <<  0)
+                    | ((uint32_t)(color.g * 255.0f) <<  8)
+                    | ((uint32_t)(color.b * 255.0f) << 16)
+                    | ((uint32_t)(color.a * 255.0f) << 24);
+
+    instance->flags = 0;
+}
+// ================================
+// Frustum functions
+// ================================
+void d3d_frustum_extract(Frustum* frustum
+                        ,GLfloat  view_matrix[16]
+                        ,GLfloat  projection_matrix[16]
+                        )
+{
+    Matrix44 view;
+    Matrix44 projection;
+
+    memcpy(&view,       view_matrix,       sizeof(Matrix44));
+    memcpy(&projection, projection_matrix, sizeof(Matrix44));
+
+    Matrix44 m = d2d_matrix44_multiply(projection, view);
+
+    Vector4f row_0 = {m.x11, m.x12, m.x13, m.x14};
+    Vector4f row_1 = {m.x21, m.x22, m.x23, m.x24};
+    Vector4f row_2 = {m.x31, m.x32, m.x33, m.x34};
+    Vector4f row_3 = {m.x41, m.x42, m.x43, m.x44};
+
+    frustum->planes[0] = (Vector4f){row_3.x + row_0.x, row_3.y + row_0.y, row_3.z + row_0.z, row_3.w + row_0.w}; // left
+    frustum->planes[1] = (Vector4f){row_3.x - row_0.x, row_3.y - row_0.y, row_3.z - row_0.z, row_3.w - row_0.w}; // right
+    frustum->planes[2] = (Vector4f){row_3.x + row_1.x, row_3.y + row_1.y, row_3.z + row_1.z, row_3.w + row_1.w}; // bottom
+    frustum->planes[3] = (Vector4f){row_3.x - row_1.x, row_3.y - row_1.y, row_3.z - row_1.z, row_3.w - row_1.w}; // top
+    frustum->planes[4] = (Vector4f){row_3.x + row_2.x, row_3.y + row_2.y, row_3.z + row_2.z, row_3.w + row_2.w}; // near
+    frustum->planes[5] = (Vector4f){row_3.x - row_2.x, row_3.y - row_2.y, row_3.z - row_2.z, row_3.w - row_2.w}; // far
+
+    for (int32_t i = 0; i < 6; i++)
+    {
+        Vector4f *plane = &frustum->planes[i];
+        float length = sqrtf(plane->x * plane->x + plane->y * plane->y + plane->z * plane->z);
+
+        if (length > 0.0f)
+        {
+            plane->x /= length;
+            plane->y /= length;
+            plane->z /= length;
+            plane->w /= length;
+        }
     }
+}
+uint8_t d3d_frustum_test_sphere(Frustum* frustum
+                               ,Vector3f center
+                               ,float    radius
+                               )
+{
+    for (int32_t i = 0; i < 6; i++)
+    {
+        Vector4f *plane = &frustum->planes[i];
 
+        if (plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w < -radius)
+        {
+            return 0;
+        }
+    }
+    return 1;
 }
 Color d3d_generate_pick_color(int index) 
 {
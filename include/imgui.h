@@ -12,17 +12,82 @@
 
 #define UNIQUE_ID __LINE__
 
+#define IMGUI_DRAW_LIST_VERTICES 16384
+#define IMGUI_DRAW_LIST_INDICES  24576
+#define IMGUI_DRAW_LIST_COMMANDS 256
+#define IMGUI_DRAW_LIST_MAX      65536
+
+#define IMGUI_LIST_SCROLL_BAR_WIDTH 16
+#define IMGUI_LIST_SCROLL_STEP      48
+#define IMGUI_LIST_SCROLL_SMOOTHING 15
+
+#define IMGUI_PLOT_ZOOM_STEP 1.2f
+#define IMGUI_PLOT_CHUNK     1024
+
+#define IMGUI_MODE_SOLID 0
+#define IMGUI_MODE_FONT  1
+#define IMGUI_MODE_SDF   2
+#define IMGUI_MODE_IMAGE 3
+
+typedef struct ImGuiVertex ImGuiVertex;
+struct ImGuiVertex
+{
+    Vector2f position;
+    Vector2f uv;
+    Color    color;
+    float    mode;
+};
+typedef struct ImGuiDrawCommand ImGuiDrawCommand;
+struct ImGuiDrawCommand
+{
+    uint32_t    first;
+    uint32_t    count;
+    uint32_t    texture;
+    Rectangle_f clip;
+    uint8_t     clipped;
+};
+typedef struct ImGuiDrawList ImGuiDrawList;
+struct ImGuiDrawList
+{
+    ImGuiVertex*      vertices;
+    uint16_t*         indices;
+    ImGuiDrawCommand* commands;
+    uint32_t          vertex_count;
+    uint32_t          index_count;
+    uint32_t          command_count;
+    uint32_t          draw_calls;
+    uint32_t          rejected;
+    uint32_t          vertex_capacity;
+    uint32_t          index_capacity;
+    uint32_t          command_capacity;
+    uint32_t          buffer_capacity;
+    RendererOverflow  overflow;
+    ImGuiVertex*      vertices_prev;
+    uint16_t*         indices_prev;
+    ImGuiDrawCommand* commands_prev;
+    uint32_t          vertex_count_prev;
+    uint32_t          index_count_prev;
+    uint32_t          command_count_prev;
+    uint64_t          hash;
+    Matrix44          projection;
+    GLuint            vao;
+    GLuint            vbo;
+    GLuint            ebo;
+    GLuint            shader;
+    GLint             uniform_location_u_mvp;
+    GLint             uniform_location_u_texture;
+};
 typedef struct ImGui ImGui;
 struct ImGui
 {
     GLFWwindow *window;
+    D2DContext *context;
     HidState *hid_state;
     HidState *hid_state_prev;
 
-    RendererSpriteFont renderer_sprite_font;            
-    RendererPrimitive renderer_primitive_fills;   
-    RendererPrimitive renderer_primitive_outlines;
-    RendererSprite renderer_sprites;
+    ImGuiDrawList draw_list;
+    uint32_t* shader;
+    TextCache* text_cache;
     SpriteFont* font;
     
 
@@ -86,6 +151,51 @@ struct TabBarEvent
     uint8_t index;
 };
 
+typedef struct ListEvent ListEvent;
+struct ListEvent
+{
+    uint8_t changed;
+    int32_t index;
+};
+typedef struct ImGuiListRow ImGuiListRow;
+struct ImGuiListRow
+{
+    char*   caption;
+    uint8_t selected;
+};
+typedef void (*ImGuiListRowFn)(void* user_data, uint32_t index, ImGuiListRow* row);
+
+typedef struct ImGuiList ImGuiList;
+struct ImGuiList
+{
+    float*   heights;
+    float*   tree;
+    uint32_t count;
+    float    scroll;
+    float    scroll_target;
+    int32_t  cursor;
+    uint8_t  hold_scroll_bar;
+    float    scroll_bar_delta_y;
+};
+
+typedef struct PlotEvent PlotEvent;
+struct PlotEvent
+{
+    uint8_t changed;
+};
+typedef struct ImGuiPlot ImGuiPlot;
+struct ImGuiPlot
+{
+    float   x_min;
+    float   x_max;
+    float   y_min;
+    float   y_max;
+    uint8_t fit_y;
+    uint8_t follow;
+    uint8_t dragging;
+    float   drag_x;
+};
+
 typedef struct DatePickerEvent DatePickerEvent;
 struct DatePickerEvent
 {
@@ -96,14 +206,36 @@ struct DatePickerEvent
 };
 #if defined(IMGUI_FUNCTION_SIGNATURES) || defined(IMGUI_IMPLEMENTATION)
 
-void imgui_init(ImGui* imgui,D2DContext* context,HidState* hid_state,HidState* hid_state_prev,SpriteFont* font,uint32_t shader_primitive,uint32_t shader_sprite_font,uint32_t shader_sprite);
+void imgui_init(ImGui* imgui,D2DContext* context,HidState* hid_state,HidState* hid_state_prev,SpriteFont* font,uint32_t* shader);
 void imgui_begin(ImGui* imgui,char* char_buffer,uint8_t char_buffer_length);
 void imgui_end(ImGui* imgui);
+void imgui_render(ImGui* imgui);
+int8_t imgui_push_clip(ImGui* imgui,Rectangle_f rect);
+void imgui_pop_clip(ImGui* imgui);
+void imgui_draw_list_init(ImGuiDrawList* draw_list,D2DContext* context);
+void imgui_draw_list_apply_shader(ImGuiDrawList* draw_list,uint32_t shader);
+void imgui_draw_list_clear(ImGuiDrawList* draw_list);
+void imgui_draw_list_render(ImGuiDrawList* draw_list,D2DContext* context);
+void imgui_draw_list_damage(ImGuiDrawList* draw_list,D2DContext* context);
+void imgui_draw_rectangle(ImGui* imgui,Rectangle_f rect,Color color);
+void imgui_draw_rectangle_outline(ImGui* imgui,Rectangle_f rect,Color color);
+void imgui_draw_line(ImGui* imgui,Vector2f a,Vector2f b,Color color,float thickness);
+void imgui_draw_triangle(ImGui* imgui,Vector2f a,Vector2f b,Vector2f c,Color color);
+void imgui_draw_sprite(ImGui* imgui,Rectangle_f dest,Rectangle_f src,Texture* texture,Color color);
+void imgui_draw_text(ImGui* imgui,SpriteFont* font,char* text,uint32_t max_length,Vector2f position,Color color);
 ButtonEvent imgui_button(Rectangle_f rect,char* caption,ImGui* imgui);
 SliderEvent imgui_slider(ImGui* imgui,int32_t id,Rectangle_f rect_bounds,Rectangle_f rect_knob,int32_t min,int32_t max,int32_t* value);
 uint8_t imgui_tswitch(ImGui* imgui,int32_t id,Rectangle_f rect_bounds,uint8_t* value,char* text_on,char* text_off);
 uint8_t lol2(Rectangle_f *rect, float min, float max);
 DropdownEvent imgui_dropdown(ImGui* imgui,int32_t id,Rectangle_f rect_header,char* captions,uint8_t* selections,uint16_t children_count,uint16_t stride);
+int8_t imgui_list_init(ImGuiList* list,uint32_t count,float row_height);
+void imgui_list_free(ImGuiList* list);
+void imgui_list_set_row_height(ImGuiList* list,uint32_t index,float height);
+float imgui_list_row_offset(ImGuiList* list,uint32_t index);
+uint32_t imgui_list_row_at(ImGuiList* list,float offset);
+ListEvent imgui_list(ImGui* imgui,int32_t id,Rectangle_f rect_bounds,ImGuiList* list,ImGuiListRowFn row_fn,void* user_data);
+void imgui_plot_init(ImGuiPlot* plot,float x_min,float x_max);
+PlotEvent imgui_plot(ImGui* imgui,int32_t id,Rectangle_f rect_bounds,ImGuiPlot* plot,PlotSeries* series,uint32_t series_count,Color* colors);
 void imgui_textbox_insert(char* buffer_source,uint16_t* caret,uint16_t* length,const char* buffer_input,uint16_t buffer_input_length);
 void imgui_textbox_remove(char *buffer_source, uint16_t *caret, uint16_t *length);
 void imgui_textbox_remove_segment(char *buffer_source, uint16_t *caret, uint16_t *length, uint16_t segment_start, uint16_t segment_end);
@@ -124,27 +256,16 @@ void imgui_init(ImGui*          imgui
                       ,HidState*       hid_state
                       ,HidState*       hid_state_prev
                       ,SpriteFont*     font
-                      ,uint32_t        shader_primitive
-                      ,uint32_t        shader_sprite_font
-                      ,uint32_t        shader_sprite
+                      ,uint32_t*       shader
                       )
 {
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    RendererSprite *renderer_sprite = &imgui->renderer_sprites;
-
-    d2d_renderer_sprite_font_init(renderer_sprite_font, context, 1000);
-    d2d_renderer_primitive_init(renderer_primitive_fills, 1000, context);
-    d2d_renderer_primitive_init(renderer_primitive_outlines, 1000, context);
-    d2d_renderer_sprite_init(renderer_sprite, 16, context);
-
-    d2d_renderer_primitive_apply_shader(renderer_primitive_fills, shader_primitive);
-    d2d_renderer_primitive_apply_shader(renderer_primitive_outlines, shader_primitive);
-    d2d_renderer_sprite_font_apply_shader(renderer_sprite_font, shader_sprite_font);
-    d2d_renderer_sprite_apply_shader(renderer_sprite,shader_sprite);
+    imgui_draw_list_init(&imgui->draw_list, context);
+    imgui_draw_list_apply_shader(&imgui->draw_list, *shader);
 
+    imgui->shader = shader;
+    imgui->text_cache = NULL;
     imgui->window = context->window;
+    imgui->context = context;
     imgui->hid_state = hid_state;
     imgui->hid_state_prev = hid_state_prev;
     imgui->font = font;
@@ -175,15 +296,13 @@ void imgui_begin(ImGui*  imgui
                        ,uint8_t char_buffer_length
                        )
 {
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    RendererSprite *renderer_sprites = &imgui->renderer_sprites;
+    // The shader may have been swapped by a hot reload since the last frame.
+    if (*imgui->shader != imgui->draw_list.shader)
+    {
+        imgui_draw_list_apply_shader(&imgui->draw_list, *imgui->shader);
+    }
 
-    d2d_renderer_primitive_begin(renderer_primitive_fills, NULL,NULL, DELO_TRIANGLE_LIST);
-    d2d_renderer_primitive_begin(renderer_primitive_outlines, NULL,NULL, DELO_LINE_LIST);
-    d2d_renderer_sprite_font_begin(renderer_sprite_font, renderer_sprite_font->projection);
-    d2d_renderer_sprite_begin(renderer_sprites, renderer_sprites->projection);
+    imgui_draw_list_clear(&imgui->draw_list);
 
     imgui->char_buffer = char_buffer;
     imgui->char_buffer_length = char_buffer_length;
@@ -191,508 +310,1754 @@ void imgui_begin(ImGui*  imgui
 }
 void imgui_end(ImGui* imgui)
 {
-    d2d_renderer_primitive_end(&imgui->renderer_primitive_fills);
-    d2d_renderer_primitive_end(&imgui->renderer_primitive_outlines);
-    d2d_renderer_sprite_font_end(&imgui->renderer_sprite_font);
-    d2d_renderer_sprite_end(&imgui->renderer_sprites);
+    // Reactive frames draw later, once d2d_frame_begin knows whether anything changed.
+    if (imgui->context->reactive.enabled)
+    {
+        imgui_draw_list_damage(&imgui->draw_list, imgui->context);
+        return;
+    }
+
+    imgui_draw_list_render(&imgui->draw_list, imgui->context);
+}
+void imgui_render(ImGui* imgui)
+{
+    imgui_draw_list_render(&imgui->draw_list, imgui->context);
 }
-ButtonEvent imgui_button(Rectangle_f rect
-                               ,char*       caption
-                               ,ImGui*      imgui
-                               )
+int8_t imgui_push_clip(ImGui*      imgui
+                      ,Rectangle_f rect
+                      )
 {
-    ButtonEvent event = {0, 0};
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    SpriteFont *font = imgui->font;
-
-    float mouse_position_x = imgui->hid_state->mouse_position_x;
-    float mouse_position_y = imgui->hid_state->mouse_position_y;
+    return d2d_clip_push(imgui->context, rect);
+}
+void imgui_pop_clip(ImGui* imgui)
+{
+    d2d_clip_pop(imgui->context);
+}
+void imgui_draw_list_init(ImGuiDrawList* draw_list
+                         ,D2DContext*    context
+                         )
+{
+    draw_list->vertices = malloc(sizeof(ImGuiVertex) * IMGUI_DRAW_LIST_VERTICES);
+    draw_list->indices  = malloc(sizeof(uint16_t) * IMGUI_DRAW_LIST_INDICES);
+    draw_list->commands = malloc(sizeof(ImGuiDrawCommand) * IMGUI_DRAW_LIST_COMMANDS);
+
+    draw_list->vertices_prev = malloc(sizeof(ImGuiVertex) * IMGUI_DRAW_LIST_VERTICES);
+    draw_list->indices_prev  = malloc(sizeof(uint16_t) * IMGUI_DRAW_LIST_INDICES);
+    draw_list->commands_prev = malloc(sizeof(ImGuiDrawCommand) * IMGUI_DRAW_LIST_COMMANDS);
+
+    draw_list->vertex_capacity  = IMGUI_DRAW_LIST_VERTICES;
+    draw_list->index_capacity   = IMGUI_DRAW_LIST_INDICES;
+    draw_list->command_capacity = IMGUI_DRAW_LIST_COMMANDS;
+    draw_list->buffer_capacity  = IMGUI_DRAW_LIST_VERTICES;
+
+    // 16 bit indices reach at most IMGUI_DRAW_LIST_MAX vertices per draw.
+    draw_list->overflow.stats = (RendererStats){0};
+    d2d_renderer_overflow(&draw_list->overflow, DELO_RENDERER_GROW, IMGUI_DRAW_LIST_MAX);
+
+    draw_list->vertex_count_prev  = 0;
+    draw_list->index_count_prev   = 0;
+    draw_list->command_count_prev = 0;
+    draw_list->hash               = 0;
+
+    glGenVertexArrays(1, &draw_list->vao);
+    glBindVertexArray(draw_list->vao);
+
+    glGenBuffers(1, &draw_list->vbo);
+    glGenBuffers(1, &draw_list->ebo);
+
+    glBindBuffer(GL_ARRAY_BUFFER, draw_list->vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(ImGuiVertex) * IMGUI_DRAW_LIST_VERTICES, NULL, GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, draw_list->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * IMGUI_DRAW_LIST_INDICES, NULL, GL_DYNAMIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ImGuiVertex), (void *)offsetof(ImGuiVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ImGuiVertex), (void *)offsetof(ImGuiVertex, uv));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ImGuiVertex), (void *)offsetof(ImGuiVertex, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(ImGuiVertex), (void *)offsetof(ImGuiVertex, mode));
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+
+    draw_list->projection = d2d_matrix44_orthographic_projection((float)0.0f
+                                                                ,(float)context->back_buffer_width
+                                                                ,(float)0.0f
+                                                                ,(float)context->back_buffer_height
+                                                                ,(float)1
+                                                                ,(float)-1
+                                                                );
+    draw_list->shader     = 0;
+    draw_list->draw_calls = 0;
+
+    imgui_draw_list_clear(draw_list);
+}
+void imgui_draw_list_apply_shader(ImGuiDrawList* draw_list
+                                 ,uint32_t       shader
+                                 )
+{
+    draw_list->shader = shader;
 
-    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
-    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+    glUseProgram(shader);
+    draw_list->uniform_location_u_mvp     = glGetUniformLocation(shader, "u_mvp");
+    draw_list->uniform_location_u_texture = glGetUniformLocation(shader, "u_texture");
+    glUniform1i(draw_list->uniform_location_u_texture, 0);
+    glUseProgram(0);
+}
+void imgui_draw_list_clear(ImGuiDrawList* draw_list)
+{
+    draw_list->vertex_count  = 0;
+    draw_list->index_count   = 0;
+    draw_list->command_count = 0;
+    draw_list->rejected      = 0;
 
-    uint8_t button_state = BUTTON_STATE_NORMAL;
+    draw_list->overflow.stats = (RendererStats){0};
+}
+// Indices keep the initial ratio to the vertex capacity, the previous frame copies grow along for damage tracking.
+static int8_t imgui_draw_list_grow(ImGuiDrawList* draw_list
+                                  ,uint32_t       capacity
+                                  )
+{
+    uint32_t index_capacity = (uint32_t)((uint64_t)capacity * IMGUI_DRAW_LIST_INDICES / IMGUI_DRAW_LIST_VERTICES);
 
-    if (d2d_rectangle_within_bounds(&rect, mouse_position_x, mouse_position_y))
+    if (d2d_renderer_grow_array((void **)&draw_list->vertices, sizeof(ImGuiVertex), capacity) == DELO_ERROR
+     || d2d_renderer_grow_array((void **)&draw_list->indices, sizeof(uint16_t), index_capacity) == DELO_ERROR
+     || d2d_renderer_grow_array((void **)&draw_list->vertices_prev, sizeof(ImGuiVertex), capacity) == DELO_ERROR
+     || d2d_renderer_grow_array((void **)&draw_list->indices_prev, sizeof(uint16_t), index_capacity) == DELO_ERROR)
     {
-        button_state = (mouse_button_left == GLFW_PRESS) ? BUTTON_STATE_ACTIVE : BUTTON_STATE_HOVER;
-        if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE)
-        {
-            event.clicked = 1;
-        }
-        event.hover = 1;
+        return DELO_ERROR;
     }
 
-    Color color_fill, color_outline, color_text;
+    draw_list->vertex_capacity = capacity;
+    draw_list->index_capacity  = index_capacity;
 
-    switch (button_state)
+    return DELO_SUCCESS;
+}
+// Commands do not index vertices, so they double on their own up to DELO_RENDERER_CAPACITY_MAX.
+static int8_t imgui_draw_list_grow_commands(ImGuiDrawList* draw_list)
+{
+    uint32_t capacity = draw_list->command_capacity * 2;
+
+    if (draw_list->overflow.mode != DELO_RENDERER_GROW || capacity > DELO_RENDERER_CAPACITY_MAX
+     || d2d_renderer_grow_array((void **)&draw_list->commands, sizeof(ImGuiDrawCommand), capacity) == DELO_ERROR
+     || d2d_renderer_grow_array((void **)&draw_list->commands_prev, sizeof(ImGuiDrawCommand), capacity) == DELO_ERROR)
     {
-    case BUTTON_STATE_NORMAL:
-        d2d_color_set_i(&color_fill, 50, 64, 91, 255);
-        d2d_color_set_i(&color_outline, 77 * 0.5, 99 * 0.5, 140 * 0.5, 255);
-        break;
-    case BUTTON_STATE_HOVER:
-        d2d_color_set_i(&color_fill, 50 * 1.1, 64 * 1.1, 91 * 1.1, 255);
-        d2d_color_set_i(&color_outline, 77 * 1.0, 99 * 1.0, 140 * 1.0, 255);
-        break;
-    case BUTTON_STATE_ACTIVE:
-        d2d_color_set_i(&color_fill, 50 * 1.3, 64 * 1.3, 91 * 1.3, 255);
-        d2d_color_set_i(&color_outline, 77 * 1.5, 99 * 1.5, 140 * 1.5, 255);
-        break;
+        return DELO_ERROR;
     }
 
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect, color_fill);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect, color_outline);
+    draw_list->command_capacity = capacity;
 
-    FontMeasurement measurement;
-    d2d_sprite_font_measure_string(caption, font, &measurement, -1, -1);
+    return DELO_SUCCESS;
+}
+static uint8_t imgui_draw_list_fits(ImGuiDrawList* draw_list
+                                   ,uint32_t       vertex_count
+                                   ,uint32_t       index_count
+                                   ,uint8_t        command
+                                   )
+{
+    return draw_list->vertex_count + vertex_count <= draw_list->vertex_capacity
+        && draw_list->index_count + index_count <= draw_list->index_capacity
+        && draw_list->command_count + command <= draw_list->command_capacity;
+}
+// Grows the list, or draws it when it cannot grow. Reactive frames draw after d2d_frame_begin, so there the primitive is dropped instead.
+static int8_t imgui_draw_list_make_room(ImGui*   imgui
+                                       ,uint32_t vertex_count
+                                       ,uint32_t index_count
+                                       ,uint8_t  command
+                                       )
+{
+    ImGuiDrawList *draw_list = &imgui->draw_list;
 
-    Vector2f position;
-    position.x = rect.x + (rect.width / 2) - measurement.width_in_px / 2;
-    position.y = rect.y + (rect.height / 2) - (font->font_size + font->padding) / 2;
+    if (draw_list->command_count + command > draw_list->command_capacity && imgui_draw_list_grow_commands(draw_list) == DELO_SUCCESS)
+    {
+        d2d_renderer_overflow_record(imgui->context, &draw_list->overflow, (RendererStats){1, 0, 0});
+    }
 
-    d2d_color_set_i(&color_text, 255, 255, 255, 255);
+    if (imgui_draw_list_fits(draw_list, vertex_count, index_count, command))
+    {
+        return DELO_SUCCESS;
+    }
 
-    d2d_renderer_sprite_font_add_text(renderer_sprite_font, font, caption, 0, position, color_text, (Vector2f){0, 0});
+    uint32_t needed   = draw_list->vertex_count + vertex_count;
+    uint32_t needed_i = (uint32_t)(((uint64_t)draw_list->index_count + index_count) * IMGUI_DRAW_LIST_VERTICES / IMGUI_DRAW_LIST_INDICES) + 1;
+    uint32_t capacity = d2d_renderer_overflow_capacity(&draw_list->overflow, draw_list->vertex_capacity, (needed > needed_i) ? needed : needed_i);
 
-    return event;
-}
+    if (capacity > 0 && imgui_draw_list_grow(draw_list, capacity) == DELO_SUCCESS)
+    {
+        d2d_renderer_overflow_record(imgui->context, &draw_list->overflow, (RendererStats){1, 0, 0});
 
-SliderEvent imgui_slider(ImGui*      imgui
-                               ,int32_t     id
-                               ,Rectangle_f rect_bounds
-                               ,Rectangle_f rect_knob
-                               ,int32_t     min
-                               ,int32_t     max
-                               ,int32_t*    value
-                               )
-{
-    SliderEvent event = {0, 0, 0.0f};
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    SpriteFont *font = imgui->font;
+        if (imgui_draw_list_fits(draw_list, vertex_count, index_count, command))
+        {
+            return DELO_SUCCESS;
+        }
+    }
 
-    float mouse_position_x = imgui->hid_state->mouse_position_x;
-    float mouse_position_y = imgui->hid_state->mouse_position_y;
+    if (!imgui->context->reactive.enabled && draw_list->index_count > 0)
+    {
+        imgui_draw_list_render(draw_list, imgui->context);
 
-    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
-    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+        draw_list->vertex_count  = 0;
+        draw_list->index_count   = 0;
+        draw_list->command_count = 0;
 
-    rect_knob.x = rect_bounds.x + (rect_bounds.width - rect_knob.width) * ((float)*value / ((float)max - (float)min));
-    rect_knob.y = rect_bounds.y;
+        d2d_renderer_overflow_record(imgui->context, &draw_list->overflow, (RendererStats){0, 1, 0});
 
-    if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE)
+        if (imgui_draw_list_fits(draw_list, vertex_count, index_count, 1))
+        {
+            return DELO_SUCCESS;
+        }
+    }
+
+    d2d_renderer_overflow_record(imgui->context, &draw_list->overflow, (RendererStats){0, 0, vertex_count});
+    return DELO_ERROR;
+}
+// Returns the first vertex of a primitive, or -1 when it is clipped away or does not fit. Its indices start at index_count minus its index count.
+static int32_t imgui_draw_list_reserve(ImGui*    imgui
+                                      ,Vector2f* points
+                                      ,uint32_t  vertex_count
+                                      ,uint32_t  index_count
+                                      ,uint32_t  texture
+                                      )
+{
+    ImGuiDrawList *draw_list = &imgui->draw_list;
+    ClipStack     *stack     = &imgui->context->clip_stack;
+
+    if (stack->depth > 0)
     {
-        if (d2d_rectangle_within_bounds(&rect_knob, mouse_position_x, mouse_position_y))
+        float min_x = points[0].x, max_x = points[0].x;
+        float min_y = points[0].y, max_y = points[0].y;
+
+        for (uint32_t i = 1; i < vertex_count; i++)
         {
-            imgui->dx = rect_knob.x - mouse_position_x;
-            imgui->active_id = id;
+            min_x = fminf(min_x, points[i].x);
+            max_x = fmaxf(max_x, points[i].x);
+            min_y = fminf(min_y, points[i].y);
+            max_y = fmaxf(max_y, points[i].y);
         }
-        else if (d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
+
+        if (d2d_clip_reject(imgui->context, &draw_list->projection, (Rectangle_f){min_x, min_y, max_x - min_x, max_y - min_y}))
         {
-            imgui->dx = -rect_knob.width / 2;
-            imgui->active_id = id;
+            draw_list->rejected++;
+            return -1;
         }
     }
-    else if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_PRESS)
-    {
-        if (imgui->active_id == id)
-        {
-            rect_knob.x = mouse_position_x + imgui->dx;
-            if (rect_knob.x < rect_bounds.x)
-            {
-                rect_knob.x = rect_bounds.x;
-            }
-            else if (rect_knob.x > rect_bounds.x + rect_bounds.width - rect_knob.width)
-            {
-                rect_knob.x = rect_bounds.x + rect_bounds.width - rect_knob.width;
-            }
 
-            float x = (float)rect_knob.x - (float)rect_bounds.x;
+    uint8_t     clipped = stack->depth > 0;
+    Rectangle_f clip    = clipped ? stack->rects[stack->depth - 1] : (Rectangle_f){0, 0, 0, 0};
 
-            float percentage = x / (rect_bounds.width - rect_knob.width);
+    ImGuiDrawCommand *command = (draw_list->command_count > 0) ? &draw_list->commands[draw_list->command_count - 1] : NULL;
 
-            int16_t range = max - min;
+    // Solid geometry ignores the bound texture, so it never splits a command on its own.
+    uint8_t compatible = command != NULL
+                      && command->clipped == clipped
+                      && memcmp(&command->clip, &clip, sizeof(Rectangle_f)) == 0
+                      && (texture == 0 || command->texture == 0 || command->texture == texture);
 
-            int16_t temp = ((float)range * percentage) + (float)min;
-            if (temp != *value)
-            {
-                *value = temp;
-                event.changed = 1;
-            }
-        }
-    }
-    else if (mouse_button_left == GLFW_RELEASE && mouse_button_left_prev == GLFW_PRESS)
+    if (!imgui_draw_list_fits(draw_list, vertex_count, index_count, !compatible))
     {
-        if (imgui->active_id == id)
+        if (imgui_draw_list_make_room(imgui, vertex_count, index_count, !compatible) == DELO_ERROR)
         {
-            imgui->active_id = 0;
-            event.released = 1;
+            return -1;
         }
+
+        // A flush leaves the list empty, so the primitive opens the first command.
+        compatible = compatible && draw_list->command_count > 0;
+        command    = compatible ? &draw_list->commands[draw_list->command_count - 1] : NULL;
     }
 
-    Color color_fills;
-    d2d_color_set_i(&color_fills, 50, 64, 91, 255);
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect_bounds, color_fills);
+    if (!compatible)
+    {
+        command = &draw_list->commands[draw_list->command_count++];
 
-    Color color_outlines;
-    d2d_color_set_i(&color_outlines, 101, 129, 184, 255);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect_bounds, color_outlines);
-    d2d_color_set_i(&color_outlines, 255, 255, 255, 255);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect_knob, color_outlines);
+        command->first   = draw_list->index_count;
+        command->count   = 0;
+        command->texture = texture;
+        command->clip    = clip;
+        command->clipped = clipped;
+    }
+    else if (texture != 0)
+    {
+        command->texture = texture;
+    }
 
-    Color color_text;
-    d2d_color_set_i(&color_text, 255, 255, 255, 255);
-    char value_text[16];
-    snprintf(&value_text[0], sizeof(char) * CAPTION_SIZE, "%i", *value);
+    command->count += index_count;
 
-    Vector2f position;
-    position.x = rect_bounds.x + rect_bounds.width + 6;
-    position.y = rect_bounds.y + rect_bounds.height * 0.5 - font->font_size * 0.5;
+    int32_t first = draw_list->vertex_count;
 
-    d2d_renderer_sprite_font_add_text(renderer_sprite_font, font, value_text, 0, position, color_text, (Vector2f){0, 0});
+    draw_list->vertex_count += vertex_count;
+    draw_list->index_count  += index_count;
 
-    return event;
+    return first;
 }
-
-uint8_t imgui_tswitch(ImGui*      imgui
-                            ,int32_t     id
-                            ,Rectangle_f rect_bounds
-                            ,uint8_t*    value
-                            ,char*       text_on
-                            ,char*       text_off
-                            )
+static void imgui_draw_list_quad(ImGui*   imgui
+                                ,Vector2f p0
+                                ,Vector2f p1
+                                ,Vector2f p2
+                                ,Vector2f p3
+                                ,Vector2f uv0
+                                ,Vector2f uv1
+                                ,Color    color
+                                ,float    mode
+                                ,uint32_t texture
+                                )
 {
-    uint8_t changed = 0;
+    ImGuiDrawList *draw_list = &imgui->draw_list;
+    Vector2f       points[4] = {p0, p1, p2, p3};
+    int32_t        first     = imgui_draw_list_reserve(imgui, points, 4, 6, texture);
 
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    SpriteFont *font = imgui->font;
+    if (first == -1)
+    {
+        return;
+    }
 
-    float mouse_position_x = imgui->hid_state->mouse_position_x;
-    float mouse_position_y = imgui->hid_state->mouse_position_y;
+    uint32_t indices = draw_list->index_count - 6;
 
-    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
-    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+    ImGuiVertex *v = &draw_list->vertices[first];
 
-    Rectangle_f rect_knob =
-        {
-            (*value) ? rect_bounds.x + rect_bounds.width - rect_bounds.width / 2 : rect_bounds.x,
-            rect_bounds.y,
-            rect_bounds.width / 2,
-            rect_bounds.height};
+    v[0] = (ImGuiVertex){p0, {uv0.x, uv0.y}, color, mode};
+    v[1] = (ImGuiVertex){p1, {uv1.x, uv0.y}, color, mode};
+    v[2] = (ImGuiVertex){p2, {uv1.x, uv1.y}, color, mode};
+    v[3] = (ImGuiVertex){p3, {uv0.x, uv1.y}, color, mode};
 
-    if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE)
+    uint16_t *i = &draw_list->indices[indices];
+
+    i[0] = first;
+    i[1] = first + 1;
+    i[2] = first + 2;
+    i[3] = first;
+    i[4] = first + 2;
+    i[5] = first + 3;
+}
+void imgui_draw_list_render(ImGuiDrawList* draw_list
+                           ,D2DContext*    context
+                           )
+{
+    draw_list->draw_calls = 0;
+
+    if (draw_list->index_count == 0)
     {
-        if (d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
-        {
-            *value = !*value;
-            changed = 1;
-        }
+        return;
     }
 
-    Color color_fills;
-    d2d_color_set_i(&color_fills, 50, 64, 91, 255);
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect_bounds, color_fills);
+    glBindVertexArray(draw_list->vao);
 
-    d2d_color_set_i(&color_fills, 66, 84, 120, 255);
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect_knob, color_fills);
+    if (draw_list->buffer_capacity < draw_list->vertex_capacity)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, draw_list->vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(ImGuiVertex) * draw_list->vertex_capacity, NULL, GL_DYNAMIC_DRAW);
 
-    Color color_outline;
-    d2d_color_set_i(&color_outline, 101, 129, 184, 255);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect_bounds, color_outline);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, draw_list->ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * draw_list->index_capacity, NULL, GL_DYNAMIC_DRAW);
 
-    d2d_color_set_i(&color_outline, 255, 255, 255, 255);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect_knob, color_outline);
+        draw_list->buffer_capacity = draw_list->vertex_capacity;
+    }
 
-    Color color_sprite_font;
-    d2d_color_set_i(&color_sprite_font, 255, 255, 255, 255);
+    glBindBuffer(GL_ARRAY_BUFFER, draw_list->vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(ImGuiVertex) * draw_list->vertex_count, draw_list->vertices);
 
-    Vector2f position =
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, draw_list->ebo);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(uint16_t) * draw_list->index_count, draw_list->indices);
+
+    glUseProgram(draw_list->shader);
+    glUniformMatrix4fv(draw_list->uniform_location_u_mvp, 1, GL_FALSE, &draw_list->projection.x11);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    uint32_t bound = 0;
+
+    for (uint32_t c = 0; c < draw_list->command_count; c++)
+    {
+        ImGuiDrawCommand *command = &draw_list->commands[c];
+
+        if (command->count == 0)
         {
-            rect_bounds.x + rect_bounds.width + 6,
-            rect_bounds.y + rect_bounds.height * 0.5 - font->font_size * 0.5};
+            continue;
+        }
 
-    char *caption = (*value) ? text_on : text_off;
+        if (command->texture != 0 && command->texture != bound)
+        {
+            glBindTexture(GL_TEXTURE_2D, command->texture);
+            bound = command->texture;
+        }
 
-    d2d_renderer_sprite_font_add_text(renderer_sprite_font, font, caption, 0, position, color_sprite_font, (Vector2f){0, 0});
-    return changed;
+        ClipBatch clip = {0, command->clip, command->clipped};
+        d2d_clip_apply(context, &clip);
+
+        glDrawElements(GL_TRIANGLES, command->count, GL_UNSIGNED_SHORT, (void *)(sizeof(uint16_t) * command->first));
+        draw_list->draw_calls++;
+    }
+
+    d2d_clip_restore(context);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+    glUseProgram(0);
 }
-uint8_t lol2(Rectangle_f *rect, float min, float max)
+static uint64_t imgui_draw_list_hash(ImGuiDrawList* draw_list)
 {
-    if (rect->y > max)
+    uint64_t hash = 14695981039346656037ULL;
+
+    hash = d2d_hash_fnv1a(draw_list->vertices, sizeof(ImGuiVertex) * draw_list->vertex_count, hash);
+    hash = d2d_hash_fnv1a(draw_list->indices, sizeof(uint16_t) * draw_list->index_count, hash);
+
+    for (uint32_t c = 0; c < draw_list->command_count; c++)
     {
-        return 0;
+        ImGuiDrawCommand *command = &draw_list->commands[c];
+
+        hash = d2d_hash_fnv1a(&command->first, sizeof(uint32_t) * 3, hash);
+        hash = d2d_hash_fnv1a(&command->clip, sizeof(Rectangle_f), hash);
+        hash = d2d_hash_fnv1a(&command->clipped, sizeof(uint8_t), hash);
     }
-    else
+
+    return hash;
+}
+static void imgui_draw_list_bounds(float*       bounds
+                                  ,ImGuiVertex* vertices
+                                  ,uint16_t*    indices
+                                  )
+{
+    for (uint8_t i = 0; i < 3; i++)
     {
-        if (rect->y + 32 > max)
-        {
-            rect->height = max - rect->y;
+        Vector2f p = vertices[indices[i]].position;
+
+        bounds[0] = fminf(bounds[0], p.x);
+        bounds[1] = fminf(bounds[1], p.y);
+        bounds[2] = fmaxf(bounds[2], p.x);
+        bounds[3] = fmaxf(bounds[3], p.y);
+    }
+}
+// Compares this frame's triangles against last frame's and reports the changed area to the context.
+void imgui_draw_list_damage(ImGuiDrawList* draw_list
+                           ,D2DContext*    context
+                           )
+{
+    uint64_t hash = imgui_draw_list_hash(draw_list);
+
+    if (hash == draw_list->hash)
+    {
+        return;
+    }
+
+    draw_list->hash = hash;
+
+    if (!context->reactive.damage_full)
+    {
+        float    bounds[4]     = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+        uint32_t triangles     = draw_list->index_count / 3;
+        uint32_t triangles_old = draw_list->index_count_prev / 3;
+        uint32_t command       = 0;
+        uint32_t command_old   = 0;
+
+        for (uint32_t t = 0; t < triangles || t < triangles_old; t++)
+        {
+            ImGuiDrawCommand *c     = NULL;
+            ImGuiDrawCommand *c_old = NULL;
+
+            while (t < triangles && draw_list->commands[command].first + draw_list->commands[command].count <= t * 3)
+            {
+                command++;
+            }
+            while (t < triangles_old && draw_list->commands_prev[command_old].first + draw_list->commands_prev[command_old].count <= t * 3)
+            {
+                command_old++;
+            }
+
+            if (t < triangles)     c     = &draw_list->commands[command];
+            if (t < triangles_old) c_old = &draw_list->commands_prev[command_old];
+
+            uint8_t same = c != NULL && c_old != NULL
+                        && c->texture == c_old->texture
+                        && c->clipped == c_old->clipped
+                        && memcmp(&c->clip, &c_old->clip, sizeof(Rectangle_f)) == 0;
+
+            for (uint8_t i = 0; same && i < 3; i++)
+            {
+                same = memcmp(&draw_list->vertices[draw_list->indices[t * 3 + i]]
+                             ,&draw_list->vertices_prev[draw_list->indices_prev[t * 3 + i]]
+                             ,sizeof(ImGuiVertex)
+                             ) == 0;
+            }
+
+            if (same)
+            {
+                continue;
+            }
+
+            if (c != NULL)     imgui_draw_list_bounds(bounds, draw_list->vertices, &draw_list->indices[t * 3]);
+            if (c_old != NULL) imgui_draw_list_bounds(bounds, draw_list->vertices_prev, &draw_list->indices_prev[t * 3]);
+        }
+
+        // Pad by a pixel so rasterization rounding at the edges is covered.
+        if (bounds[0] <= bounds[2])
+        {
+            d2d_frame_damage(context, (Rectangle_f){bounds[0] - 1, bounds[1] - 1, bounds[2] - bounds[0] + 2, bounds[3] - bounds[1] + 2});
+        }
+    }
+
+    memcpy(draw_list->vertices_prev, draw_list->vertices, sizeof(ImGuiVertex) * draw_list->vertex_count);
+    memcpy(draw_list->indices_prev, draw_list->indices, sizeof(uint16_t) * draw_list->index_count);
+    memcpy(draw_list->commands_prev, draw_list->commands, sizeof(ImGuiDrawCommand) * draw_list->command_count);
+
+    draw_list->vertex_count_prev  = draw_list->vertex_count;
+    draw_list->index_count_prev   = draw_list->index_count;
+    draw_list->command_count_prev = draw_list->command_count;
+}
+void imgui_draw_rectangle(ImGui*      imgui
+                         ,Rectangle_f rect
+                         ,Color       color
+                         )
+{
+    imgui_draw_list_quad(imgui
+                        ,(Vector2f){rect.x, rect.y}
+                        ,(Vector2f){rect.x + rect.width, rect.y}
+                        ,(Vector2f){rect.x + rect.width, rect.y + rect.height}
+                        ,(Vector2f){rect.x, rect.y + rect.height}
+                        ,(Vector2f){0, 0}
+                        ,(Vector2f){0, 0}
+                        ,color
+                        ,IMGUI_MODE_SOLID
+                        ,0
+                        );
+}
+void imgui_draw_rectangle_outline(ImGui*      imgui
+                                 ,Rectangle_f rect
+                                 ,Color       color
+                                 )
+{
+    imgui_draw_rectangle(imgui, (Rectangle_f){rect.x, rect.y, rect.width, 1}, color);
+    imgui_draw_rectangle(imgui, (Rectangle_f){rect.x, rect.y + rect.height - 1, rect.width, 1}, color);
+    imgui_draw_rectangle(imgui, (Rectangle_f){rect.x, rect.y + 1, 1, rect.height - 2}, color);
+    imgui_draw_rectangle(imgui, (Rectangle_f){rect.x + rect.width - 1, rect.y + 1, 1, rect.height - 2}, color);
+}
+void imgui_draw_line(ImGui*   imgui
+                    ,Vector2f a
+                    ,Vector2f b
+                    ,Color    color
+                    ,float    thickness
+                    )
+{
+    float dx     = b.x - a.x;
+    float dy     = b.y - a.y;
+    float length = sqrtf(dx * dx + dy * dy);
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    float nx = -dy / length * thickness * 0.5f;
+    float ny =  dx / length * thickness * 0.5f;
+
+    imgui_draw_list_quad(imgui
+                        ,(Vector2f){a.x + nx, a.y + ny}
+                        ,(Vector2f){b.x + nx, b.y + ny}
+                        ,(Vector2f){b.x - nx, b.y - ny}
+                        ,(Vector2f){a.x - nx, a.y - ny}
+                        ,(Vector2f){0, 0}
+                        ,(Vector2f){0, 0}
+                        ,color
+                        ,IMGUI_MODE_SOLID
+                        ,0
+                        );
+}
+void imgui_draw_triangle(ImGui*   imgui
+                        ,Vector2f a
+                        ,Vector2f b
+                        ,Vector2f c
+                        ,Color    color
+                        )
+{
+    ImGuiDrawList *draw_list = &imgui->draw_list;
+    Vector2f       points[3] = {a, b, c};
+    int32_t        first     = imgui_draw_list_reserve(imgui, points, 3, 3, 0);
+
+    if (first == -1)
+    {
+        return;
+    }
+
+    uint32_t indices = draw_list->index_count - 3;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        draw_list->vertices[first + i] = (ImGuiVertex){points[i], {0, 0}, color, IMGUI_MODE_SOLID};
+        draw_list->indices[indices + i] = first + i;
+    }
+}
+void imgui_draw_sprite(ImGui*      imgui
+                      ,Rectangle_f dest
+                      ,Rectangle_f src
+                      ,Texture*    texture
+                      ,Color       color
+                      )
+{
+    float w = (float)texture->width;
+    float h = (float)texture->height;
+
+    imgui_draw_list_quad(imgui
+                        ,(Vector2f){dest.x, dest.y}
+                        ,(Vector2f){dest.x + dest.width, dest.y}
+                        ,(Vector2f){dest.x + dest.width, dest.y + dest.height}
+                        ,(Vector2f){dest.x, dest.y + dest.height}
+                        ,(Vector2f){src.x / w, src.y / h}
+                        ,(Vector2f){(src.x + src.width) / w, (src.y + src.height) / h}
+                        ,color
+                        ,IMGUI_MODE_IMAGE
+                        ,texture->renderer_id
+                        );
+}
+static void imgui_draw_glyph(ImGui*      imgui
+                            ,SpriteFont* font
+                            ,uint8_t     page
+                            ,Matrix44*   transform
+                            ,Vector2f    offset
+                            ,Rectangle_f src_rect
+                            ,Color       color
+                            )
+{
+    float x0 = offset.x - transform->x11;
+    float y0 = offset.y - transform->x22;
+    float x1 = offset.x + transform->x11;
+    float y1 = offset.y + transform->x22;
+
+    imgui_draw_list_quad(imgui
+                        ,(Vector2f){x0, y0}
+                        ,(Vector2f){x1, y0}
+                        ,(Vector2f){x1, y1}
+                        ,(Vector2f){x0, y1}
+                        ,(Vector2f){src_rect.x, src_rect.y}
+                        ,(Vector2f){src_rect.x + src_rect.width, src_rect.y + src_rect.height}
+                        ,color
+                        ,font->sdf ? IMGUI_MODE_SDF : IMGUI_MODE_FONT
+                        ,font->pages[page].texture.renderer_id
+                        );
+}
+void imgui_draw_text(ImGui*      imgui
+                    ,SpriteFont* font
+                    ,char*       text
+                    ,uint32_t    max_length
+                    ,Vector2f    position
+                    ,Color       color
+                    )
+{
+    d2d_sprite_font_frame(font, imgui->context);
+
+    TextLayout *layout = NULL;
+
+    if (imgui->text_cache != NULL)
+    {
+        layout = d2d_text_cache_get(imgui->text_cache, font, text, max_length, 1.0f);
+    }
+
+    if (layout != NULL)
+    {
+        for (uint32_t i = 0; i < layout->count; i++)
+        {
+            Vector2f offset = {position.x + layout->offsets[i].x, position.y + layout->offsets[i].y};
+
+            imgui_draw_glyph(imgui, font, layout->pages[i], &layout->transforms[i], offset, layout->src_rects[i], color);
+        }
+
+        return;
+    }
+
+    const uint8_t *s        = (const uint8_t*)text;
+    const uint8_t *end      = s + strlen(text);
+    uint32_t       previous = 0;
+
+    font->tick++;
+
+    for (uint32_t i = 0; s < end; i++)
+    {
+        if (max_length > 0 && i > max_length)
+        {
+            break;
+        }
+
+        uint32_t length;
+        uint32_t c = d2d_utf8_decode(s, end, &length);
+        s += length;
+
+        if (c == 32)
+        {
+            position.x += font->advance;
+            previous = 0;
+            continue;
+        }
+
+        Glyph *glyph = (c > 32) ? d2d_sprite_font_glyph(font, c) : NULL;
+
+        if (glyph == NULL)
+        {
+            continue;
+        }
+
+        position.x += d2d_sprite_font_kerning(font, previous, c);
+        previous    = c;
+
+        Matrix44    transform;
+        Vector2f    offset;
+        Rectangle_f src_rect;
+
+        d2d_sprite_font_place_glyph(font, glyph, position, 1.0f, &transform, &offset, &src_rect);
+        imgui_draw_glyph(imgui, font, glyph->page, &transform, offset, src_rect, color);
+
+        position.x += glyph->advance;
+    }
+}
+ButtonEvent imgui_button(Rectangle_f rect
+                               ,char*       caption
+                               ,ImGui*      imgui
+                               )
+{
+    ButtonEvent event = {0, 0};
+    SpriteFont *font = imgui->font;
+
+    float mouse_position_x = imgui->hid_state->mouse_position_x;
+    float mouse_position_y = imgui->hid_state->mouse_position_y;
+
+    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
+    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+
+    uint8_t button_state = BUTTON_STATE_NORMAL;
+
+    if (d2d_rectangle_within_bounds(&rect, mouse_position_x, mouse_position_y))
+    {
+        button_state = (mouse_button_left == GLFW_PRESS) ? BUTTON_STATE_ACTIVE : BUTTON_STATE_HOVER;
+        if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE)
+        {
+            event.clicked = 1;
+        }
+        event.hover = 1;
+    }
+
+    Color color_fill, color_outline, color_text;
+
+    switch (button_state)
+    {
+    case BUTTON_STATE_NORMAL:
+        d2d_color_set_i(&color_fill, 50, 64, 91, 255);
+        d2d_color_set_i(&color_outline, 77 * 0.5, 99 * 0.5, 140 * 0.5, 255);
+        break;
+    case BUTTON_STATE_HOVER:
+        d2d_color_set_i(&color_fill, 50 * 1.1, 64 * 1.1, 91 * 1.1, 255);
+        d2d_color_set_i(&color_outline, 77 * 1.0, 99 * 1.0, 140 * 1.0, 255);
+        break;
+    case BUTTON_STATE_ACTIVE:
+        d2d_color_set_i(&color_fill, 50 * 1.3, 64 * 1.3, 91 * 1.3, 255);
+        d2d_color_set_i(&color_outline, 77 * 1.5, 99 * 1.5, 140 * 1.5, 255);
+        break;
+    }
+
+    imgui_draw_rectangle(imgui, rect, color_fill);
+    imgui_draw_rectangle_outline(imgui, rect, color_outline);
+
+    FontMeasurement measurement;
+    d2d_text_cache_measure(imgui->text_cache, font, caption, &measurement);
+
+    Vector2f position;
+    position.x = rect.x + (rect.width / 2) - measurement.width_in_px / 2;
+    position.y = rect.y + (rect.height / 2) - (font->font_size + font->padding) / 2;
+
+    d2d_color_set_i(&color_text, 255, 255, 255, 255);
+
+    imgui_draw_text(imgui, font, caption, 0, position, color_text);
+
+    return event;
+}
+
+SliderEvent imgui_slider(ImGui*      imgui
+                               ,int32_t     id
+                               ,Rectangle_f rect_bounds
+                               ,Rectangle_f rect_knob
+                               ,int32_t     min
+                               ,int32_t     max
+                               ,int32_t*    value
+                               )
+{
+    SliderEvent event = {0, 0, 0.0f};
+    SpriteFont *font = imgui->font;
+
+    float mouse_position_x = imgui->hid_state->mouse_position_x;
+    float mouse_position_y = imgui->hid_state->mouse_position_y;
+
+    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
+    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+
+    rect_knob.x = rect_bounds.x + (rect_bounds.width - rect_knob.width) * ((float)*value / ((float)max - (float)min));
+    rect_knob.y = rect_bounds.y;
+
+    if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE)
+    {
+        if (d2d_rectangle_within_bounds(&rect_knob, mouse_position_x, mouse_position_y))
+        {
+            imgui->dx = rect_knob.x - mouse_position_x;
+            imgui->active_id = id;
+        }
+        else if (d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
+        {
+            imgui->dx = -rect_knob.width / 2;
+            imgui->active_id = id;
+        }
+    }
+    else if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_PRESS)
+    {
+        if (imgui->active_id == id)
+        {
+            rect_knob.x = mouse_position_x + imgui->dx;
+            if (rect_knob.x < rect_bounds.x)
+            {
+                rect_knob.x = rect_bounds.x;
+            }
+            else if (rect_knob.x > rect_bounds.x + rect_bounds.width - rect_knob.width)
+            {
+                rect_knob.x = rect_bounds.x + rect_bounds.width - rect_knob.width;
+            }
+
+            float x = (float)rect_knob.x - (float)rect_bounds.x;
+
+            float percentage = x / (rect_bounds.width - rect_knob.width);
+
+            int16_t range = max - min;
+
+            int16_t temp = ((float)range * percentage) + (float)min;
+            if (temp != *value)
+            {
+                *value = temp;
+                event.changed = 1;
+            }
+        }
+    }
+    else if (mouse_button_left == GLFW_RELEASE && mouse_button_left_prev == GLFW_PRESS)
+    {
+        if (imgui->active_id == id)
+        {
+            imgui->active_id = 0;
+            event.released = 1;
+        }
+    }
+
+    Color color_fills;
+    d2d_color_set_i(&color_fills, 50, 64, 91, 255);
+    imgui_draw_rectangle(imgui, rect_bounds, color_fills);
+
+    Color color_outlines;
+    d2d_color_set_i(&color_outlines, 101, 129, 184, 255);
+    imgui_draw_rectangle_outline(imgui, rect_bounds, color_outlines);
+    d2d_color_set_i(&color_outlines, 255, 255, 255, 255);
+    imgui_draw_rectangle_outline(imgui, rect_knob, color_outlines);
+
+    Color color_text;
+    d2d_color_set_i(&color_text, 255, 255, 255, 255);
+    char value_text[16];
+    snprintf(&value_text[0], sizeof(char) * CAPTION_SIZE, "%i", *value);
+
+    Vector2f position;
+    position.x = rect_bounds.x + rect_bounds.width + 6;
+    position.y = rect_bounds.y + rect_bounds.height * 0.5 - font->font_size * 0.5;
+
+    imgui_draw_text(imgui, font, value_text, 0, position, color_text);
+
+    return event;
+}
+
+uint8_t imgui_tswitch(ImGui*      imgui
+                            ,int32_t     id
+                            ,Rectangle_f rect_bounds
+                            ,uint8_t*    value
+                            ,char*       text_on
+                            ,char*       text_off
+                            )
+{
+    uint8_t changed = 0;
+
+    SpriteFont *font = imgui->font;
+
+    float mouse_position_x = imgui->hid_state->mouse_position_x;
+    float mouse_position_y = imgui->hid_state->mouse_position_y;
+
+    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
+    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+
+    Rectangle_f rect_knob =
+        {
+            (*value) ? rect_bounds.x + rect_bounds.width - rect_bounds.width / 2 : rect_bounds.x,
+            rect_bounds.y,
+            rect_bounds.width / 2,
+            rect_bounds.height};
+
+    if (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE)
+    {
+        if (d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
+        {
+            *value = !*value;
+            changed = 1;
+        }
+    }
+
+    Color color_fills;
+    d2d_color_set_i(&color_fills, 50, 64, 91, 255);
+    imgui_draw_rectangle(imgui, rect_bounds, color_fills);
+
+    d2d_color_set_i(&color_fills, 66, 84, 120, 255);
+    imgui_draw_rectangle(imgui, rect_knob, color_fills);
+
+    Color color_outline;
+    d2d_color_set_i(&color_outline, 101, 129, 184, 255);
+    imgui_draw_rectangle_outline(imgui, rect_bounds, color_outline);
+
+    d2d_color_set_i(&color_outline, 255, 255, 255, 255);
+    imgui_draw_rectangle_outline(imgui, rect_knob, color_outline);
+
+    Color color_sprite_font;
+    d2d_color_set_i(&color_sprite_font, 255, 255, 255, 255);
+
+    Vector2f position =
+        {
+            rect_bounds.x + rect_bounds.width + 6,
+            rect_bounds.y + rect_bounds.height * 0.5 - font->font_size * 0.5};
+
+    char *caption = (*value) ? text_on : text_off;
+
+    imgui_draw_text(imgui, font, caption, 0, position, color_sprite_font);
+    return changed;
+}
+uint8_t lol2(Rectangle_f *rect, float min, float max)
+{
+    if (rect->y > max)
+    {
+        return 0;
+    }
+    else
+    {
+        if (rect->y + 32 > max)
+        {
+            rect->height = max - rect->y;
+            return 1;
+        }
+        
+    }
+
+    if (rect->y + 32 < min)
+    {
+        return 0;
+    }
+    else
+    {
+        if (rect->y < min)
+        {
+            rect->height = rect->y - min;
+            rect->y += 32 - rect->height;
             return 1;
         }
-        
+    }
+    return 1;
+}
+DropdownEvent imgui_dropdown(ImGui*      imgui
+                      ,int32_t     id
+                      ,Rectangle_f rect_header
+                      ,char*       captions
+                      ,uint8_t*    selections
+                      ,uint16_t    children_count
+                      ,uint16_t    stride
+                      )
+{
+    DropdownEvent event;
+    event.changed = 0;
+
+    SpriteFont *font = imgui->font;
+
+    float mouse_position_x = imgui->hid_state->mouse_position_x;
+    float mouse_position_y = imgui->hid_state->mouse_position_y;
+
+    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
+    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+
+    uint8_t display_count = children_count <= 16 ? children_count : 16;
+
+    Rectangle_f scroll_area = (Rectangle_f)
+    {
+        rect_header.x + rect_header.width,
+        rect_header.y + rect_header.height,
+        16, rect_header.height * display_count
+    };
+    Rectangle_f scroll_bar = (Rectangle_f)
+    {
+        scroll_area.x,
+        scroll_area.y,
+        16, scroll_area.height * 0.1
+    };
+
+    float children_offset = 0;
+    uint8_t multi_select = imgui->hid_state->key_ctrl_left;
+
+    uint8_t click = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE);
+    uint8_t hold = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_PRESS);
+    uint8_t release = (mouse_button_left == GLFW_RELEASE && mouse_button_left_prev == GLFW_PRESS);
+
+    if (click)
+    {
+        if (d2d_rectangle_within_bounds(&rect_header, mouse_position_x, mouse_position_y))
+        {
+            imgui->collapsed = !imgui->collapsed;
+
+            if (imgui->collapsed)
+            {
+                if (imgui->active_id == id)
+                {
+                    imgui->active_id = 0;
+                }
+            }
+            else
+            {
+                imgui->active_id = id;
+                imgui->scroll_bar_y = scroll_area.y;
+            }
+        }
+    }
+
+    if (imgui->active_id == id)
+    {
+        scroll_bar.y = imgui->scroll_bar_y;
+
+        if (click)
+        {
+            Rectangle_f rect_bounds = {rect_header.x, rect_header.y, rect_header.width, rect_header.height * display_count + 32};
+
+            if (!d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
+            {
+                if (!d2d_rectangle_within_bounds(&scroll_area, mouse_position_x, mouse_position_y))
+                {
+                    imgui->collapsed = 1;
+                    imgui->active_id = 0;
+                }
+            }
+            if (d2d_rectangle_within_bounds(&scroll_bar, mouse_position_x, mouse_position_y))
+            {
+                imgui->hold_scroll_bar = 1;
+                imgui->scroll_bar_delta_y = scroll_bar.y - mouse_position_y;
+                printf("lol på dig davi\n");
+            }
+        }
+        else if (hold)
+        {
+            if (imgui->hold_scroll_bar)
+            {
+                scroll_bar.y = mouse_position_y + imgui->scroll_bar_delta_y;
+                if (scroll_bar.y < scroll_area.y)
+                {
+                    scroll_bar.y = scroll_area.y;
+                }
+                else if (scroll_bar.y + scroll_bar.height > scroll_area.y + scroll_area.height)
+                {
+                    scroll_bar.y = scroll_area.y + scroll_area.height - scroll_bar.height;
+                }
+                imgui->scroll_bar_y = scroll_bar.y;
+            }
+        }
+        else if (release)
+        {
+            imgui->hold_scroll_bar = 0;
+            imgui->scroll_bar_delta_y = 0;
+        }
+
+        if (!imgui->collapsed)
+        {
+            float min = scroll_area.y;
+            float max = (scroll_area.y + scroll_area.height - scroll_bar.height);
+            float current = scroll_bar.y;
+            float norm = (current - min) / (max - min);
+
+            children_offset = (children_count - display_count) * 32 * norm;
+
+            int first = (int)(children_offset / 32);
+            int last  = first + display_count + 1;
+
+            if (last > children_count)
+            {
+                last = children_count;
+            }
+
+            for (int i = first; i < last; i++)
+            {
+                uint8_t hover = 0;
+                Rectangle_f rect =
+                {
+                    rect_header.x,
+                    rect_header.y + 32 * (i + 1),
+                    rect_header.width,
+                    rect_header.height
+                };
+                rect.y -= children_offset;
+
+                float temp_posy = rect.y;
+
+                uint8_t within_bounds = lol2(&rect, rect_header.y, rect_header.y + (32 * (display_count + 1)));
+
+                if (within_bounds)
+                {
+                    if (d2d_rectangle_within_bounds(&rect, mouse_position_x, mouse_position_y))
+                    {
+                        hover = 1;
+                        if (click)
+                        {
+                            if (!multi_select)
+                            {
+                                for (int i = 0; i < children_count; i++)
+                                {
+                                    selections[i] = 0;
+                                }
+                                imgui->collapsed = 1;
+                                imgui->active_id = 0;
+                            }
+                            selections[i] = !selections[i];
+                            event.changed = 1;
+                        }
+                    }
+
+                    Color color_fills;
+                    if (selections[i])
+                    {
+                        d2d_color_set_i(&color_fills, 66 * 1.5, 84 * 1.5, 120 * 1.5, 255);
+                    }
+                    else if (hover)
+                    {
+                        d2d_color_set_i(&color_fills, 66 * 0.5, 84 * 0.5, 120 * 0.5, 255);
+                    }
+                    else
+                    {
+                        d2d_color_set_i(&color_fills, 50, 64, 91, 255);
+                    }
+
+                    imgui_draw_rectangle(imgui, rect, color_fills);
+
+                    Color color_outlines;
+                    if (selections[i])
+                    {
+                        d2d_color_set_i(&color_outlines, 77 * 1.5, 99 * 1.5, 140 * 1.5, 255);
+                    }
+                    else
+                    {
+                        d2d_color_set_i(&color_outlines, 77, 99, 140, 255);
+                    }
+                    imgui_draw_rectangle_outline(imgui, rect, color_outlines);
+
+                    Color color_text;
+                    if (selections[i])
+                    {
+                        d2d_color_set_i(&color_text, 255, 255, 255, 255);
+                    }
+                    else if (hover)
+                    {
+                        d2d_color_set_i(&color_text, 255, 255, 255, 255);
+                    }
+                    else
+                    {
+                        d2d_color_set_i(&color_text, 250, 250, 250, 255);
+                    }
+
+                    char *caption = &captions[i * sizeof(char) * stride];
+
+                    Vector2f position;
+                    position.x = rect.x + 6;
+                    position.y = temp_posy + (rect_header.height / 2) - (font->font_size + font->padding) / 2;
+
+                    Rectangle_f clip =
+                    {
+                        rect_header.x,
+                        rect_header.y + 32,
+                        rect_header.width,
+                        rect_header.height * (display_count + 1) - 32
+                    };
+
+                    imgui_push_clip(imgui, clip);
+                    imgui_draw_text(imgui, font, caption, 12, position, color_text);
+                    imgui_pop_clip(imgui);
+                }
+            }
+        }
+
+        if (children_count > 16)
+        {
+            scroll_bar.y = imgui->scroll_bar_y;
+
+            Color color;
+            d2d_color_set_i(&color, 50, 64, 91, 255);
+            imgui_draw_rectangle(imgui, scroll_area, color);
+            d2d_color_set_i(&color, 66 * 0.5, 84 * 0.5, 120 * 0.5, 255);
+            imgui_draw_rectangle(imgui, scroll_bar, color);
+
+            d2d_color_set_i(&color, 255, 255, 255, 255);
+            imgui_draw_rectangle_outline(imgui, scroll_area, color);
+            imgui_draw_rectangle_outline(imgui, scroll_bar, color);
+        }
     }
 
-    if (rect->y + 32 < min)
+    Color color;
+    d2d_color_set_i(&color, 50, 64, 91, 255);
+    imgui_draw_rectangle(imgui, rect_header, color);
+    d2d_color_set_i(&color, 255, 255, 255, 255);
+    imgui_draw_rectangle_outline(imgui, rect_header, color);
+
+    Color color_text;
+    Vector2f position;
+    position.x = rect_header.x + 6;
+    position.y = rect_header.y + (rect_header.height / 2) - (font->font_size + font->padding) / 2;
+    //renderer_sprite_font_add_text(renderer_sprite_font, font, "lol", 12, position, color_text);
+
+    return event;
+}
+int8_t imgui_list_init(ImGuiList* list
+                      ,uint32_t   count
+                      ,float      row_height
+                      )
+{
+    list->heights = malloc(sizeof(float) * count);
+    list->tree    = malloc(sizeof(float) * (count + 1));
+
+    if (list->heights == NULL || list->tree == NULL)
+    {
+        fprintf(stderr, "Error allocating list index for %u rows\n", count);
+        free(list->heights);
+        free(list->tree);
+        list->heights = NULL;
+        list->tree    = NULL;
+        return DELO_ERROR;
+    }
+
+    list->count              = count;
+    list->scroll             = 0;
+    list->scroll_target      = 0;
+    list->cursor             = -1;
+    list->hold_scroll_bar    = 0;
+    list->scroll_bar_delta_y = 0;
+
+    list->tree[0] = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        list->heights[i]  = row_height;
+        list->tree[i + 1] = row_height;
+    }
+
+    // Builds the Fenwick tree in place, each node pushes its partial sum to its parent once.
+    for (uint32_t i = 1; i <= count; i++)
+    {
+        uint32_t parent = i + (i & -i);
+
+        if (parent <= count)
+        {
+            list->tree[parent] += list->tree[i];
+        }
+    }
+
+    return DELO_SUCCESS;
+}
+void imgui_list_free(ImGuiList* list)
+{
+    free(list->heights);
+    free(list->tree);
+    list->heights = NULL;
+    list->tree    = NULL;
+    list->count   = 0;
+}
+void imgui_list_set_row_height(ImGuiList* list
+                              ,uint32_t   index
+                              ,float      height
+                              )
+{
+    float delta = height - list->heights[index];
+
+    list->heights[index] = height;
+
+    for (uint32_t i = index + 1; i <= list->count; i += i & -i)
+    {
+        list->tree[i] += delta;
+    }
+}
+float imgui_list_row_offset(ImGuiList* list
+                           ,uint32_t   index
+                           )
+{
+    float offset = 0;
+
+    for (uint32_t i = index; i > 0; i -= i & -i)
+    {
+        offset += list->tree[i];
+    }
+
+    return offset;
+}
+uint32_t imgui_list_row_at(ImGuiList* list
+                          ,float      offset
+                          )
+{
+    uint32_t index = 0;
+    uint32_t step  = 1;
+
+    while (step * 2 <= list->count)
+    {
+        step *= 2;
+    }
+
+    // Descends the tree to the last row whose start lies at or before the offset.
+    for (; step > 0; step /= 2)
+    {
+        if (index + step <= list->count && list->tree[index + step] <= offset)
+        {
+            index  += step;
+            offset -= list->tree[index];
+        }
+    }
+
+    return (index < list->count) ? index : list->count - 1;
+}
+ListEvent imgui_list(ImGui*         imgui
+                    ,int32_t        id
+                    ,Rectangle_f    rect_bounds
+                    ,ImGuiList*     list
+                    ,ImGuiListRowFn row_fn
+                    ,void*          user_data
+                    )
+{
+    ListEvent event;
+    event.changed = 0;
+    event.index   = -1;
+
+    if (list->count == 0)
+    {
+        return event;
+    }
+
+    SpriteFont *font = imgui->font;
+
+    float mouse_position_x = imgui->hid_state->mouse_position_x;
+    float mouse_position_y = imgui->hid_state->mouse_position_y;
+
+    uint8_t mouse_button_left      = imgui->hid_state->mouse_button_left;
+    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+
+    uint8_t click   = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE);
+    uint8_t hold    = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_PRESS);
+    uint8_t release = (mouse_button_left == GLFW_RELEASE && mouse_button_left_prev == GLFW_PRESS);
+
+    float total_height = imgui_list_row_offset(list, list->count);
+    float max_scroll   = fmaxf(0, total_height - rect_bounds.height);
+
+    Rectangle_f rect_rows = rect_bounds;
+
+    if (max_scroll > 0)
+    {
+        rect_rows.width -= IMGUI_LIST_SCROLL_BAR_WIDTH;
+    }
+
+    Rectangle_f scroll_area = {rect_rows.x + rect_rows.width, rect_bounds.y, IMGUI_LIST_SCROLL_BAR_WIDTH, rect_bounds.height};
+    Rectangle_f scroll_bar  = scroll_area;
+
+    if (max_scroll > 0)
+    {
+        scroll_bar.height = fmaxf(IMGUI_LIST_SCROLL_BAR_WIDTH, rect_bounds.height * rect_bounds.height / total_height);
+        scroll_bar.y      = scroll_area.y + (scroll_area.height - scroll_bar.height) * (list->scroll / max_scroll);
+    }
+
+    uint8_t within = d2d_rectangle_within_bounds(&rect_rows, mouse_position_x, mouse_position_y)
+                  && mouse_position_y - rect_rows.y + list->scroll < total_height;
+    int32_t hover  = within ? (int32_t)imgui_list_row_at(list, mouse_position_y - rect_rows.y + list->scroll) : -1;
+
+    if (click)
+    {
+        if (max_scroll > 0 && d2d_rectangle_within_bounds(&scroll_bar, mouse_position_x, mouse_position_y))
+        {
+            imgui->active_id         = id;
+            list->hold_scroll_bar    = 1;
+            list->scroll_bar_delta_y = scroll_bar.y - mouse_position_y;
+        }
+        else if (within)
+        {
+            imgui->active_id = id;
+            list->cursor     = hover;
+            event.changed    = 1;
+            event.index      = hover;
+        }
+        else if (imgui->active_id == id && !d2d_rectangle_within_bounds(&scroll_area, mouse_position_x, mouse_position_y))
+        {
+            imgui->active_id = 0;
+        }
+    }
+    else if (hold && list->hold_scroll_bar)
+    {
+        float norm = (mouse_position_y + list->scroll_bar_delta_y - scroll_area.y) / (scroll_area.height - scroll_bar.height);
+
+        list->scroll_target = max_scroll * fminf(fmaxf(norm, 0), 1);
+        list->scroll        = list->scroll_target;
+    }
+    else if (release)
+    {
+        list->hold_scroll_bar    = 0;
+        list->scroll_bar_delta_y = 0;
+    }
+
+    double *scroll_y = &imgui->context->glfw_callback_data.scroll_y;
+
+    if (*scroll_y != 0 && d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
+    {
+        list->scroll_target -= (float)*scroll_y * IMGUI_LIST_SCROLL_STEP;
+        *scroll_y = 0;
+    }
+
+    if (imgui->active_id == id)
+    {
+        HidState *hid_state      = imgui->hid_state;
+        HidState *hid_state_prev = imgui->hid_state_prev;
+
+        int32_t cursor = list->cursor;
+
+        if (hid_state->key_arrow_down == GLFW_PRESS && hid_state_prev->key_arrow_down == GLFW_RELEASE)
+        {
+            cursor = (cursor + 1 < (int32_t)list->count) ? cursor + 1 : (int32_t)list->count - 1;
+        }
+        else if (hid_state->key_arrow_up == GLFW_PRESS && hid_state_prev->key_arrow_up == GLFW_RELEASE)
+        {
+            cursor = (cursor > 0) ? cursor - 1 : 0;
+        }
+        else if (cursor >= 0 && hid_state->key_enter == GLFW_PRESS && hid_state_prev->key_enter == GLFW_RELEASE)
+        {
+            event.changed = 1;
+            event.index   = cursor;
+        }
+
+        // Keyboard moves scroll just far enough to bring the cursor row into view.
+        if (cursor != list->cursor)
+        {
+            float top    = imgui_list_row_offset(list, cursor);
+            float bottom = top + list->heights[cursor];
+
+            if (top < list->scroll_target)
+            {
+                list->scroll_target = top;
+            }
+            else if (bottom > list->scroll_target + rect_bounds.height)
+            {
+                list->scroll_target = bottom - rect_bounds.height;
+            }
+
+            list->cursor = cursor;
+        }
+    }
+
+    list->scroll_target = fminf(fmaxf(list->scroll_target, 0), max_scroll);
+
+    float step = fminf(1.0f, (float)imgui->context->dt * IMGUI_LIST_SCROLL_SMOOTHING);
+
+    list->scroll += (list->scroll_target - list->scroll) * step;
+
+    if (fabsf(list->scroll_target - list->scroll) < 0.5f)
     {
-        return 0;
+        list->scroll = list->scroll_target;
     }
-    else
+
+    Color color;
+    d2d_color_set_i(&color, 50, 64, 91, 255);
+    imgui_draw_rectangle(imgui, rect_bounds, color);
+
+    imgui_push_clip(imgui, rect_rows);
+
+    uint32_t first = imgui_list_row_at(list, list->scroll);
+    float    y     = rect_rows.y + imgui_list_row_offset(list, first) - list->scroll;
+
+    for (uint32_t i = first; i < list->count && y < rect_rows.y + rect_rows.height; i++)
     {
-        if (rect->y < min)
+        ImGuiListRow row = {NULL, 0};
+        row_fn(user_data, i, &row);
+
+        Rectangle_f rect = {rect_rows.x, y, rect_rows.width, list->heights[i]};
+
+        Color color_fills;
+        if (row.selected)
         {
-            rect->height = rect->y - min;
-            rect->y += 32 - rect->height;
-            return 1;
+            d2d_color_set_i(&color_fills, 66 * 1.5, 84 * 1.5, 120 * 1.5, 255);
         }
-    }
-    return 1;
-}
-DropdownEvent imgui_dropdown(ImGui*      imgui
-                      ,int32_t     id
-                      ,Rectangle_f rect_header
-                      ,char*       captions
-                      ,uint8_t*    selections
-                      ,uint16_t    children_count
-                      ,uint16_t    stride
-                      )
-{
-    DropdownEvent event;
-    event.changed = 0;
+        else if ((int32_t)i == hover || (imgui->active_id == id && (int32_t)i == list->cursor))
+        {
+            d2d_color_set_i(&color_fills, 66 * 0.5, 84 * 0.5, 120 * 0.5, 255);
+        }
+        else
+        {
+            d2d_color_set_i(&color_fills, 50, 64, 91, 255);
+        }
+        imgui_draw_rectangle(imgui, rect, color_fills);
 
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    SpriteFont *font = imgui->font;
+        Color color_outlines;
+        d2d_color_set_i(&color_outlines, 77, 99, 140, 255);
+        imgui_draw_rectangle_outline(imgui, rect, color_outlines);
 
-    float mouse_position_x = imgui->hid_state->mouse_position_x;
-    float mouse_position_y = imgui->hid_state->mouse_position_y;
+        if (row.caption != NULL)
+        {
+            Color color_text;
+            d2d_color_set_i(&color_text, 250, 250, 250, 255);
 
-    uint8_t mouse_button_left = imgui->hid_state->mouse_button_left;
-    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+            Vector2f position;
+            position.x = rect.x + 6;
+            position.y = rect.y + (rect.height / 2) - (font->font_size + font->padding) / 2;
 
-    uint8_t display_count = children_count <= 16 ? children_count : 16;
+            imgui_draw_text(imgui, font, row.caption, 0, position, color_text);
+        }
 
-    Rectangle_f scroll_area = (Rectangle_f)
-    {
-        rect_header.x + rect_header.width,
-        rect_header.y + rect_header.height,
-        16, rect_header.height * display_count
-    };
-    Rectangle_f scroll_bar = (Rectangle_f)
+        y += list->heights[i];
+    }
+
+    imgui_pop_clip(imgui);
+
+    if (max_scroll > 0)
     {
-        scroll_area.x,
-        scroll_area.y,
-        16, scroll_area.height * 0.1
-    };
+        d2d_color_set_i(&color, 66 * 0.5, 84 * 0.5, 120 * 0.5, 255);
+        imgui_draw_rectangle(imgui, scroll_bar, color);
 
-    float children_offset = 0;
-    uint8_t multi_select = imgui->hid_state->key_ctrl_left;
+        d2d_color_set_i(&color, 255, 255, 255, 255);
+        imgui_draw_rectangle_outline(imgui, scroll_area, color);
+        imgui_draw_rectangle_outline(imgui, scroll_bar, color);
+    }
 
-    uint8_t click = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE);
-    uint8_t hold = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_PRESS);
-    uint8_t release = (mouse_button_left == GLFW_RELEASE && mouse_button_left_prev == GLFW_PRESS);
+    d2d_color_set_i(&color, 255, 255, 255, 255);
+    imgui_draw_rectangle_outline(imgui, rect_bounds, color);
 
-    if (click)
+    return event;
+}
+void imgui_plot_init(ImGuiPlot* plot
+                    ,float      x_min
+                    ,float      x_max
+                    )
+{
+    plot->x_min    = x_min;
+    plot->x_max    = x_max;
+    plot->y_min    = 0;
+    plot->y_max    = 1;
+    plot->fit_y    = 1;
+    plot->follow   = 1;
+    plot->dragging = 0;
+    plot->drag_x   = 0;
+}
+// Emits the decimated columns as a band, two vertices per column, in chunks that fit the 16 bit draw list indices.
+static void imgui_plot_band(ImGui*      imgui
+                           ,Vector2f*   values
+                           ,uint32_t    columns
+                           ,Rectangle_f rect
+                           ,ImGuiPlot*  plot
+                           ,Color       color
+                           ,Vector2f*   points
+                           )
+{
+    ImGuiDrawList *draw_list = &imgui->draw_list;
+
+    float scale = rect.height / (plot->y_max - plot->y_min);
+    float step  = rect.width / columns;
+
+    // Chunks overlap by a column so the band stays connected across them.
+    for (uint32_t chunk = 0; chunk < columns; chunk += IMGUI_PLOT_CHUNK - 1)
     {
-        if (d2d_rectangle_within_bounds(&rect_header, mouse_position_x, mouse_position_y))
-        {
-            imgui->collapsed = !imgui->collapsed;
+        uint32_t chunk_end    = (chunk + IMGUI_PLOT_CHUNK < columns) ? chunk + IMGUI_PLOT_CHUNK : columns;
+        uint32_t vertex_count = 0;
+        uint32_t index_count  = 0;
 
-            if (imgui->collapsed)
+        for (uint32_t c = chunk; c < chunk_end; c++)
+        {
+            if (values[c].x > values[c].y)
             {
-                if (imgui->active_id == id)
-                {
-                    imgui->active_id = 0;
-                }
+                continue;
             }
-            else
+
+            float top    = rect.y + rect.height - (values[c].y - plot->y_min) * scale;
+            float bottom = rect.y + rect.height - (values[c].x - plot->y_min) * scale;
+            float pad    = fmaxf(0, 1 - (bottom - top)) * 0.5f;
+            float x      = rect.x + step * (c + 0.5f);
+
+            points[vertex_count++] = (Vector2f){x, top - pad};
+            points[vertex_count++] = (Vector2f){x, bottom + pad};
+
+            if (c > chunk && values[c - 1].x <= values[c - 1].y)
             {
-                imgui->active_id = id;
-                imgui->scroll_bar_y = scroll_area.y;
+                index_count += 6;
             }
         }
-    }
 
-    if (imgui->active_id == id)
-    {
-        scroll_bar.y = imgui->scroll_bar_y;
+        int32_t first = (vertex_count > 0) ? imgui_draw_list_reserve(imgui, points, vertex_count, index_count, 0) : -1;
 
-        if (click)
+        if (first != -1)
         {
-            Rectangle_f rect_bounds = {rect_header.x, rect_header.y, rect_header.width, rect_header.height * display_count + 32};
+            uint32_t  v = first;
+            uint16_t *i = &draw_list->indices[draw_list->index_count - index_count];
 
-            if (!d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y))
-            {
-                if (!d2d_rectangle_within_bounds(&scroll_area, mouse_position_x, mouse_position_y))
-                {
-                    imgui->collapsed = 1;
-                    imgui->active_id = 0;
-                }
-            }
-            if (d2d_rectangle_within_bounds(&scroll_bar, mouse_position_x, mouse_position_y))
+            for (uint32_t p = 0; p < vertex_count; p++)
             {
-                imgui->hold_scroll_bar = 1;
-                imgui->scroll_bar_delta_y = scroll_bar.y - mouse_position_y;
-                printf("lol på dig davi\n");
+                draw_list->vertices[first + p] = (ImGuiVertex){points[p], {0, 0}, color, IMGUI_MODE_SOLID};
             }
-        }
-        else if (hold)
-        {
-            if (imgui->hold_scroll_bar)
+
+            for (uint32_t c = chunk; c < chunk_end; c++)
             {
-                scroll_bar.y = mouse_position_y + imgui->scroll_bar_delta_y;
-                if (scroll_bar.y < scroll_area.y)
+                if (values[c].x > values[c].y)
                 {
-                    scroll_bar.y = scroll_area.y;
+                    continue;
                 }
-                else if (scroll_bar.y + scroll_bar.height > scroll_area.y + scroll_area.height)
+
+                if (c > chunk && values[c - 1].x <= values[c - 1].y)
                 {
-                    scroll_bar.y = scroll_area.y + scroll_area.height - scroll_bar.height;
+                    *i++ = v - 2;
+                    *i++ = v;
+                    *i++ = v + 1;
+                    *i++ = v - 2;
+                    *i++ = v + 1;
+                    *i++ = v - 1;
                 }
-                imgui->scroll_bar_y = scroll_bar.y;
+
+                v += 2;
             }
         }
-        else if (release)
+
+        if (chunk_end == columns)
         {
-            imgui->hold_scroll_bar = 0;
-            imgui->scroll_bar_delta_y = 0;
+            break;
         }
+    }
+}
+// Drag pans, the wheel zooms around the cursor. While following, the view keeps its width and tracks the newest sample.
+PlotEvent imgui_plot(ImGui*      imgui
+                    ,int32_t     id
+                    ,Rectangle_f rect_bounds
+                    ,ImGuiPlot*  plot
+                    ,PlotSeries* series
+                    ,uint32_t    series_count
+                    ,Color*      colors
+                    )
+{
+    PlotEvent event;
+    event.changed = 0;
 
-        if (!imgui->collapsed)
+    float mouse_position_x = imgui->hid_state->mouse_position_x;
+    float mouse_position_y = imgui->hid_state->mouse_position_y;
+
+    uint8_t mouse_button_left      = imgui->hid_state->mouse_button_left;
+    uint8_t mouse_button_left_prev = imgui->hid_state_prev->mouse_button_left;
+
+    uint8_t click   = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_RELEASE);
+    uint8_t hold    = (mouse_button_left == GLFW_PRESS && mouse_button_left_prev == GLFW_PRESS);
+    uint8_t release = (mouse_button_left == GLFW_RELEASE && mouse_button_left_prev == GLFW_PRESS);
+    uint8_t within  = d2d_rectangle_within_bounds(&rect_bounds, mouse_position_x, mouse_position_y);
+
+    float x_last = -FLT_MAX;
+
+    for (uint32_t s = 0; s < series_count; s++)
+    {
+        if (series[s].count > 0)
         {
-            float min = scroll_area.y;
-            float max = (scroll_area.y + scroll_area.height - scroll_bar.height);
-            float current = scroll_bar.y;
-            float norm = (current - min) / (max - min);
+            x_last = fmaxf(x_last, series[s].x_start + (series[s].count - 1) * series[s].x_step);
+        }
+    }
 
-            children_offset = (children_count - display_count) * 32 * norm;
+    float width = plot->x_max - plot->x_min;
 
-            for (int i = 0; i < children_count; i++)
-            {
-                uint8_t hover = 0;
-                Rectangle_f rect =
-                {
-                    rect_header.x,
-                    rect_header.y + 32 * (i + 1),
-                    rect_header.width,
-                    rect_header.height
-                };
-                rect.y -= children_offset;
+    if (plot->follow && x_last != -FLT_MAX)
+    {
+        plot->x_max = x_last;
+        plot->x_min = x_last - width;
+    }
 
-                float temp_posy = rect.y;
+    if (click && within)
+    {
+        imgui->active_id = id;
+        plot->dragging   = 1;
+        plot->drag_x     = mouse_position_x;
+    }
+    else if (hold && plot->dragging)
+    {
+        float dx = (mouse_position_x - plot->drag_x) / rect_bounds.width * width;
 
-                uint8_t within_bounds = lol2(&rect, rect_header.y, rect_header.y + (32 * (display_count + 1)));
+        if (dx != 0)
+        {
+            plot->x_min   -= dx;
+            plot->x_max   -= dx;
+            plot->drag_x   = mouse_position_x;
+            plot->follow   = 0;
+            event.changed  = 1;
+        }
+    }
+    else if (release && plot->dragging)
+    {
+        // Dropping the view at or past the newest sample resumes following.
+        plot->dragging = 0;
+        plot->follow   = (x_last != -FLT_MAX && plot->x_max >= x_last);
 
-                if (within_bounds)
-                {
-                    if (d2d_rectangle_within_bounds(&rect, mouse_position_x, mouse_position_y))
-                    {
-                        hover = 1;
-                        if (click)
-                        {
-                            if (!multi_select)
-                            {
-                                for (int i = 0; i < children_count; i++)
-                                {
-                                    selections[i] = 0;
-                                }
-                                imgui->collapsed = 1;
-                                imgui->active_id = 0;
-                            }
-                            selections[i] = !selections[i];
-                            event.changed = 1;
-                        }
-                    }
+        if (imgui->active_id == id)
+        {
+            imgui->active_id = 0;
+        }
+    }
 
-                    Color color_fills;
-                    if (selections[i])
-                    {
-                        d2d_color_set_i(&color_fills, 66 * 1.5, 84 * 1.5, 120 * 1.5, 255);
-                    }
-                    else if (hover)
-                    {
-                        d2d_color_set_i(&color_fills, 66 * 0.5, 84 * 0.5, 120 * 0.5, 255);
-                    }
-                    else
-                    {
-                        d2d_color_set_i(&color_fills, 50, 64, 91, 255);
-                    }
+    double *scroll_y = &imgui->context->glfw_callback_data.scroll_y;
 
-                    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect, color_fills);
+    if (*scroll_y != 0 && within)
+    {
+        float factor = powf(IMGUI_PLOT_ZOOM_STEP, (float)-*scroll_y);
+        float anchor = plot->follow ? plot->x_max : plot->x_min + (mouse_position_x - rect_bounds.x) / rect_bounds.width * width;
 
-                    Color color_outlines;
-                    if (selections[i])
-                    {
-                        d2d_color_set_i(&color_outlines, 77 * 1.5, 99 * 1.5, 140 * 1.5, 255);
-                    }
-                    else
-                    {
-                        d2d_color_set_i(&color_outlines, 77, 99, 140, 255);
-                    }
-                    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect, color_outlines);
+        plot->x_min   = anchor + (plot->x_min - anchor) * factor;
+        plot->x_max   = anchor + (plot->x_max - anchor) * factor;
+        event.changed = 1;
+        *scroll_y     = 0;
+    }
 
-                    Color color_text;
-                    if (selections[i])
-                    {
-                        d2d_color_set_i(&color_text, 255, 255, 255, 255);
-                    }
-                    else if (hover)
-                    {
-                        d2d_color_set_i(&color_text, 255, 255, 255, 255);
-                    }
-                    else
-                    {
-                        d2d_color_set_i(&color_text, 250, 250, 250, 255);
-                    }
+    uint32_t  columns = (rect_bounds.width > 2) ? (uint32_t)rect_bounds.width - 2 : 1;
+    Arena    *scratch = d2d_frame_scratch(imgui->context);
+    ArenaMark mark    = d2d_arena_mark(scratch);
+    Vector2f *values  = d2d_arena_alloc(scratch, sizeof(Vector2f) * columns * series_count);
+    Vector2f *points  = d2d_arena_alloc(scratch, sizeof(Vector2f) * IMGUI_PLOT_CHUNK * 2);
 
-                    char *caption = &captions[i * sizeof(char) * stride];
+    Color color;
+    d2d_color_set_i(&color, 50, 64, 91, 255);
+    imgui_draw_rectangle(imgui, rect_bounds, color);
 
-                    Vector2f position;
-                    position.x = rect.x + 6;
-                    position.y = temp_posy + (rect_header.height / 2) - (font->font_size + font->padding) / 2;
+    if (values != NULL && points != NULL)
+    {
+        float y_min = FLT_MAX;
+        float y_max = -FLT_MAX;
 
-                    Vector2f limit_y = {0, 0};
-                    limit_y.x = rect_header.y + 32;
-                    limit_y.y = rect_header.y + (rect_header.height * (display_count + 1));
+        for (uint32_t s = 0; s < series_count; s++)
+        {
+            Vector2f *column = &values[s * columns];
 
-                    d2d_renderer_sprite_font_add_text(renderer_sprite_font, font, caption, 12, position, color_text, limit_y);
-                }
+            d2d_plot_series_decimate(&series[s], plot->x_min, plot->x_max, columns, column);
+
+            for (uint32_t c = 0; c < columns; c++)
+            {
+                y_min = fminf(y_min, column[c].x);
+                y_max = fmaxf(y_max, column[c].y);
             }
         }
 
-        if (children_count > 16)
+        if (plot->fit_y && y_min <= y_max)
         {
-            scroll_bar.y = imgui->scroll_bar_y;
+            float margin = (y_max > y_min) ? (y_max - y_min) * 0.05f : 1;
 
-            Color color;
-            d2d_color_set_i(&color, 50, 64, 91, 255);
-            d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, scroll_area, color);
-            d2d_color_set_i(&color, 66 * 0.5, 84 * 0.5, 120 * 0.5, 255);
-            d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, scroll_bar, color);
+            plot->y_min = y_min - margin;
+            plot->y_max = y_max + margin;
+        }
 
-            d2d_color_set_i(&color, 255, 255, 255, 255);
-            d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, scroll_area, color);
-            d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, scroll_bar, color);
+        Rectangle_f rect_plot = {rect_bounds.x + 1, rect_bounds.y + 1, rect_bounds.width - 2, rect_bounds.height - 2};
+
+        imgui_push_clip(imgui, rect_plot);
+
+        for (uint32_t s = 0; s < series_count; s++)
+        {
+            imgui_plot_band(imgui, &values[s * columns], columns, rect_plot, plot, colors[s], points);
         }
+
+        imgui_pop_clip(imgui);
     }
 
-    Color color;
-    d2d_color_set_i(&color, 50, 64, 91, 255);
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect_header, color);
-    d2d_color_set_i(&color, 255, 255, 255, 255);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect_header, color);
+    d2d_arena_release(scratch, mark);
 
-    Color color_text;
-    Vector2f position;
-    position.x = rect_header.x + 6;
-    position.y = rect_header.y + (rect_header.height / 2) - (font->font_size + font->padding) / 2;
-    //renderer_sprite_font_add_text(renderer_sprite_font, font, "lol", 12, position, color_text, (Vector2f){0, 0});
+    d2d_color_set_i(&color, 255, 255, 255, 255);
+    imgui_draw_rectangle_outline(imgui, rect_bounds, color);
 
     return event;
 }
@@ -766,9 +2131,6 @@ TextboxEvent imgui_textbox(ImGui*      imgui
 {
     TextboxEvent event = {0};
     
-    RendererSpriteFont *renderer_sprite_font       = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills    = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
     SpriteFont *font = imgui->font;
 
     float mouse_position_x = imgui->hid_state->mouse_position_x;
@@ -998,9 +2360,9 @@ TextboxEvent imgui_textbox(ImGui*      imgui
 
     Color color;
     d2d_color_set_i(&color, 50, 64, 91, 255);
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect_bounds, color);
+    imgui_draw_rectangle(imgui, rect_bounds, color);
     d2d_color_set_i(&color, 101, 129, 184, 255);
-    d2d_renderer_primitive_add_rectangle_outline(renderer_primitive_outlines, rect_bounds, color);
+    imgui_draw_rectangle_outline(imgui, rect_bounds, color);
 
     if(imgui->active_id == id)
     {
@@ -1030,7 +2392,7 @@ TextboxEvent imgui_textbox(ImGui*      imgui
             rect.y = rect_bounds.y + rect.height*0.5;
 
 
-            d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, rect, color);
+            imgui_draw_rectangle(imgui, rect, color);
             
         }
 
@@ -1056,7 +2418,7 @@ TextboxEvent imgui_textbox(ImGui*      imgui
             d2d_color_set_i(&color, 255, 255, 255, 0);
         }
 
-        d2d_renderer_primitive_add_rectangle(renderer_primitive_fills, (Rectangle_f){p.x, p.y, 2, font->font_size}, color);
+        imgui_draw_rectangle(imgui, (Rectangle_f){p.x, p.y, 2, font->font_size}, color);
 
 
     }
@@ -1084,13 +2446,13 @@ TextboxEvent imgui_textbox(ImGui*      imgui
         if(length > 0)
         {   
 
-            d2d_renderer_sprite_font_add_text(renderer_sprite_font
-                                         ,font
-                                         ,&text[offset]
-                                         ,max_display_length
-                                         ,position
-                                         ,color_text,(Vector2f){0,0}
-                                         );
+            imgui_draw_text(imgui
+                           ,font
+                           ,&text[offset]
+                           ,max_display_length
+                           ,position
+                           ,color_text
+                           );
         }
     }
     else
@@ -1101,13 +2463,13 @@ TextboxEvent imgui_textbox(ImGui*      imgui
             memset(imgui->text_password,'*',sizeof(char)*len);
             imgui->text_password[len-1] = '\0';
 
-            d2d_renderer_sprite_font_add_text(renderer_sprite_font
-                                         ,font
-                                         ,&imgui->text_password[offset]
-                                         ,max_display_length
-                                         ,position
-                                         ,color_text,(Vector2f){0,0}
-                                         );
+            imgui_draw_text(imgui
+                           ,font
+                           ,&imgui->text_password[offset]
+                           ,max_display_length
+                           ,position
+                           ,color_text
+                           );
         }
         
     }
@@ -1120,8 +2482,7 @@ TextboxEvent imgui_textbox(ImGui*      imgui
 
 void imgui_label(ImGui *imgui, int32_t id, Vector2f position, char* caption, Color color)
 {
-    RendererSpriteFont *renderer_sprite_font = &imgui->renderer_sprite_font;
-    d2d_renderer_sprite_font_add_text(renderer_sprite_font, imgui->font, caption, 0, position, color,(Vector2f){0,0});
+    imgui_draw_text(imgui, imgui->font, caption, 0, position, color);
 }
 
 void imgui_tabbar(ImGui*      imgui
@@ -1132,9 +2493,6 @@ void imgui_tabbar(ImGui*      imgui
                         ,Texture*    texture
                         )
 {
-    RendererPrimitive *renderer_primitive_fills    = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
-    RendererSprite *renderer_sprites               = &imgui->renderer_sprites;
 
     TabBarEvent event = {0};
     int32_t mpx = imgui->hid_state->mouse_position_x;
@@ -1230,21 +2588,17 @@ void imgui_tabbar(ImGui*      imgui
             }
 
             Rectangle_f *b = &tab_bounds;
-            d2d_renderer_primitive_add(renderer_primitive_fills,    (Vector2f){b->x,            b->y - top_left}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_fills,    (Vector2f){b->x + b->width, b->y - top_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_fills,    (Vector2f){b->x + b->width, b->y + b->height + bottom_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_fills,    (Vector2f){b->x + b->width, b->y + b->height + bottom_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_fills,    (Vector2f){b->x,            b->y + b->height + bottom_left}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_fills,    (Vector2f){b->x,            b->y - top_left}, color_fills);
-
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x, b->y - bottom_left}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x + b->width, b->y - bottom_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x + b->width, b->y - bottom_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x + b->width, b->y + b->height + top_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x + b->width, b->y + b->height + top_right}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x, b->y + b->height + top_left}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x, b->y + b->height + top_left}, color_fills);
-            d2d_renderer_primitive_add(renderer_primitive_outlines, (Vector2f){b->x, b->y - bottom_left}, color_fills);
+            imgui_draw_triangle(imgui, (Vector2f){b->x,            b->y - top_left}
+                                     , (Vector2f){b->x + b->width, b->y - top_right}
+                                     , (Vector2f){b->x + b->width, b->y + b->height + bottom_right}, color_fills);
+            imgui_draw_triangle(imgui, (Vector2f){b->x + b->width, b->y + b->height + bottom_right}
+                                     , (Vector2f){b->x,            b->y + b->height + bottom_left}
+                                     , (Vector2f){b->x,            b->y - top_left}, color_fills);
+
+            imgui_draw_line(imgui, (Vector2f){b->x, b->y - bottom_left}, (Vector2f){b->x + b->width, b->y - bottom_right}, color_fills, 1);
+            imgui_draw_line(imgui, (Vector2f){b->x + b->width, b->y - bottom_right}, (Vector2f){b->x + b->width, b->y + b->height + top_right}, color_fills, 1);
+            imgui_draw_line(imgui, (Vector2f){b->x + b->width, b->y + b->height + top_right}, (Vector2f){b->x, b->y + b->height + top_left}, color_fills, 1);
+            imgui_draw_line(imgui, (Vector2f){b->x, b->y + b->height + top_left}, (Vector2f){b->x, b->y - bottom_left}, color_fills, 1);
 
             Rectangle_f src = 
             {
@@ -1255,7 +2609,7 @@ void imgui_tabbar(ImGui*      imgui
                 64*i,0,64,64
             };
 
-            d2d_renderer_sprite_add(renderer_sprites,32+(64*i),64/2+8,64,64,64*i,64,64,64,texture, &color_sprite);
+            imgui_draw_sprite(imgui,(Rectangle_f){64*i,8,64,64},(Rectangle_f){64*i,64,64,64},texture,color_sprite);
         }
     
 }
@@ -1286,9 +2640,6 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
     event.month = month;
     event.day = day;
 
-    RendererSpriteFont *renderer_sprite_font       = &imgui->renderer_sprite_font;
-    RendererPrimitive *renderer_primitive_fills    = &imgui->renderer_primitive_fills;
-    RendererPrimitive *renderer_primitive_outlines = &imgui->renderer_primitive_outlines;
     SpriteFont *font = imgui->font;
 
     float mouse_position_x = imgui->hid_state->mouse_position_x;
@@ -1323,18 +2674,17 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
     char selected_date_string[128];
     
     snprintf(selected_date_string, sizeof(char)*128,"%02d-%02d-%02d",selected_year,selected_month,selected_day);
-    d2d_renderer_sprite_font_add_text(renderer_sprite_font
-                                 ,imgui->font,selected_date_string
-                                 ,200
-                                 ,(Vector2f){bounds_header.x + 82,bounds_header.y + 2}
-                                 ,(Color){1,1,1,1}
-                                 ,(Vector2f){0,0}
-                                 );
+    imgui_draw_text(imgui
+                   ,imgui->font,selected_date_string
+                   ,200
+                   ,(Vector2f){bounds_header.x + 82,bounds_header.y + 2}
+                   ,(Color){1,1,1,1}
+                   );
     
-    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills
-                                    ,bounds_header
-                                    ,(Color){0.15,0.15,0.15,1}
-                                    );
+    imgui_draw_rectangle(imgui
+                        ,bounds_header
+                        ,(Color){0.15,0.15,0.15,1}
+                        );
 
     if(imgui->active_id == id)
     {
@@ -1374,24 +2724,23 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
             }
         }
 
-        d2d_renderer_primitive_add_rectangle(renderer_primitive_fills,
+        imgui_draw_rectangle(imgui,
                                          bounds_calendar_bottom,
                                          (Color){0.1,0.1,0.1,1}
                                         );
                                         
-        d2d_renderer_primitive_add_rectangle(renderer_primitive_fills,
+        imgui_draw_rectangle(imgui,
                                          bounds_calendar_top, 
                                          (Color){0.15,0.15,0.15,1}
                                         );
         
-        d2d_renderer_sprite_font_add_text(renderer_sprite_font
-                                     ,imgui->font
-                                     ,"Mo  Tu  We  Th  Fr  Sa  Su"
-                                     ,200
-                                     ,(Vector2f){margin.x + bounds_calendar_top.x + x,margin.y + bounds_calendar_top.y + y + 58}
-                                     ,color_text
-                                     ,(Vector2f){0,0}
-                                     );
+        imgui_draw_text(imgui
+                       ,imgui->font
+                       ,"Mo  Tu  We  Th  Fr  Sa  Su"
+                       ,200
+                       ,(Vector2f){margin.x + bounds_calendar_top.x + x,margin.y + bounds_calendar_top.y + y + 58}
+                       ,color_text
+                       );
 
         time_info.tm_year = year - 1900; 
         time_info.tm_mon = month - 1;    
@@ -1410,14 +2759,13 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
 
         snprintf(month_str,sizeof(char)*128,"%i %s",year,month_names[month-1]);
 
-        d2d_renderer_sprite_font_add_text(renderer_sprite_font
-                                     ,imgui->font
-                                     ,month_str
-                                     ,200
-                                     ,(Vector2f){margin.x + bounds_calendar_top.x + 64,margin.y + bounds_calendar_top.y+26}
-                                     ,color_text
-                                     ,(Vector2f){0,0}
-                                     );
+        imgui_draw_text(imgui
+                       ,imgui->font
+                       ,month_str
+                       ,200
+                       ,(Vector2f){margin.x + bounds_calendar_top.x + 64,margin.y + bounds_calendar_top.y+26}
+                       ,color_text
+                       );
 
         for (size_t i = 0; i < count; i++)
         {
@@ -1430,32 +2778,31 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
                 margin.y + bounds_calendar_top.y + y + 96
             };
 
-            d2d_renderer_sprite_font_add_text(renderer_sprite_font
-                                         ,imgui->font
-                                         ,day_str
-                                         ,200
-                                         ,position
-                                         ,color_text
-                                         ,(Vector2f){0,0}
-                                         );
+            imgui_draw_text(imgui
+                           ,imgui->font
+                           ,day_str
+                           ,200
+                           ,position
+                           ,color_text
+                           );
             
             x+= 36;
 
             if(selected_day == i+1 && month == selected_month && year == selected_year)
             {
-                d2d_renderer_primitive_add_rectangle(renderer_primitive_fills
-                                                ,(Rectangle_f){position.x-6,position.y-2,32,28}
-                                                ,(Color){0,1,0,0.4}
-                                                ); 
+                imgui_draw_rectangle(imgui
+                                    ,(Rectangle_f){position.x-6,position.y-2,32,28}
+                                    ,(Color){0,1,0,0.4}
+                                    ); 
             }
             else if(mouse_position_x > position.x && mouse_position_x < position.x + 32)
             {
                 if(mouse_position_y > position.y && mouse_position_y < position.y + 28)
                 {
-                    d2d_renderer_primitive_add_rectangle(renderer_primitive_fills
-                                                    ,(Rectangle_f){position.x-6,position.y-2,32,28}
-                                                    ,(Color){0.4,0.4,0.4,0.4}
-                                                    ); 
+                    imgui_draw_rectangle(imgui
+                                        ,(Rectangle_f){position.x-6,position.y-2,32,28}
+                                        ,(Color){0.4,0.4,0.4,0.4}
+                                        ); 
                     
                     if(mouse_button_left == 1 && mouse_button_left_prev == 0)
                     {
@@ -1514,10 +2861,10 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
                     }
                 }
             }
-            d2d_renderer_primitive_add_rectangle(renderer_primitive_fills
-                                            ,button_month_previous
-                                            ,(Color){0.4,0.4,0.4,1.0}
-                                            ); 
+            imgui_draw_rectangle(imgui
+                                ,button_month_previous
+                                ,(Color){0.4,0.4,0.4,1.0}
+                                ); 
         }
         else if(d2d_rectangle_within_bounds(&button_month_next,mouse_position_x,mouse_position_y))
         {
@@ -1541,22 +2888,28 @@ DatePickerEvent imgui_datepicker(ImGui*   imgui
                     
                 }
             }
-            d2d_renderer_primitive_add_rectangle(renderer_primitive_fills
-                                            ,button_month_next
-                                            ,(Color){0.4,0.4,0.4,1.0}
-                                            ); 
+            imgui_draw_rectangle(imgui
+                                ,button_month_next
+                                ,(Color){0.4,0.4,0.4,1.0}
+                                ); 
         }
         
 
         Color color_arrow = {0.9,0.9,0.9,1};
 
-        d2d_renderer_primitive_add(renderer_primitive_fills,(Vector2f){button_month_previous.x+ 20 ,button_month_previous.y + 6 }, color_arrow);
-        d2d_renderer_primitive_add(renderer_primitive_fills,(Vector2f){button_month_previous.x+ 6  ,button_month_previous.y + 16}, color_arrow);
-        d2d_renderer_primitive_add(renderer_primitive_fills,(Vector2f){button_month_previous.x+ 20 ,button_month_previous.y + 24}, color_arrow);
-
-        d2d_renderer_primitive_add(renderer_primitive_fills,(Vector2f){button_month_next.x + 10  ,button_month_next.y + 6 },color_arrow);
-        d2d_renderer_primitive_add(renderer_primitive_fills,(Vector2f){button_month_next.x + 32-6,button_month_next.y + 16},color_arrow);
-        d2d_renderer_primitive_add(renderer_primitive_fills,(Vector2f){button_month_next.x + 10  ,button_month_next.y + 24},color_arrow);
+        imgui_draw_triangle(imgui
+                           ,(Vector2f){button_month_previous.x+ 20 ,button_month_previous.y + 6 }
+                           ,(Vector2f){button_month_previous.x+ 6  ,button_month_previous.y + 16}
+                           ,(Vector2f){button_month_previous.x+ 20 ,button_month_previous.y + 24}
+                           ,color_arrow
+                           );
+
+        imgui_draw_triangle(imgui
+                           ,(Vector2f){button_month_next.x + 10  ,button_month_next.y + 6 }
+                           ,(Vector2f){button_month_next.x + 32-6,button_month_next.y + 16}
+                           ,(Vector2f){button_month_next.x + 10  ,button_month_next.y + 24}
+                           ,color_arrow
+                           );
 
     }
 
@@ -3,68 +3,203 @@
 #include <delo2d.h>
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 
 #define COLOR_TRANSPARENT (Color){0,0,0,0}
 
 #define BRUSH_SQUARE 0
 #define BRUSH_ROUND  1
 
-static void pen_draw(RendererPrimitive* renderer,RendererCircle* renderer_circle, RenderTarget* layer, Vector2f point_a, Vector2f point_b, Color color, uint8_t thickness, uint32_t shader_brush)
+#define STROKE_MIN_CUTOFF 1.0f
+#define STROKE_BETA       0.02f
+#define STROKE_D_CUTOFF   1.0f
+
+typedef struct StrokeSample StrokeSample;
+struct StrokeSample
 {
-    int x1 = (int)round(point_a.x);
-    int y1 = (int)round(point_a.y); 
-    int x2 = (int)round(point_b.x); 
-    int y2 = (int)round(point_b.y);
+    Vector2f position;
+    float    pressure;
+};
 
-    
-    int dx = abs(x2 - x1);
-    int dy = abs(y2 - y1);
+typedef struct Stroke Stroke;
+struct Stroke
+{
+    StrokeSample samples[4];
+    StrokeSample last;
+    uint8_t      sample_count;
 
+    float spacing;
+    float carry;
 
-    int sx = x1 < x2 ? 1 : -1;
-    int sy = y1 < y2 ? 1 : -1;
+    Vector2f filtered;
+    Vector2f derivative;
+    double   time_prev;
 
-    int err = (dx > dy ? dx : -dy) / 2;
-    int e2 = err;
+    Color    color;
+    float    thickness;
 
+    uint32_t stamps;
+    double   seconds;
+};
 
-    glBindFramebuffer(GL_FRAMEBUFFER, layer->fbo);
+static float stroke_alpha(float cutoff, float dt)
+{
+    float tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}
+// One-euro filter, smooths jitter at low speed and keeps latency low at high speed.
+static Vector2f stroke_filter(Stroke* stroke, Vector2f position, double time)
+{
+    float dt = (float)(time - stroke->time_prev);
 
-    glViewport(0, 0, layer->texture.width, layer->texture.height);
+    if (dt <= 0.0f)
+    {
+        dt = 1.0f / 1000.0f;
+    }
+
+    Vector2f derivative = {(position.x - stroke->filtered.x) / dt, (position.y - stroke->filtered.y) / dt};
 
-    //renderer_primitive_begin(renderer,&layer->projection,(GLuint*)&shader_brush,DELO_TRIANGLE_LIST);
+    float a_d = stroke_alpha(STROKE_D_CUTOFF, dt);
+    stroke->derivative.x += (derivative.x - stroke->derivative.x) * a_d;
+    stroke->derivative.y += (derivative.y - stroke->derivative.y) * a_d;
 
+    float speed  = sqrtf(stroke->derivative.x * stroke->derivative.x + stroke->derivative.y * stroke->derivative.y);
+    float a      = stroke_alpha(STROKE_MIN_CUTOFF + STROKE_BETA * speed, dt);
 
-    d2d_renderer_circle_begin(renderer_circle,&layer->projection,(GLuint*)&shader_brush);
-        
+    stroke->filtered.x += (position.x - stroke->filtered.x) * a;
+    stroke->filtered.y += (position.y - stroke->filtered.y) * a;
+    stroke->time_prev   = time;
 
-    glUseProgram(shader_brush);
-    //glUniform1f(glGetUniformLocation(shader_brush, "u_thickness"), thickness);
+    return stroke->filtered;
+}
+static StrokeSample stroke_catmull_rom(StrokeSample* p, float t)
+{
+    float t2 = t * t;
+    float t3 = t2 * t;
+
+    float w0 = -0.5f * t3 + t2 - 0.5f * t;
+    float w1 =  1.5f * t3 - 2.5f * t2 + 1.0f;
+    float w2 = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+    float w3 =  0.5f * t3 - 0.5f * t2;
+
+    StrokeSample sample;
+    sample.position.x = p[0].position.x * w0 + p[1].position.x * w1 + p[2].position.x * w2 + p[3].position.x * w3;
+    sample.position.y = p[0].position.y * w0 + p[1].position.y * w1 + p[2].position.y * w2 + p[3].position.y * w3;
+    sample.pressure   = p[1].pressure + (p[2].pressure - p[1].pressure) * t;
+
+    return sample;
+}
+// Stamps the curve between samples[1] and samples[2] at brush spacing, carrying leftover distance into the next segment.
+static void stroke_segment(Stroke* stroke, RendererCircle* renderer)
+{
+    StrokeSample *p = stroke->samples;
 
-    //glUniform1f(glGetUniformLocation(shader_brush, "u_back_buffer_height"),(float)viewportHeight);
-  
-    while (1) 
+    float dx = p[2].position.x - p[1].position.x;
+    float dy = p[2].position.y - p[1].position.y;
+
+    uint32_t steps = (uint32_t)ceilf(sqrtf(dx * dx + dy * dy) / stroke->spacing) * 2 + 1;
+
+    StrokeSample a = p[1];
+
+    for (uint32_t i = 1; i <= steps; i++)
     {
-        //renderer_primitive_add_rectangle(renderer,(Rectangle_f){x1,y1,thickness,thickness},color);
+        StrokeSample b = stroke_catmull_rom(p, (float)i / (float)steps);
+
+        float sx = b.position.x - a.position.x;
+        float sy = b.position.y - a.position.y;
+        float length = sqrtf(sx * sx + sy * sy);
+        float d      = stroke->spacing - stroke->carry;
 
-        d2d_renderer_circle_add(renderer_circle,(Vector2f){x1,y1},color,(float)thickness);
+        while (d <= length)
+        {
+            float t = (length > 0.0f) ? d / length : 0.0f;
 
-        if (x1 == x2 && y1 == y2) break;
-        e2 = err;
+            Vector2f position = {a.position.x + sx * t, a.position.y + sy * t};
+            float    pressure = a.pressure + (b.pressure - a.pressure) * t;
 
-        if (e2 < dy) 
-        { 
-            err += dx; 
-            y1 += sy; 
+            d2d_renderer_circle_add(renderer, position, stroke->color, stroke->thickness * pressure);
+            stroke->stamps++;
+
+            d += stroke->spacing;
         }
-        if (e2 > -dx) 
-        { 
-            err -= dy; 
-            x1 += sx; 
+
+        stroke->carry = length - (d - stroke->spacing);
+        a = b;
+    }
+}
+static void stroke_push(Stroke* stroke, StrokeSample sample)
+{
+    if (stroke->sample_count == 4)
+    {
+        memmove(&stroke->samples[0], &stroke->samples[1], sizeof(StrokeSample) * 3);
+        stroke->sample_count = 3;
+    }
+    stroke->samples[stroke->sample_count++] = sample;
+}
+static void stroke_begin(Stroke* stroke, RendererCircle* renderer, Vector2f position, double time, float pressure, Color color, float thickness)
+{
+    stroke->sample_count = 0;
+    stroke->spacing      = fmaxf(0.5f, thickness * 0.25f);
+    stroke->carry        = 0;
+    stroke->filtered     = position;
+    stroke->derivative   = (Vector2f){0, 0};
+    stroke->time_prev    = time;
+    stroke->color        = color;
+    stroke->thickness    = thickness;
+
+    StrokeSample sample = {position, pressure};
+    stroke->last = sample;
+
+    // The first point is doubled so Catmull-Rom has a tangent at the stroke start.
+    stroke_push(stroke, sample);
+    stroke_push(stroke, sample);
+
+    d2d_renderer_circle_add(renderer, position, color, thickness * pressure);
+    stroke->stamps++;
+}
+// Only the segment the new sample completes is stamped, earlier segments are already on the canvas.
+static void stroke_add(Stroke* stroke, RendererCircle* renderer, Vector2f position, double time, float pressure)
+{
+    double start = glfwGetTime();
+
+    StrokeSample sample = {stroke_filter(stroke, position, time), pressure};
+    stroke->last = (StrokeSample){position, pressure};
+
+    stroke_push(stroke, sample);
+
+    if (stroke->sample_count == 4)
+    {
+        stroke_segment(stroke, renderer);
+    }
+
+    stroke->seconds += glfwGetTime() - start;
+}
+static void stroke_end(Stroke* stroke, RendererCircle* renderer)
+{
+    if (stroke->sample_count >= 3)
+    {
+        // Lands on the raw pointer position so the filter lag does not shorten the stroke.
+        stroke_push(stroke, stroke->last);
+
+        if (stroke->sample_count == 4)
+        {
+            stroke_segment(stroke, renderer);
         }
+
+        // Doubles the last point to close out the final segment.
+        stroke_push(stroke, stroke->last);
+        stroke_segment(stroke, renderer);
     }
-    //renderer_primitive_end(renderer);
-    d2d_renderer_circle_end(renderer_circle);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            
-}
\ No newline at end of file
+    stroke->sample_count = 0;
+}
+static void pen_stroke_begin(RendererCircle* renderer, RenderTarget* layer, uint32_t shader_brush)
+{
+    d2d_render_target_bind(renderer->context, layer);
+
+    d2d_renderer_circle_begin(renderer, &layer->projection, (GLuint*)&shader_brush);
+}
+static void pen_stroke_end(RendererCircle* renderer)
+{
+    d2d_renderer_circle_end(renderer);
+    d2d_render_target_bind(renderer->context, NULL);
+}
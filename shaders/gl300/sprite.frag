@@ -10,7 +10,6 @@ layout(location = 0) out vec4 color;
 
 in vec2 v_tex_coord;
 in vec4 v_color;
-in vec2 v_limit_y;
 in float v_tex_index;
 
 uniform bool u_flip;
@@ -8,11 +8,9 @@ layout (location = 3) in vec2  a_offset;
 layout (location = 4) in vec4  a_src_rect;  
 layout (location = 5) in mat4  a_transform;  
 layout (location = 9) in float a_tex_index;  
-layout (location = 10) in vec2 a_limit_y;      
 
 out vec2 v_tex_coord;
 out vec4 v_color;
-out vec2 v_limit_y;
 out float v_tex_index;
 uniform mat4 u_mvp;
 
@@ -25,5 +23,4 @@ void main()
     v_tex_coord = a_tex_coord * a_src_rect.zw + a_src_rect.xy;
     v_tex_index = a_tex_index;
     v_color     = a_color;
-    v_limit_y = a_limit_y;
 }
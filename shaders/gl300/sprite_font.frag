@@ -6,13 +6,10 @@ uniform sampler2D u_texture1;
 uniform sampler2D u_texture2;
 uniform sampler2D u_texture3;
 
-uniform float u_back_buffer_height;
-
 layout(location = 0) out vec4 color;
 
 in vec2 v_tex_coord;
 in vec4 v_color;
-in vec2 v_limit_y;
 in float v_tex_index;
 
 uniform bool u_flip;
@@ -54,13 +51,4 @@ void main()
     }
 
     color = vec4(v_color.r, v_color.g, v_color.b, sampled.r*v_color.a);
-
-    if (gl_FragCoord.y < u_back_buffer_height-v_limit_y.y && v_limit_y.y != 0.0)
-    {
-        color.a = 0.0;
-    }
-    else if (gl_FragCoord.y > u_back_buffer_height-v_limit_y.x && v_limit_y.x != 0.0)
-    {
-        color.a = 0.0;
-    }
 }
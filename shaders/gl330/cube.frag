@@ -0,0 +1,30 @@
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_normal;
+in vec4 v_color;
+flat in uint v_id;
+flat in uint v_selected;
+
+uniform int mode;
+
+void main()
+{
+    if (mode == 0)
+    {
+        uint id = v_id + 1u;
+        color = vec4(float(id & 255u), float((id >> 8u) & 255u), float((id >> 16u) & 255u), 255.0) / 255.0;
+        return;
+    }
+
+    vec3 light = normalize(vec3(0.4, 1.0, 0.3));
+    float diffuse = max(dot(normalize(v_normal), light), 0.0) * 0.7 + 0.3;
+
+    color = vec4(v_color.rgb * diffuse, v_color.a);
+
+    if (v_selected == 1u)
+    {
+        color.rgb = mix(color.rgb, vec3(1.0, 0.6, 0.0), 0.5);
+    }
+}
@@ -0,0 +1,37 @@
+#version 330 core
+
+layout (location = 0) in vec3  a_vertex;
+layout (location = 1) in vec3  a_normal;
+layout (location = 2) in vec3  a_position;
+layout (location = 3) in float a_scale;
+layout (location = 4) in vec4  a_rotation;
+layout (location = 5) in vec4  a_color;
+layout (location = 6) in uint  a_flags;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool compacted;
+
+out vec3 v_normal;
+out vec4 v_color;
+flat out uint v_id;
+flat out uint v_selected;
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main()
+{
+    vec4 q = normalize(a_rotation);
+
+    vec3 position = rotate(q, a_vertex * a_scale) + a_position;
+
+    gl_Position = projection * view * vec4(position, 1.0);
+
+    v_normal   = rotate(q, a_normal);
+    v_color    = a_color;
+    v_id       = compacted ? (a_flags >> 8u) : uint(gl_InstanceID);
+    v_selected = a_flags & 1u;
+}
@@ -0,0 +1,35 @@
+#version 330 core
+
+uniform sampler2D u_texture;
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_tex_coord;
+in vec4 v_color;
+in float v_mode;
+
+// v_mode: 0 solid, 1 font atlas, 2 distance field font atlas, 3 image
+void main()
+{
+    vec4 sampled = texture(u_texture, v_tex_coord);
+
+    if (v_mode < 0.5)
+    {
+        color = v_color;
+    }
+    else if (v_mode < 1.5)
+    {
+        color = vec4(v_color.r, v_color.g, v_color.b, sampled.r*v_color.a);
+    }
+    else if (v_mode < 2.5)
+    {
+        float width = fwidth(sampled.r);
+        float alpha = smoothstep(0.5 - width, 0.5 + width, sampled.r);
+
+        color = vec4(v_color.r, v_color.g, v_color.b, alpha*v_color.a);
+    }
+    else
+    {
+        color = sampled*v_color;
+    }
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+layout (location = 0) in vec2  a_vertex;
+layout (location = 1) in vec2  a_tex_coord;
+layout (location = 2) in vec4  a_color;
+layout (location = 3) in float a_mode;
+
+out vec2 v_tex_coord;
+out vec4 v_color;
+out float v_mode;
+uniform mat4 u_mvp;
+
+void main()
+{
+    gl_Position = vec4(a_vertex, 0.0, 1.0)*u_mvp;
+
+    v_tex_coord = a_tex_coord;
+    v_color     = a_color;
+    v_mode      = a_mode;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 
 #define STB_IMAGE_IMPLEMENTATION
 #define DELO2D_IMPLEMENTATION
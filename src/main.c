@@ -3,8 +3,242 @@
 #define IMGUI_FUNCTION_SIGNATURES
 #include <imgui.h>  
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <rista.h>
 
+#define ASSET_COUNT 100000
+
+static uint8_t asset_selections[ASSET_COUNT];
+
+static void asset_row(void*         user_data
+                     ,uint32_t      index
+                     ,ImGuiListRow* row
+                     )
+{
+    (void)user_data;
+
+    static char caption[CAPTION_SIZE];
+    snprintf(caption, sizeof(char) * CAPTION_SIZE, "[%u]%s", index, "Asset");
+
+    row->caption  = caption;
+    row->selected = asset_selections[index];
+}
+
+#define BENCH_SPRITES 200000
+#define BENCH_FRAMES  60
+#define BENCH_ARENA   (64u << 20)
+#define BENCH_POINTS  1000000
+#define PLOT_STREAM   256
+#define PLOT_LIMIT    (4u << 20)
+#define BENCH_WARMUP  120
+#define BENCH_STEADY  600
+
+typedef struct SpriteBench SpriteBench;
+struct SpriteBench
+{
+    CommandRecorder* recorder;
+    Texture*         texture;
+};
+
+static void sprite_bench_job(void*    data
+                            ,uint32_t begin
+                            ,uint32_t end
+                            ,uint32_t worker
+                            )
+{
+    SpriteBench   *bench  = (SpriteBench *)data;
+    CommandBucket *bucket = d2d_command_recorder_bucket(bench->recorder, worker);
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        d2d_command_sprite(bucket, i & 3, (float)(i % 1920), (float)(i / 1920 % 1080), 8, 8, (Rectangle_f){0, 0, 8, 8}, bench->texture, (Color){1, 1, 1, 1});
+    }
+}
+
+// Records and merges BENCH_SPRITES sprites per frame on 1, 2, 4 ... cores, run with DELO_BENCH=1.
+static void sprite_bench(D2DContext* context
+                        ,Texture*    texture
+                        )
+{
+    RendererSprite renderer;
+    Arena          arena;
+
+    if (d2d_renderer_sprite_init(&renderer, BENCH_SPRITES, context) == DELO_ERROR)
+    {
+        return;
+    }
+
+    if (d2d_arena_init(&arena, BENCH_ARENA) == DELO_ERROR)
+    {
+        d2d_renderer_sprite_free(&renderer);
+        return;
+    }
+
+    uint32_t cores = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    cores = (cores > DELO_JOB_WORKERS) ? DELO_JOB_WORKERS : cores;
+
+    for (uint32_t workers = 1; workers <= cores; workers *= 2)
+    {
+        JobSystem       jobs;
+        CommandRecorder recorder;
+
+        if (d2d_job_system_init(&jobs, workers, 0) == DELO_ERROR)
+        {
+            break;
+        }
+
+        if (d2d_command_recorder_init(&recorder, workers) == DELO_ERROR)
+        {
+            d2d_job_system_free(&jobs);
+            break;
+        }
+
+        SpriteBench bench = {&recorder, texture};
+        double      start = glfwGetTime();
+
+        for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++)
+        {
+            JobCounter counter = {0};
+
+            d2d_arena_reset(&arena);
+            d2d_command_recorder_reset(&recorder, &arena);
+            d2d_renderer_sprite_begin(&renderer, d2d_matrix44_identity());
+
+            d2d_job_parallel_for(&jobs, sprite_bench_job, &bench, BENCH_SPRITES, 4096, &counter, "record");
+            d2d_job_wait(&jobs, &counter);
+
+            d2d_command_merge_sprites(&recorder, &renderer);
+        }
+
+        double seconds = glfwGetTime() - start;
+
+        printf("[delo2d] Record bench: %u workers, %.2f ms/frame, %.0f sprites/s, %.1f MB arena, %u overflows\n"
+              ,workers
+              ,seconds * 1000.0 / BENCH_FRAMES
+              ,(double)BENCH_SPRITES * BENCH_FRAMES / seconds
+              ,arena.high_water / (1024.0 * 1024.0)
+              ,arena.overflows
+              );
+
+        d2d_command_recorder_free(&recorder);
+        d2d_job_system_free(&jobs);
+    }
+
+    d2d_arena_free(&arena);
+    d2d_renderer_sprite_free(&renderer);
+}
+
+// Strokes a BENCH_POINTS time series once to tessellate it, then replays the cached sections.
+static void path_bench(RendererPrimitive* renderer
+                      ,D2DContext*        context
+                      )
+{
+    Path      path;
+    PathStyle style = {2, {0.2f, 0.6f, 1, 1}, DELO_JOIN_MITER, DELO_CAP_BUTT, 4, 1};
+    d2d_path_init(&path);
+
+    d2d_path_move_to(&path, (Vector2f){0, context->back_buffer_height * 0.5f});
+
+    for (uint32_t i = 1; i < BENCH_POINTS; i++)
+    {
+        float x = (float)i * context->back_buffer_width / BENCH_POINTS;
+        float y = context->back_buffer_height * (0.5f + 0.3f * sinf(i * 0.0005f) + 0.05f * sinf(i * 0.37f));
+        d2d_path_line_to(&path, (Vector2f){x, y});
+    }
+
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        double start = glfwGetTime();
+
+        d2d_renderer_primitive_begin(renderer, &renderer->projection_default, NULL, DELO_TRIANGLE_LIST);
+        d2d_path_stroke(renderer, &path, &style);
+        d2d_renderer_primitive_end(renderer);
+
+        printf("[delo2d] Path bench: %s %u points, %u sections, %.2f ms\n"
+              ,pass ? "cached" : "tessellated"
+              ,path.point_count
+              ,path.section_count
+              ,(glfwGetTime() - start) * 1000.0
+              );
+    }
+
+    d2d_path_free(&path);
+}
+
+static float telemetry_sample(uint32_t i)
+{
+    return sinf(i * 0.0005f) + 0.2f * sinf(i * 0.37f) + ((i % 50000) == 0 ? 1.5f : 0);
+}
+
+// Appends BENCH_POINTS samples serially and on the job system, then decimates them to 1920 columns.
+static void plot_bench(void)
+{
+    float *values = malloc(sizeof(float) * BENCH_POINTS);
+
+    for (uint32_t i = 0; i < BENCH_POINTS; i++)
+    {
+        values[i] = telemetry_sample(i);
+    }
+
+    uint32_t cores = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    cores = (cores > DELO_JOB_WORKERS) ? DELO_JOB_WORKERS : cores;
+
+    JobSystem jobs;
+    uint8_t   parallel = d2d_job_system_init(&jobs, cores, 0) == DELO_SUCCESS;
+
+    for (uint32_t pass = 0; pass < 1u + parallel; pass++)
+    {
+        PlotSeries series;
+        Vector2f   columns[1920];
+
+        d2d_plot_series_init(&series, BENCH_POINTS, 0, 1);
+        series.jobs = pass ? &jobs : NULL;
+
+        double start = glfwGetTime();
+        d2d_plot_series_append(&series, values, BENCH_POINTS);
+        double append = glfwGetTime() - start;
+
+        start = glfwGetTime();
+        d2d_plot_series_decimate(&series, 0, BENCH_POINTS, 1920, columns);
+        double decimate = glfwGetTime() - start;
+
+        printf("[delo2d] Plot bench: %s append %.2f ms, decimate %u points to 1920 columns %.3f ms\n"
+              ,pass ? "parallel" : "serial"
+              ,append * 1000.0
+              ,series.count
+              ,decimate * 1000.0
+              );
+
+        d2d_plot_series_free(&series);
+    }
+
+    if (parallel)
+    {
+        d2d_job_system_free(&jobs);
+    }
+
+    free(values);
+}
+
+static Vector2f screen_to_world(Matrix44*   inverse_view_projection
+                               ,D2DContext* context
+                               ,Vector2f    mp
+                               )
+{
+    Vector2f ndc = 
+    {
+        (2.0f * mp.x / context->back_buffer_width) - 1.0f,
+        1.0f - (2.0f * mp.y / context->back_buffer_height)
+    };
+
+    Vector4f ndc_h = {ndc.x, ndc.y, 0.0f, 1.0f};
+
+    Vector4f world_pos_h = d2d_matrix44_multiply_vector4f(*inverse_view_projection, ndc_h);
+
+    return (Vector2f){world_pos_h.x / world_pos_h.w, world_pos_h.y / world_pos_h.w};
+}
+
 int main()
 {
     D2DContext     context;
@@ -18,28 +252,48 @@ int main()
     d2d_renderer_sprite_font_init(&d2d_renderer_sprite_font,&context,1000);
     d2d_renderer_sprite_init(&d2d_renderer_sprite,100,&context);
     d2d_renderer_primitive_init(&d2d_renderer_primitive,1000,&context);
-    d2d_renderer_circle_init(&d2d_renderer_circle,100,&context);
+    d2d_renderer_circle_init(&d2d_renderer_circle,8192,&context);
 
     uint32_t shader_sprite;
     uint32_t shader_sprite_font;
     uint32_t shader_primitive;
     uint32_t shader_circle;
+    uint32_t shader_imgui;
     uint32_t alpha_bg_shader;
     SpriteFont font_default;
 
+    d2d_shader_cache_init("shader_cache");
+    d2d_font_cache_init("font_cache");
+
     d2d_sprite_font_load(&font_default,"fonts/white-rabbit.regular.ttf",16);
-    d2d_shader_load("shaders/gl300/sprite.vert"   ,"shaders/gl300/sprite.frag"     ,&shader_sprite);
-    d2d_shader_load("shaders/gl300/sprite.vert"   ,"shaders/gl300/sprite_font.frag",&shader_sprite_font);
-    d2d_shader_load("shaders/gl300/primitive.vert","shaders/gl300/primitive.frag"  ,&shader_primitive);
-    d2d_shader_load("shaders/gl300/circle.vert","shaders/gl300/circle.frag"  ,&shader_circle);
+    d2d_sprite_font_enable_kerning(&font_default);
+    ShaderRegistry shader_registry;
+    d2d_shader_registry_init(&shader_registry);
+
+    d2d_shader_registry_add(&shader_registry,"shaders/gl300/sprite.vert"   ,"shaders/gl300/sprite.frag"     ,&shader_sprite);
+    d2d_shader_registry_add(&shader_registry,"shaders/gl300/sprite.vert"   ,"shaders/gl300/sprite_font.frag",&shader_sprite_font);
+    d2d_shader_registry_add(&shader_registry,"shaders/gl300/primitive.vert","shaders/gl300/primitive.frag"  ,&shader_primitive);
+    d2d_shader_registry_add(&shader_registry,"shaders/gl300/circle.vert","shaders/gl300/circle.frag"  ,&shader_circle);
+    d2d_shader_registry_add(&shader_registry,"shaders/gl300/imgui.vert" ,"shaders/gl300/imgui.frag"   ,&shader_imgui);
 
-    d2d_shader_load("shaders/gl300/primitive.vert","shaders/gl300/default_canvas_bg.frag"  ,&alpha_bg_shader);
+    d2d_shader_registry_add(&shader_registry,"shaders/gl300/primitive.vert","shaders/gl300/default_canvas_bg.frag"  ,&alpha_bg_shader);
+
+    printf("[delo2d] Shaders: %u cached, %u compiled, %.2f ms\n"
+          ,d2d_shader_cache.hits
+          ,d2d_shader_cache.misses
+          ,d2d_shader_cache.load_time * 1000.0
+          );
 
     d2d_renderer_sprite_apply_shader         (&d2d_renderer_sprite     ,shader_sprite);
     d2d_renderer_sprite_font_apply_shader    (&d2d_renderer_sprite_font,shader_sprite_font);
     d2d_renderer_primitive_apply_shader      (&d2d_renderer_primitive  ,shader_primitive);
 
     d2d_renderer_circle_apply_shader      (&d2d_renderer_circle  ,shader_circle);
+
+    d2d_shader_registry_bind(&shader_registry,&shader_sprite     ,&d2d_renderer_sprite     ,DELO_RENDERER_SPRITE);
+    d2d_shader_registry_bind(&shader_registry,&shader_sprite_font,&d2d_renderer_sprite_font,DELO_RENDERER_SPRITE_FONT);
+    d2d_shader_registry_bind(&shader_registry,&shader_primitive  ,&d2d_renderer_primitive  ,DELO_RENDERER_PRIMITIVE);
+    d2d_shader_registry_bind(&shader_registry,&shader_circle     ,&d2d_renderer_circle     ,DELO_RENDERER_CIRCLE);
     
     HidState         *hid_state          = &context.hid_state;
     HidState         *hid_state_prev     = &context.hid_state_prev;
@@ -51,16 +305,55 @@ int main()
 
     glfwSetWindowUserPointer(window, glfw_callback_data);
     glfwSetCharCallback(window, d2d_callback_character);
+    glfwSetScrollCallback(window, d2d_callback_scroll);
+    glfwSetCursorPosCallback(window, d2d_callback_cursor_position);
+    glfwSetMouseButtonCallback(window, d2d_callback_mouse_button);
+    glfwSetKeyCallback(window, d2d_callback_key);
 
 
     ImGui imgui;
     imgui.active_id = 0;
     uint8_t toggle_value = 0;
-    imgui_init(&imgui,&context,hid_state,hid_state_prev,&font_default, shader_primitive,shader_sprite_font,shader_sprite);
+    imgui_init(&imgui,&context,hid_state,hid_state_prev,&font_default,&shader_imgui);
+
+    TextCache text_cache;
+    d2d_text_cache_init(&text_cache);
+    imgui.text_cache = &text_cache;
+
+    d2d_frame_reactive(&context,1,0.5);
+    d2d_frame_pacing(&context,1.0/60.0,0,DELO_SWAP_ADAPTIVE);
     int32_t slider_value = 50;
     int32_t slider_value2 = 5;
     int8_t active_tab = 0;
 
+    ImGuiList asset_list;
+    imgui_list_init(&asset_list,ASSET_COUNT,32);
+
+    for (uint32_t i = 0; i < ASSET_COUNT; i += 10)
+    {
+        imgui_list_set_row_height(&asset_list,i,48);
+    }
+
+    // Reserved up front so streaming samples into it never reallocates inside the frame loop.
+    PlotSeries telemetry;
+    d2d_plot_series_init(&telemetry,PLOT_LIMIT,0,1);
+
+    for (uint32_t i = 0; i < BENCH_POINTS; i += PLOT_STREAM)
+    {
+        float samples[PLOT_STREAM];
+
+        for (uint32_t j = 0; j < PLOT_STREAM; j++)
+        {
+            samples[j] = telemetry_sample(i + j);
+        }
+
+        d2d_plot_series_append(&telemetry,samples,PLOT_STREAM);
+    }
+
+    ImGuiPlot telemetry_plot;
+    imgui_plot_init(&telemetry_plot,0,(float)telemetry.count);
+    Color telemetry_color = {0.3f,0.8f,1,1};
+
     char captions[32][CAPTION_SIZE];
     uint8_t selections[32];
 
@@ -107,17 +400,28 @@ int main()
 
     d2d_renderer_sprite_add2(&d2d_renderer_sprite,&canvas,&rt_layer_1.texture);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, rt_layer_0.fbo);
-    glViewport(0, 0, canvas_width, canvas_height);
+    uint8_t  bench       = getenv("DELO_BENCH") != NULL;
+    uint32_t bench_frame = 0;
+    uint64_t allocations = 0;
+    int      status      = EXIT_SUCCESS;
+
+    if (bench)
+    {
+        sprite_bench(&context,&rt_layer_0.texture);
+        path_bench(&d2d_renderer_primitive,&context);
+        plot_bench();
+    }
+
+    d2d_render_target_bind(&context,&rt_layer_0);
     d2d_renderer_primitive_begin(&d2d_renderer_primitive,&rt_layer_0.projection,&alpha_bg_shader,DELO_TRIANGLE_LIST);
     d2d_renderer_primitive_add_rectangle(&d2d_renderer_primitive,(Rectangle_f){0,0,canvas_width,canvas_height},(Color){1,1,1,1});
     d2d_renderer_primitive_end(&d2d_renderer_primitive);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, rt_layer_1.fbo);
-    glViewport(0, 0, canvas_width, canvas_height);
+    d2d_render_target_bind(&context,&rt_layer_1);
     d2d_renderer_primitive_begin(&d2d_renderer_primitive,&rt_layer_1.projection,NULL,DELO_TRIANGLE_LIST);
     d2d_renderer_primitive_add_rectangle(&d2d_renderer_primitive,(Rectangle_f){0,0,canvas_width,canvas_height},(Color){0,0,0,0});
     d2d_renderer_primitive_end(&d2d_renderer_primitive);
+    d2d_render_target_bind(&context,NULL);
 
   
  Camera2D camera;
@@ -138,73 +442,72 @@ d2d_camera2d_zoom(&camera,4);
  Matrix44 ma;
  d2d_matrix44_invert2(&camera.view,&ma);
 
-Vector2f mp_world_old;
+Stroke stroke = {0};
 uint8_t erase = 0;
 uint32_t thickness = 1;
     while (!glfwWindowShouldClose(window)) 
     {
-        d2d_hid_control_update(hid_state
-                          ,window
-                          ,context.screen_width
-                          ,context.screen_height
-                          ,context.back_buffer_width
-                          ,context.back_buffer_height
-                          );
+        d2d_shader_registry_poll(&shader_registry);
 
-        if(hid_state->key_escape == GLFW_PRESS)
-        {
-            glfwSetWindowShouldClose(window, GLFW_TRUE);
-        }
+        // Per frame data lives in the frame arena, it stays valid until the frame after next resets it.
+        InputEvent *input_events = d2d_arena_alloc(d2d_frame_arena(&context),sizeof(InputEvent) * DELO_INPUT_QUEUE_SIZE);
+        uint32_t    input_count  = (input_events != NULL) ? d2d_input_queue_drain(&glfw_callback_data->input_queue,input_events,DELO_INPUT_QUEUE_SIZE) : 0;
 
         d2d_camera2d_update(&camera);
 
-        Vector2f mp = 
-        {
-            context.hid_state.mouse_position_x,
-            context.hid_state.mouse_position_y
-        };
-
-        Vector2f ndc = 
-        {
-            (2.0f * mp.x / context.back_buffer_width) - 1.0f,
-            1.0f - (2.0f * mp.y / context.back_buffer_height)
-        };
-
         Matrix44 inverse_view_projection;
         d2d_matrix44_invert2(&camera.view_projection, &inverse_view_projection);
 
-        Vector4f ndc_h = {ndc.x, ndc.y, 0.0f, 1.0f};
+        pen_stroke_begin(&d2d_renderer_circle,&rt_layer_1,shader_circle);
 
-        Vector4f world_pos_h = d2d_matrix44_multiply_vector4f(inverse_view_projection, ndc_h);
+        // Every cursor sample since the last frame extends the stroke, all of them land in one batch.
+        for (uint32_t i = 0; i < input_count; i++)
+        {
+            InputEvent *input_event = &input_events[i];
+            uint8_t     was_down    = hid_state->mouse_button_left == GLFW_PRESS;
 
-        Vector2f mp_world = {world_pos_h.x / world_pos_h.w, world_pos_h.y / world_pos_h.w};
+            d2d_hid_control_apply(hid_state,input_event,1);
 
-        if(context.hid_state.mouse_button_left)
-        {
-            if(erase)   
+            if(input_event->type != DELO_INPUT_CURSOR && input_event->type != DELO_INPUT_BUTTON)
             {
-                glDisable(GL_BLEND);
+                continue;
             }
-            pen_draw(&d2d_renderer_primitive,&d2d_renderer_circle,&rt_layer_1,mp_world,mp_world_old,((erase) ? COLOR_TRANSPARENT:(Color){1,1,1,1}),thickness,shader_circle);
-        }
-        glEnable(GL_BLEND);
 
-        mp_world_old.x = mp_world.x;
-        mp_world_old.y = mp_world.y;
-    
-        d2d_frame_begin(&context);
-
-
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+            Vector2f mp_world = screen_to_world(&inverse_view_projection,&context,(Vector2f){hid_state->mouse_position_x,hid_state->mouse_position_y});
+            uint8_t  is_down  = hid_state->mouse_button_left == GLFW_PRESS;
 
+            if(is_down && !was_down)
+            {
+                stroke_begin(&stroke,&d2d_renderer_circle,mp_world,input_event->time,1.0f,((erase) ? COLOR_TRANSPARENT:(Color){1,1,1,1}),thickness);
+            }
+            else if(is_down)
+            {
+                stroke_add(&stroke,&d2d_renderer_circle,mp_world,input_event->time,1.0f);
+            }
+            else if(was_down)
+            {
+                stroke_end(&stroke,&d2d_renderer_circle);
+            }
+        }
 
-        d2d_renderer_sprite.projection = camera.view_projection;
-        d2d_renderer_sprite_update(&d2d_renderer_sprite);
-        d2d_renderer_sprite_render(&d2d_renderer_sprite);
+        if(erase)   
+        {
+            glDisable(GL_BLEND);
+        }
+        pen_stroke_end(&d2d_renderer_circle);
+        glEnable(GL_BLEND);
 
+        if(hid_state->key_escape == GLFW_PRESS)
+        {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
 
+        Vector2f mp = 
+        {
+            context.hid_state.mouse_position_x,
+            context.hid_state.mouse_position_y
+        };
+    
         imgui_begin(&imgui,&glfw_callback_data->key_buffer[0], glfw_callback_data->key_buffer_length);
         
         DatePickerEvent dpe = imgui_datepicker(&imgui,UNIQUE_ID,year,month,day);
@@ -226,17 +529,128 @@ uint32_t thickness = 1;
 
         }
 
-        imgui_end(&imgui);
+        float *samples = d2d_arena_alloc(d2d_frame_arena(&context),sizeof(float) * PLOT_STREAM);
+
+        if (samples != NULL && telemetry.count < PLOT_LIMIT)
+        {
+            for (uint32_t j = 0; j < PLOT_STREAM; j++)
+            {
+                samples[j] = telemetry_sample(telemetry.count + j);
+            }
 
+            d2d_plot_series_append(&telemetry,samples,PLOT_STREAM);
+        }
 
+        imgui_plot(&imgui,UNIQUE_ID,(Rectangle_f){200,260,420,240},&telemetry_plot,&telemetry,1,&telemetry_color);
 
-        d2d_renderer_primitive_begin(&d2d_renderer_primitive,&d2d_renderer_primitive.projection_default,NULL,DELO_LINE_LIST);
-        d2d_renderer_primitive_add_line(&d2d_renderer_primitive,(Vector2f){0,0},(Vector2f){mp.x,mp.y},(Color){1,1,1,1});
-        d2d_renderer_primitive_end(&d2d_renderer_primitive);
+        ListEvent le = imgui_list(&imgui,UNIQUE_ID,(Rectangle_f){650,200,240,512},&asset_list,asset_row,NULL);
+        if(le.changed)
+        {
+            asset_selections[le.index] = !asset_selections[le.index];
+        }
 
+        imgui_end(&imgui);
 
-        
+        if(d2d_frame_begin(&context))
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, d2d_frame_target(&context));
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            d2d_renderer_sprite.projection = camera.view_projection;
+            d2d_renderer_sprite_update(&d2d_renderer_sprite);
+            d2d_renderer_sprite_render(&d2d_renderer_sprite);
+
+            imgui_render(&imgui);
+
+            d2d_renderer_primitive_begin(&d2d_renderer_primitive,&d2d_renderer_primitive.projection_default,NULL,DELO_LINE_LIST);
+            d2d_renderer_primitive_add_line(&d2d_renderer_primitive,(Vector2f){0,0},(Vector2f){mp.x,mp.y},(Color){1,1,1,1});
+            d2d_renderer_primitive_end(&d2d_renderer_primitive);
+        }
 
         d2d_frame_end(&context);
+
+        // The bench run measures heap allocations over BENCH_STEADY frames once the warm up has filled every cache.
+        if (bench)
+        {
+            bench_frame++;
+
+            if (bench_frame == BENCH_WARMUP)
+            {
+                allocations = d2d_alloc_count();
+            }
+            else if (bench_frame == BENCH_WARMUP + BENCH_STEADY)
+            {
+                allocations = d2d_alloc_count() - allocations;
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
+        }
     }
+
+    if (bench)
+    {
+#if defined(DELO_ALLOC_COUNT)
+        if (bench_frame < BENCH_WARMUP + BENCH_STEADY)
+        {
+            fprintf(stderr, "Error bench closed after %u of %u frames\n", bench_frame, BENCH_WARMUP + BENCH_STEADY);
+            status = EXIT_FAILURE;
+        }
+        else if (allocations > 0)
+        {
+            fprintf(stderr, "Error %lu heap allocations over %u steady frames\n", (unsigned long)allocations, BENCH_STEADY);
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            printf("[delo2d] Allocations: none over %u steady frames\n", BENCH_STEADY);
+        }
+#else
+        printf("[delo2d] Allocations: not counted, build with DELO_ALLOC_COUNT=1 ./build.sh\n");
+#endif
+    }
+
+    printf("[delo2d] Text cache: %u hits, %u misses, %u evictions, %u bypasses\n"
+          ,text_cache.hits
+          ,text_cache.misses
+          ,text_cache.evictions
+          ,text_cache.bypasses
+          );
+
+    printf("[rista] Stroke: %u stamps, %.0f stamps/s\n"
+          ,stroke.stamps
+          ,(stroke.seconds > 0) ? stroke.stamps / stroke.seconds : 0.0
+          );
+
+    FrameStats frame_stats = d2d_frame_stats(&context);
+
+    printf("[delo2d] Frames: %u drawn, %u skipped, %.2f ms p50, %.2f ms p99, %.2f ms max\n"
+          ,context.reactive.frames_drawn
+          ,context.reactive.frames_skipped
+          ,frame_stats.p50
+          ,frame_stats.p99
+          ,frame_stats.max
+          );
+
+    printf("[delo2d] Renderers last frame: %u grows, %u flushes, %u dropped\n"
+          ,context.renderer_stats_frame.grows
+          ,context.renderer_stats_frame.flushes
+          ,context.renderer_stats_frame.dropped
+          );
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        printf("[delo2d] Frame arena %u: %zu KB high water of %zu KB, %u overflows\n"
+              ,i
+              ,context.frame_arenas[i].high_water / 1024
+              ,context.frame_arenas[i].capacity / 1024
+              ,context.frame_arenas[i].overflows
+              );
+    }
+
+    imgui_list_free(&asset_list);
+    d2d_plot_series_free(&telemetry);
+    d2d_text_cache_free(&text_cache);
+    d2d_sprite_font_free(&font_default);
+
+    return status;
 }
\ No newline at end of file